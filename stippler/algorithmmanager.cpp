@@ -55,24 +55,54 @@
 
 #include <QMenu>
 #include <QAction>
+#include <QStringList>
+#include <QTimer>
 #include "algorithmmanager.h"
-#include "algorithmthread.h"
+#include "algorithmpool.h"
 #include "imagemanager.h"
 #include "imageviewer.h"
+#include "resultcache.h"
+#include "algorithmprogress.h"
 #include "algorithms/rgb2labgreyalgorithm.h"
 #include "algorithms/midtonefilter.h"
 #include "algorithms/superpixels/slic.h"
 #include "algorithms/higher_order/filter/localdatafilter.h"
 
+/*!
+  \brief The interval, in milliseconds, at which to poll for algorithm progress
+ */
+#define ALGORITHMMANAGER_PROGRESS_INTERVAL 100
+
 AlgorithmManager::AlgorithmManager(ImageViewer* v, ImageManager* m) :
-    QObject(v), viewer(v), imManager(m), algThread(0),
-    algorithmActions(), abortAction(0), algorithmIsRunning(false)
+    QObject(v), viewer(v), imManager(m), pool(0), resultCache(0),
+    progressTimer(0), lastProgressText(), jobNames(), algorithmActions(), abortAction(0)
 {
-    algThread = new AlgorithmThread(this);
-    connect(algThread, SIGNAL(finished()), this, SLOT(receiveFinished()));
-    connect(algThread, SIGNAL(sendStatus(QString)), this, SLOT(receiveStatus(QString)));
-    connect(algThread, SIGNAL(sendFail()), this, SLOT(receiveFail()));
-    connect(algThread, SIGNAL(sendOutput(AlgorithmResultPair)), this, SLOT(receiveOutput(AlgorithmResultPair)));
+    resultCache = new ResultCache(ResultCache::defaultDirectory());
+    if(!resultCache->isValid()) {
+        qWarning("Failed to create the result cache directory. Results will not be cached.");
+        delete resultCache;
+        resultCache = 0;
+    }
+    pool = new AlgorithmPool(this);
+    pool->setResultCache(resultCache);
+    connect(pool, SIGNAL(allFinished()), this, SLOT(receiveFinished()));
+    connect(pool, SIGNAL(jobStatus(int,QString)), this, SLOT(receiveStatus(int,QString)));
+    connect(pool, SIGNAL(jobFailed(int)), this, SLOT(receiveFail(int)));
+    connect(pool, SIGNAL(jobCancelled(int)), this, SLOT(receiveCancelled(int)));
+    connect(pool, SIGNAL(jobOutput(int,AlgorithmResultPair&)), this, SLOT(receiveOutput(int,AlgorithmResultPair&)));
+    progressTimer = new QTimer(this);
+    progressTimer->setInterval(ALGORITHMMANAGER_PROGRESS_INTERVAL);
+    connect(progressTimer, SIGNAL(timeout()), this, SLOT(pollProgress()));
+}
+
+AlgorithmManager::~AlgorithmManager(void) {
+    // The threads must stop using the cache before the cache is deleted
+    delete pool;
+    pool = 0;
+    if(resultCache != 0) {
+        delete resultCache;
+        resultCache = 0;
+    }
 }
 
 QMenu * AlgorithmManager::createAlgorithmsMenu(void) {
@@ -86,96 +116,133 @@ QMenu * AlgorithmManager::createAlgorithmsMenu(void) {
                                             &AlgorithmManager::runLocalDataFilter_STDDEV_LSTAR));
     algorithmActions.append(menu->addAction(tr("&SLIC superpixel external selection map filter"), this,
                                             &AlgorithmManager::runLocalDataFilter_EXTERNAL));
+    algorithmActions.append(menu->addAction(tr("SLIC superpixel filters (&all bases)"), this,
+                                            &AlgorithmManager::runLocalDataFilter_ALL));
 
     menu->addSeparator();
-    abortAction = menu->addAction(tr("&Stop algorithm"), this, &AlgorithmManager::abort);
+    abortAction = menu->addAction(tr("&Stop all algorithms"), this, &AlgorithmManager::abort);
 
     // Initially, no image is present, and so no algorithms can be run
     toggleActions(false);
     abortAction->setEnabled(false);
-    algorithmIsRunning = false;
     return menu;
 }
 
 void AlgorithmManager::enableAlgorithms(void) {
-    if(!algorithmIsRunning) {
-        toggleActions(true);
-    }
+    toggleActions(true);
 }
 
 void AlgorithmManager::runGreyscale() {
     viewer->setStatusBarMessage(tr("Running CIE L*a*b* greyscale algorithm"));
     Algorithm* alg = new Rgb2LabGreyAlgorithm();
-    runAlgorithm(alg);
+    runAlgorithm(alg, tr("CIE L*a*b* greyscale"));
 }
 
 void AlgorithmManager::runMidtoneFilter() {
     viewer->setStatusBarMessage(tr("Running CIE L*a*b* midtone selection algorithm"));
     Algorithm* alg = new MidtoneFilter();
-    runAlgorithm(alg);
+    runAlgorithm(alg, tr("CIE L*a*b* midtones"));
 }
 
 void AlgorithmManager::runSLIC() {
     viewer->setStatusBarMessage(tr("Running SLIC algorithm"));
     Algorithm* alg = new SLIC();
-    runAlgorithm(alg);
+    runAlgorithm(alg, tr("SLIC"));
 }
 
 void AlgorithmManager::runLocalDataFilter_SIZE() {
     viewer->setStatusBarMessage(tr("Running SLIC superpixel size-filtering algorithm"));
     ISuperpixelGenerator* slic = new SLIC();
     Algorithm* alg = new LocalDataFilter(slic, LocalDataFilter::ScoreBasis::SIZE);
-    runAlgorithm(alg);
+    runAlgorithm(alg, tr("SLIC size filter"));
 }
 
 void AlgorithmManager::runLocalDataFilter_STDDEV_LSTAR() {
     viewer->setStatusBarMessage(tr("Running SLIC superpixel lightness stddev-filtering algorithm"));
     ISuperpixelGenerator* slic = new SLIC();
     Algorithm* alg = new LocalDataFilter(slic, LocalDataFilter::ScoreBasis::STDDEV_LSTAR);
-    runAlgorithm(alg);
+    runAlgorithm(alg, tr("SLIC stddev filter"));
 }
 
 void AlgorithmManager::runLocalDataFilter_EXTERNAL() {
     viewer->setStatusBarMessage(tr("Running SLIC superpixel external selection map filtering algorithm"));
     ISuperpixelGenerator* slic = new SLIC();
     Algorithm* alg = new LocalDataFilter(slic, LocalDataFilter::ScoreBasis::EXTERNAL);
-    runAlgorithm(alg);
+    runAlgorithm(alg, tr("SLIC external filter"));
+}
+
+void AlgorithmManager::runLocalDataFilter_ALL() {
+    viewer->setStatusBarMessage(tr("Running SLIC superpixel filtering algorithms"));
+    ISuperpixelGenerator* slic = new SLIC();
+    QVector<LocalDataFilter::ScoreBasis> bases;
+    bases.append(LocalDataFilter::ScoreBasis::SIZE);
+    bases.append(LocalDataFilter::ScoreBasis::STDDEV_LSTAR);
+    bases.append(LocalDataFilter::ScoreBasis::EXTERNAL);
+    Algorithm* alg = new LocalDataFilter(slic, bases);
+    runAlgorithm(alg, tr("SLIC filters"));
 }
 
 void AlgorithmManager::abort() {
-    viewer->setStatusBarMessage(tr("Aborting algorithm"));
-    algThread->stopProcess();
+    viewer->setStatusBarMessage(tr("Aborting all algorithms"));
+    pool->cancelAll();
 }
 
-void AlgorithmManager::receiveFail() {
-    viewer->setStatusBarMessage(tr("Algorithm failed"));
+void AlgorithmManager::receiveFail(int job) {
+    viewer->setStatusBarMessage(tr("%1: Algorithm failed").arg(jobNames.take(job)));
+}
+
+void AlgorithmManager::receiveCancelled(int job) {
+    viewer->setStatusBarMessage(tr("%1: Cancelled").arg(jobNames.take(job)));
 }
 
 void AlgorithmManager::receiveFinished() {
-    toggleActions(true);
+    stopProgressPolling();
+    abortAction->setEnabled(false);
 }
 
-void AlgorithmManager::receiveStatus(const QString &status) {
-    viewer->setStatusBarMessage(status);
+void AlgorithmManager::receiveStatus(int job, const QString &status) {
+    viewer->setStatusBarMessage(QString("%1: %2").arg(jobNames.value(job), status));
 }
 
-void AlgorithmManager::receiveOutput(const AlgorithmResultPair &pair) {
+void AlgorithmManager::pollProgress() {
+    QStringList messages;
+    foreach(int job, pool->runningJobs()) {
+        const AlgorithmProgress *progress = pool->progress(job);
+        QString message = progress->text();
+        if(!message.isEmpty()) {
+            messages.append(QString("%1: %2").arg(jobNames.value(job), message));
+        }
+    }
+    QString text = messages.join("; ");
+    if(!text.isEmpty() && text != lastProgressText) {
+        viewer->setStatusBarMessage(text);
+        lastProgressText = text;
+    }
+}
+
+void AlgorithmManager::receiveOutput(int job, AlgorithmResultPair &pair) {
     const QByteArray* svgDataPtr = 0;
     if(!pair.svgData().isEmpty()) {
         svgDataPtr = new QByteArray(pair.svgData());
     }
+    // The image data should not have been duplicated on its way from the algorithm
+    Q_ASSERT(pair.hasOriginalImageData());
     imManager->setImage(pair.image(), svgDataPtr);
+    viewer->setStatusBarMessage(tr("%1: Finished").arg(jobNames.take(job)));
 }
 
 void AlgorithmManager::toggleActions(bool runAlgorithm) {
-    algorithmIsRunning = !runAlgorithm;
     foreach (QAction *act, algorithmActions) {
         act->setEnabled(runAlgorithm);
     }
-    abortAction->setEnabled(!runAlgorithm);
 }
 
-void AlgorithmManager::runAlgorithm(Algorithm *algorithm) {
+void AlgorithmManager::stopProgressPolling() {
+    progressTimer->stop();
+    lastProgressText.clear();
+}
+
+void AlgorithmManager::runAlgorithm(Algorithm *algorithm, const QString &name) {
 
     // Retrieve the current image
     QImage image;
@@ -189,10 +256,15 @@ void AlgorithmManager::runAlgorithm(Algorithm *algorithm) {
     foreach(const QString &str, imageDescriptions) {
           if(!imManager->browseForImage(image, str)) {
               viewer->setStatusBarMessage(tr("Cancelled"));
+              delete algorithm;
               return;
           }
           images.append(image);
     }
-    toggleActions(false);
-    algThread->processImages(algorithm, images);
+    int job = pool->submit(algorithm, images);
+    jobNames.insert(job, name);
+    abortAction->setEnabled(true);
+    if(!progressTimer->isActive()) {
+        progressTimer->start();
+    }
 }
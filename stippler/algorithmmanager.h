@@ -58,21 +58,28 @@
 */
 
 #include <QObject>
+#include <QHash>
+#include <QString>
 #include <QVector>
 #include "algorithmresultpair.h"
 
 class ImageViewer;
 class ImageManager;
 class Algorithm;
-class AlgorithmThread;
+class AlgorithmPool;
+class ResultCache;
 class QMenu;
 class QAction;
+class QTimer;
 
 /*!
  * \brief Controller for image processing
  *
  * A class for selecting, running, and aborting image processing algorithms.
  * It manages the "Algorithms" menu of the application.
+ *
+ * Algorithms are run by an AlgorithmPool, so several algorithms can run
+ * concurrently. Their outputs replace the current image as they complete.
  */
 class AlgorithmManager: public QObject
 {
@@ -90,6 +97,8 @@ public:
      */
     AlgorithmManager(ImageViewer* viewer, ImageManager* imageManager);
 
+    virtual ~AlgorithmManager(void);
+
     /*!
      * \brief Create a menu for controlling algorithm execution
      * \return The new menu, ownership of which is transferred to the caller
@@ -101,9 +110,6 @@ public:
      *
      * Activates the appropriate user interface elements. This function is to be
      * called when the first image is loaded.
-     *
-     * Menu options for running image processing algorithms will not be
-     * enabled if an algorithm is currently running.
      */
     void enableAlgorithms(void);
 
@@ -158,6 +164,13 @@ public slots:
      */
     void runLocalDataFilter_EXTERNAL();
 
+    /*!
+     * \brief Run Simple Linear Iterative Clustering superpixels, SLIC, once,
+     * then filter the superpixels based on size, lightness standard deviation,
+     * and an externally-provided pixel selection map
+     */
+    void runLocalDataFilter_ALL();
+
 //    /*!
 //     * \brief Run the basic superpixel and stipple overlay rendering algorithm,
 //     * OverlayRenderer
@@ -210,45 +223,70 @@ public slots:
 //    void runFilteredBlendRenderer_stipplesOnly_sharp();
 
     /*!
-     * \brief Stop the currently running algorithm, triggered by user input
+     * \brief Stop all queued and running algorithms, triggered by user input
      */
     void abort();
 
     /*!
-     * \brief Stop the currently running algorithm, triggered by algorithm failure
+     * \brief Report the failure of an algorithm
+     * \param [in] job The identifier of the algorithm's job in AlgorithmManager::pool
      */
-    void receiveFail();
+    void receiveFail(int job);
 
     /*!
-     * \brief Called when the image processing thread has finished running
+     * \brief Report that an algorithm was stopped before it finished
+     * \param [in] job The identifier of the algorithm's job in AlgorithmManager::pool
+     */
+    void receiveCancelled(int job);
+
+    /*!
+     * \brief Called when no algorithms remain queued or running
      */
     void receiveFinished();
 
     /*!
      * \brief Display algorithm progress information to the user
+     * \param [in] job The identifier of the algorithm's job in AlgorithmManager::pool
      * \param [in] status Progress message
      */
-    void receiveStatus(const QString &status);
+    void receiveStatus(int job, const QString &status);
+
+    /*!
+     * \brief Display the progress published by the running algorithms, if it
+     * has changed since it was last displayed
+     *
+     * Called periodically by AlgorithmManager::progressTimer
+     * \see AlgorithmPool::progress()
+     */
+    void pollProgress();
 
     /*!
      * \brief Receive the output image from an algorithm
      *
      * This slot is intended to be used to pass data between threads.
+     * \param [in] job The identifier of the algorithm's job in AlgorithmManager::pool
      * \param [in] pair Raster and vector image output in a single object
      */
-    void receiveOutput(const AlgorithmResultPair &pair);
+    void receiveOutput(int job, AlgorithmResultPair &pair);
 
 private:
     /*!
      * \brief Enable or disable menu items for running image processing algorithms
-     *
-     * This function also updates AlgorithmManager::algorithmIsRunning
      * \param [in] runAlgorithm If `true`, menu options for running algorithms
-     * are enabled, and the menu option for aborting a running algorithm is disabled.
-     * If `false`, the opposite occurs.
+     * are enabled. If `false`, they are disabled.
      */
     void toggleActions(bool runAlgorithm);
-    void runAlgorithm(Algorithm *algorithm);
+
+    /*!
+     * \brief Stop polling for algorithm progress
+     */
+    void stopProgressPolling();
+    /*!
+     * \brief Submit an algorithm to AlgorithmManager::pool, operating on the current image
+     * \param [in] algorithm The algorithm, ownership of which is transferred to this object
+     * \param [in] name A short name for the algorithm, used to label its status messages
+     */
+    void runAlgorithm(Algorithm *algorithm, const QString &name);
 
 //    /*!
 //     * \brief Run the blended superpixel and stipple rendering algorithm,
@@ -265,15 +303,27 @@ private:
 private:
     ImageViewer* viewer;
     ImageManager* imManager;
-    AlgorithmThread* algThread;
+    AlgorithmPool* pool;
+    /*!
+     * \brief The cache of algorithm results shared by all algorithm runs,
+     * or null if the cache directory could not be created
+     */
+    ResultCache* resultCache;
+    /*!
+     * \brief Triggers pollProgress() while an algorithm is running
+     */
+    QTimer* progressTimer;
+    /*!
+     * \brief The last progress message displayed by pollProgress()
+     */
+    QString lastProgressText;
+    /*!
+     * \brief The names of the algorithms which have not finished, indexed by job identifier
+     */
+    QHash<int, QString> jobNames;
 
     QVector<QAction*> algorithmActions;
     QAction* abortAction;
-
-    /*!
-     * \brief Whether or not an image processing algorithm is running
-     */
-    bool algorithmIsRunning;
 };
 
 #endif // ALGORITHMMANAGER_H
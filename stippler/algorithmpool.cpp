@@ -0,0 +1,260 @@
+/*!
+** \file algorithmpool.cpp
+** \brief Implementation of the AlgorithmPool class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QThread>
+#include <utility>
+#include "algorithmpool.h"
+#include "algorithmthread.h"
+#include "algorithms/algorithm.h"
+
+AlgorithmPool::AlgorithmPool(QObject *parent, const int m) :
+    QObject(parent), maxThreads(m), delivery(Delivery::COMPLETION_ORDER),
+    cache(0), nextJobId(0), jobs(), queuedJobs(), runningJobsByThread(),
+    idleThreads(), threads()
+{
+    if(maxThreads <= 0) {
+        maxThreads = QThread::idealThreadCount();
+        if(maxThreads <= 0) {
+            maxThreads = 1;
+        }
+    }
+}
+
+AlgorithmPool::~AlgorithmPool(void) {
+    // Thread destructors abort processing and wait for the threads to stop
+    foreach(AlgorithmThread *thread, threads) {
+        delete thread;
+    }
+    threads.clear();
+    foreach(Job *job, jobs) {
+        if(job->algorithm != 0) {
+            delete job->algorithm;
+            job->algorithm = 0;
+        }
+        delete job;
+    }
+    jobs.clear();
+}
+
+int AlgorithmPool::submit(Algorithm *&algorithm, const QVector<QImage> &images) {
+    Job *job = new Job;
+    job->id = nextJobId;
+    nextJobId += 1;
+    job->state = State::QUEUED;
+    job->algorithm = algorithm;
+    algorithm = 0;
+    job->images = images;
+    job->thread = 0;
+    job->cancelRequested = false;
+    jobs.append(job);
+    queuedJobs.enqueue(job);
+    startQueuedJobs();
+    return job->id;
+}
+
+void AlgorithmPool::cancel(const int id) {
+    foreach(Job *job, jobs) {
+        if(job->id == id) {
+            if(job->state == State::QUEUED) {
+                queuedJobs.removeOne(job);
+                delete job->algorithm;
+                job->algorithm = 0;
+                job->state = State::CANCELLED;
+                deliver();
+            } else if(job->state == State::RUNNING) {
+                job->cancelRequested = true;
+                job->thread->stopProcess();
+            }
+            return;
+        }
+    }
+}
+
+void AlgorithmPool::cancelAll(void) {
+    QList<int> ids;
+    foreach(const Job *job, jobs) {
+        ids.append(job->id);
+    }
+    foreach(int id, ids) {
+        cancel(id);
+    }
+}
+
+int AlgorithmPool::jobCount(void) const {
+    return queuedJobs.size() + runningJobsByThread.size();
+}
+
+QList<int> AlgorithmPool::runningJobs(void) const {
+    QList<int> ids;
+    foreach(const Job *job, jobs) {
+        if(job->state == State::RUNNING) {
+            ids.append(job->id);
+        }
+    }
+    return ids;
+}
+
+const AlgorithmProgress *AlgorithmPool::progress(const int id) const {
+    foreach(const Job *job, jobs) {
+        if(job->id == id && job->state == State::RUNNING) {
+            return &(job->thread->progress());
+        }
+    }
+    return 0;
+}
+
+void AlgorithmPool::setResultCache(ResultCache *c) {
+    cache = c;
+    foreach(AlgorithmThread *thread, threads) {
+        thread->setResultCache(cache);
+    }
+}
+
+void AlgorithmPool::setDelivery(const Delivery d) {
+    delivery = d;
+    deliver();
+}
+
+void AlgorithmPool::receiveStatus(const QString &status) {
+    Job *job = senderJob();
+    if(job != 0 && !job->cancelRequested) {
+        emit jobStatus(job->id, status);
+    }
+}
+
+void AlgorithmPool::receiveOutput(const AlgorithmResultPair &pair) {
+    Job *job = senderJob();
+    if(job != 0) {
+        // Shares the data with the queued signal's copy, which is released afterwards
+        job->output = pair;
+        job->state = State::SUCCEEDED;
+    }
+}
+
+void AlgorithmPool::receiveProfile(const AlgorithmProfile &profile) {
+    Job *job = senderJob();
+    if(job != 0) {
+        job->profile = profile;
+    }
+}
+
+void AlgorithmPool::receiveFail() {
+    Job *job = senderJob();
+    if(job != 0) {
+        job->state = State::FAILED;
+    }
+}
+
+void AlgorithmPool::receiveFinished() {
+    Job *job = senderJob();
+    if(job == 0) {
+        return;
+    }
+    AlgorithmThread *thread = job->thread;
+    /* `finished()` is emitted from the thread just before it stops,
+     * so wait for it to stop completely before it is reused.
+     */
+    thread->wait();
+    runningJobsByThread.remove(thread);
+    idleThreads.append(thread);
+    job->thread = 0;
+    if(job->cancelRequested || job->state == State::RUNNING) {
+        // The thread was aborted before producing an outcome
+        job->output = AlgorithmResultPair();
+        job->state = State::CANCELLED;
+    }
+    startQueuedJobs();
+    deliver();
+}
+
+void AlgorithmPool::startQueuedJobs(void) {
+    while(!queuedJobs.isEmpty() && runningJobsByThread.size() < maxThreads) {
+        AlgorithmThread *thread = 0;
+        if(idleThreads.isEmpty()) {
+            thread = new AlgorithmThread(this);
+            thread->setResultCache(cache);
+            connect(thread, SIGNAL(finished()), this, SLOT(receiveFinished()));
+            connect(thread, SIGNAL(sendStatus(QString)), this, SLOT(receiveStatus(QString)));
+            connect(thread, SIGNAL(sendFail()), this, SLOT(receiveFail()));
+            connect(thread, SIGNAL(sendOutput(AlgorithmResultPair)), this, SLOT(receiveOutput(AlgorithmResultPair)));
+            connect(thread, SIGNAL(sendProfile(AlgorithmProfile)), this, SLOT(receiveProfile(AlgorithmProfile)));
+            threads.append(thread);
+        } else {
+            thread = idleThreads.takeLast();
+        }
+        Job *job = queuedJobs.dequeue();
+        job->state = State::RUNNING;
+        job->thread = thread;
+        runningJobsByThread.insert(thread, job);
+        thread->processImages(job->algorithm, job->images);
+        job->images.clear();
+    }
+}
+
+void AlgorithmPool::deliver(void) {
+    /* Finished jobs are removed from the list before any signals are emitted,
+     * as slots connected to the signals may call functions of this object.
+     */
+    QList<Job*> finishedJobs;
+    QList<Job*>::iterator it = jobs.begin();
+    while(it != jobs.end()) {
+        Job *job = *it;
+        /* A job which has produced its outcome is not finished until its thread
+         * has stopped, as the thread will still signal this object.
+         */
+        if(job->state == State::QUEUED || job->state == State::RUNNING || job->thread != 0) {
+            if(delivery == Delivery::SUBMISSION_ORDER) {
+                break;
+            }
+            ++it;
+        } else {
+            finishedJobs.append(job);
+            it = jobs.erase(it);
+        }
+    }
+    foreach(Job *job, finishedJobs) {
+        deliverJob(job);
+        delete job;
+    }
+    if(!finishedJobs.isEmpty() && jobs.isEmpty()) {
+        emit allFinished();
+    }
+}
+
+void AlgorithmPool::deliverJob(Job *job) {
+    switch(job->state) {
+    case State::SUCCEEDED: {
+        if(!job->profile.isEmpty()) {
+            emit jobProfile(job->id, job->profile);
+        }
+        AlgorithmResultPair output(std::move(job->output));
+        emit jobOutput(job->id, output);
+        break;
+    }
+    case State::FAILED:
+        emit jobFailed(job->id);
+        break;
+    case State::CANCELLED:
+        emit jobCancelled(job->id);
+        break;
+    default:
+        Q_ASSERT(false);
+    }
+}
+
+AlgorithmPool::Job *AlgorithmPool::senderJob(void) const {
+    AlgorithmThread *thread = qobject_cast<AlgorithmThread*>(sender());
+    return runningJobsByThread.value(thread, 0);
+}
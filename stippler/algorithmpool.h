@@ -0,0 +1,268 @@
+#ifndef ALGORITHMPOOL_H
+#define ALGORITHMPOOL_H
+
+/*!
+** \file algorithmpool.h
+** \brief Definition of the AlgorithmPool class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QObject>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QQueue>
+#include <QVector>
+#include "algorithmresultpair.h"
+#include "algorithms/algorithmprofile.h"
+
+class Algorithm;
+class AlgorithmThread;
+class AlgorithmProgress;
+class ResultCache;
+
+/*!
+ * \brief An executor which runs several image processing algorithms concurrently
+ *
+ * Each submitted job (an algorithm, together with its input images) is run on
+ * an AlgorithmThread. At most AlgorithmPool::maxThreads jobs run at once, and
+ * further jobs wait in a queue until a thread becomes available.
+ *
+ * Jobs are identified by the integers returned by submit(), which are
+ * used to cancel jobs, to query their progress, and to label the
+ * signals emitted by this object.
+ */
+class AlgorithmPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    /*!
+     * \brief The order in which the outcomes of jobs are signalled
+     */
+    enum class Delivery : unsigned int {
+        SUBMISSION_ORDER, // The outcome of a job is held back until all earlier jobs have finished
+        COMPLETION_ORDER // The outcome of a job is signalled as soon as it is available
+    };
+
+public:
+    /*!
+     * \brief Create an empty pool
+     * \param [in] parent The parent object which takes ownership of this object
+     * \param [in] maxThreads The maximum number of jobs to run concurrently.
+     * If not positive, QThread::idealThreadCount() is used.
+     */
+    AlgorithmPool(QObject *parent = 0, const int maxThreads = 0);
+
+    /*!
+     * \brief Cancels all jobs, and waits for running jobs to stop
+     */
+    virtual ~AlgorithmPool(void);
+
+    /*!
+     * \brief Queue a job for processing
+     *
+     * The job starts immediately if fewer than AlgorithmPool::maxThreads jobs are running.
+     * \param [in] algorithm The image processing algorithm to execute. This object
+     * takes ownership of `algorithm` and sets `algorithm` to null in the caller.
+     * \param [in] images The images on which to operate
+     * \return The identifier of the job
+     */
+    int submit(Algorithm *& algorithm, const QVector<QImage> &images);
+
+    /*!
+     * \brief Stop a job
+     *
+     * A queued job is discarded without being run. A running job is asked
+     * to stop at the end of its current processing increment. In either case,
+     * jobCancelled() will be emitted instead of jobOutput() or jobFailed().
+     * \param [in] job The identifier of the job. Identifiers of jobs which
+     * have already finished are ignored.
+     */
+    void cancel(const int job);
+
+    /*!
+     * \brief Stop all jobs
+     * \see cancel()
+     */
+    void cancelAll(void);
+
+    /*!
+     * \brief Determine the number of jobs which have not yet finished
+     * \return The number of queued and running jobs
+     */
+    int jobCount(void) const;
+
+    /*!
+     * \brief List the jobs which are currently running
+     * \return The identifiers of the running jobs, in submission order
+     */
+    QList<int> runningJobs(void) const;
+
+    /*!
+     * \brief Access the progress of a running job
+     * \param [in] job The identifier of the job
+     * \return The job's progress channel (see AlgorithmThread::progress()), or
+     * null if the job is not running
+     */
+    const AlgorithmProgress *progress(const int job) const;
+
+    /*!
+     * \brief Set the cache shared by all jobs
+     * \param [in] cache The cache, which is not owned by this object, and must outlive it.
+     * Passing null disables caching.
+     * \see AlgorithmThread::setResultCache()
+     */
+    void setResultCache(ResultCache *cache);
+
+    /*!
+     * \brief Choose the order in which the outcomes of jobs are signalled
+     *
+     * The default is Delivery::COMPLETION_ORDER.
+     * \param [in] delivery The new delivery order
+     */
+    void setDelivery(const Delivery delivery);
+
+signals:
+    /*!
+     * \brief Relay a status message from a running job
+     * \param [out] job The identifier of the job
+     * \param [out] status Status message to display
+     */
+    void jobStatus(int job, const QString &status);
+
+    /*!
+     * \brief Transfer the results of a job which completed successfully
+     *
+     * The pair is passed by non-const reference, so that a receiver can move
+     * it onward instead of sharing it. Receivers must therefore be connected
+     * directly, from the pool's thread.
+     * \param [out] job The identifier of the job
+     * \param [out] pair Output image data, which the pool releases afterwards
+     */
+    void jobOutput(int job, AlgorithmResultPair &pair);
+
+    /*!
+     * \brief Transfer the per-phase measurements of a job's algorithm
+     *
+     * This signal is emitted just before jobOutput(), for jobs whose
+     * output was not retrieved from the cache.
+     * \param [out] job The identifier of the job
+     * \param [out] profile The measurements
+     * \see Algorithm::profile()
+     */
+    void jobProfile(int job, const AlgorithmProfile &profile);
+
+    /*!
+     * \brief Signal that a job failed
+     * \param [out] job The identifier of the job
+     */
+    void jobFailed(int job);
+
+    /*!
+     * \brief Signal that a job was cancelled
+     * \param [out] job The identifier of the job
+     */
+    void jobCancelled(int job);
+
+    /*!
+     * \brief Signal that no jobs remain queued or running
+     */
+    void allFinished();
+
+private slots:
+    void receiveStatus(const QString &status);
+    void receiveOutput(const AlgorithmResultPair &pair);
+    void receiveProfile(const AlgorithmProfile &profile);
+    void receiveFail();
+    void receiveFinished();
+
+private:
+    /*!
+     * \brief The lifecycle of a job
+     */
+    enum class State : unsigned int {
+        QUEUED,
+        RUNNING,
+        SUCCEEDED,
+        FAILED,
+        CANCELLED
+    };
+
+    /*!
+     * \brief A job and its outcome
+     */
+    struct Job {
+        int id;
+        State state;
+        Algorithm *algorithm; // Owned by the job while queued
+        QVector<QImage> images;
+        AlgorithmThread *thread; // Non-null while running
+        bool cancelRequested;
+        AlgorithmResultPair output;
+        AlgorithmProfile profile;
+    };
+
+    /*!
+     * \brief Start queued jobs while threads are available
+     */
+    void startQueuedJobs(void);
+
+    /*!
+     * \brief Signal the outcomes of finished jobs according to AlgorithmPool::delivery,
+     * and delete the jobs whose outcomes have been signalled
+     */
+    void deliver(void);
+
+    /*!
+     * \brief Signal the outcome of a finished job
+     *
+     * The job's output is moved out of the job, so that the receivers
+     * of jobOutput() do not share it with the pool.
+     */
+    void deliverJob(Job *job);
+
+    /*!
+     * \brief Find the job being run by the thread which emitted the
+     * signal that triggered the calling slot
+     * \return The job, or null if the sender is not running a job
+     */
+    Job *senderJob(void) const;
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    AlgorithmPool(const AlgorithmPool& other);
+    AlgorithmPool& operator=(const AlgorithmPool& other);
+
+    // Data members
+private:
+    int maxThreads;
+    Delivery delivery;
+    ResultCache *cache;
+    int nextJobId;
+    /*!
+     * \brief All jobs whose outcomes have not yet been signalled, in submission order
+     */
+    QList<Job*> jobs;
+    QQueue<Job*> queuedJobs;
+    QHash<AlgorithmThread*, Job*> runningJobsByThread;
+    /*!
+     * \brief Threads which are not currently running jobs
+     */
+    QVector<AlgorithmThread*> idleThreads;
+    /*!
+     * \brief All threads created by this object
+     */
+    QVector<AlgorithmThread*> threads;
+};
+
+#endif // ALGORITHMPOOL_H
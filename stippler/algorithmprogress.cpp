@@ -0,0 +1,49 @@
+/*!
+** \file algorithmprogress.cpp
+** \brief Implementation of the AlgorithmProgress class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QCoreApplication>
+#include "algorithmprogress.h"
+
+AlgorithmProgress::AlgorithmProgress(void) :
+    phase(0), done(0), total(0), detail(0)
+{}
+
+void AlgorithmProgress::publish(const char *p, const int d, const int t, const int x) {
+    done.store(d);
+    total.store(t);
+    detail.store(x);
+    phase.storeRelease(p);
+}
+
+void AlgorithmProgress::clear(void) {
+    phase.storeRelease(0);
+}
+
+bool AlgorithmProgress::isActive(void) const {
+    return phase.loadAcquire() != 0;
+}
+
+QString AlgorithmProgress::text(void) const {
+    const char* p = phase.loadAcquire();
+    if(p == 0) {
+        return QString();
+    }
+    QString format = QCoreApplication::translate("QObject", p);
+    QString result = format.arg(done.load()).arg(total.load());
+    if(format.contains("%3")) {
+        result = result.arg(detail.load());
+    }
+    return result;
+}
@@ -0,0 +1,108 @@
+#ifndef ALGORITHMPROGRESS_H
+#define ALGORITHMPROGRESS_H
+
+/*!
+** \file algorithmprogress.h
+** \brief Definition of the AlgorithmProgress class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QString>
+
+/*!
+ * \brief A channel through which a worker thread publishes the progress
+ * of an Algorithm, for another thread to poll
+ *
+ * Publishing progress consists of a few atomic stores, and is therefore
+ * cheap enough to be done after every processing increment. The text of
+ * the progress message is only formatted when another thread calls text().
+ *
+ * A progress message is described by a phase, which is an untranslated
+ * format string with the placeholders `%1` (the number of items processed),
+ * `%2` (the total number of items), and, optionally, `%3` (a detail
+ * value, such as an iteration count). The phase string must have static
+ * storage duration. Phase strings are translated in the "QObject" context,
+ * so they should be marked with `QT_TRANSLATE_NOOP("QObject", ...)`.
+ *
+ * There is a single writer and any number of readers. The counters are
+ * not updated together as a unit, so a reader may briefly observe a mix
+ * of values from two consecutive updates. This is harmless for display
+ * purposes.
+ */
+class AlgorithmProgress
+{
+public:
+    /*!
+     * \brief Create a channel which initially has no progress to report
+     */
+    AlgorithmProgress(void);
+
+    /*!
+     * \brief Publish the current progress
+     *
+     * This function is intended to be called from the worker thread.
+     * \param [in] phase The untranslated format string describing the current
+     * phase of processing
+     * \param [in] done The number of items processed so far
+     * \param [in] total The number of items to process in the current phase
+     * \param [in] detail An additional value to substitute for `%3` in `phase`.
+     * Ignored if `phase` does not contain `%3`.
+     */
+    void publish(const char *phase, const int done, const int total, const int detail = 0);
+
+    /*!
+     * \brief Withdraw the current progress information
+     *
+     * Afterwards, isActive() returns `false` until the next call to publish().
+     * This function is intended to be called from the worker thread
+     * when it reports its status through other means.
+     */
+    void clear(void);
+
+    /*!
+     * \brief Determine whether there is progress information to display
+     * \return `true` if publish() has been called since the
+     * last call to clear()
+     */
+    bool isActive(void) const;
+
+    /*!
+     * \brief Format the current progress information
+     * \return The translated progress message, or an empty string
+     * if isActive() would return `false`
+     */
+    QString text(void) const;
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    AlgorithmProgress(const AlgorithmProgress& other);
+    AlgorithmProgress& operator=(const AlgorithmProgress& other);
+
+    // Data members
+private:
+    /*!
+     * \brief The format string of the current phase, or null
+     * if there is no progress to report
+     *
+     * This pointer is written last (with release semantics) by publish(),
+     * so that a reader which observes it also observes the counter values
+     * stored beforehand.
+     */
+    QAtomicPointer<const char> phase;
+    QAtomicInt done;
+    QAtomicInt total;
+    QAtomicInt detail;
+};
+
+#endif // ALGORITHMPROGRESS_H
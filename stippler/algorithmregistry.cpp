@@ -0,0 +1,95 @@
+/*!
+** \file algorithmregistry.cpp
+** \brief Implementation of the AlgorithmRegistry class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QObject>
+#include "algorithmregistry.h"
+#include "algorithms/rgb2labgreyalgorithm.h"
+#include "algorithms/midtonefilter.h"
+#include "algorithms/superpixels/slic.h"
+#include "algorithms/higher_order/filter/localdatafilter.h"
+
+static Algorithm *createGreyscale(void) {
+    return new Rgb2LabGreyAlgorithm();
+}
+
+static Algorithm *createMidtoneFilter(void) {
+    return new MidtoneFilter();
+}
+
+static Algorithm *createSLIC(void) {
+    return new SLIC();
+}
+
+static Algorithm *createLocalDataFilter_SIZE(void) {
+    ISuperpixelGenerator* slic = new SLIC();
+    return new LocalDataFilter(slic, LocalDataFilter::ScoreBasis::SIZE);
+}
+
+static Algorithm *createLocalDataFilter_STDDEV_LSTAR(void) {
+    ISuperpixelGenerator* slic = new SLIC();
+    return new LocalDataFilter(slic, LocalDataFilter::ScoreBasis::STDDEV_LSTAR);
+}
+
+static Algorithm *createLocalDataFilter_EXTERNAL(void) {
+    ISuperpixelGenerator* slic = new SLIC();
+    return new LocalDataFilter(slic, LocalDataFilter::ScoreBasis::EXTERNAL);
+}
+
+static Algorithm *createLocalDataFilter_ALL(void) {
+    QVector<LocalDataFilter::ScoreBasis> bases;
+    bases.append(LocalDataFilter::ScoreBasis::SIZE);
+    bases.append(LocalDataFilter::ScoreBasis::STDDEV_LSTAR);
+    bases.append(LocalDataFilter::ScoreBasis::EXTERNAL);
+    ISuperpixelGenerator* slic = new SLIC();
+    return new LocalDataFilter(slic, bases);
+}
+
+const QVector<AlgorithmRegistry::Entry> &AlgorithmRegistry::entries(void) {
+    static QVector<Entry> table;
+    if(table.isEmpty()) {
+        Entry entries[] = {
+            {"greyscale", QObject::tr("CIE L*a*b* greyscale"), createGreyscale},
+            {"midtones", QObject::tr("CIE L*a*b* midtones"), createMidtoneFilter},
+            {"slic", QObject::tr("SLIC superpixels"), createSLIC},
+            {"filter-size", QObject::tr("SLIC superpixel size filter"), createLocalDataFilter_SIZE},
+            {"filter-stddev", QObject::tr("SLIC superpixel greyscale stddev filter"),
+                createLocalDataFilter_STDDEV_LSTAR},
+            {"filter-external", QObject::tr("SLIC superpixel external selection map filter"),
+                createLocalDataFilter_EXTERNAL},
+            {"filter-all", QObject::tr("SLIC superpixel filters (all bases)"), createLocalDataFilter_ALL}
+        };
+        for(const Entry &entry : entries) {
+            table.append(entry);
+        }
+    }
+    return table;
+}
+
+QStringList AlgorithmRegistry::names(void) {
+    QStringList result;
+    foreach(const Entry &entry, entries()) {
+        result.append(entry.name);
+    }
+    return result;
+}
+
+Algorithm *AlgorithmRegistry::create(const QString &name) {
+    foreach(const Entry &entry, entries()) {
+        if(entry.name == name) {
+            return entry.factory();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+#ifndef ALGORITHMREGISTRY_H
+#define ALGORITHMREGISTRY_H
+
+/*!
+** \file algorithmregistry.h
+** \brief Definition of the AlgorithmRegistry class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class Algorithm;
+
+/*!
+ * \brief A table of the image processing algorithms which can be run by name
+ *
+ * The names are used to select algorithms from the command line
+ * (see BatchProcessor), and to label output files.
+ */
+class AlgorithmRegistry
+{
+public:
+    /*!
+     * \brief A function which creates an algorithm with its default parameters
+     * \return A new algorithm, ownership of which is transferred to the caller
+     */
+    typedef Algorithm *(*Factory)(void);
+
+    /*!
+     * \brief A registered algorithm
+     */
+    struct Entry {
+        /*!
+         * \brief A short, unique name, suitable for use in file names
+         */
+        QString name;
+        /*!
+         * \brief A human-readable description
+         */
+        QString description;
+        Factory factory;
+    };
+
+public:
+    /*!
+     * \brief List the registered algorithms
+     * \return All registered algorithms, in a fixed order
+     */
+    static const QVector<Entry> &entries(void);
+
+    /*!
+     * \brief List the names of the registered algorithms
+     * \return The names of the registered algorithms, in the order of entries()
+     */
+    static QStringList names(void);
+
+    /*!
+     * \brief Create an algorithm by name
+     * \param [in] name The name of a registered algorithm
+     * \return A new algorithm, ownership of which is transferred to the caller,
+     * or null if there is no algorithm with the given name
+     */
+    static Algorithm *create(const QString &name);
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    AlgorithmRegistry(void);
+};
+
+#endif // ALGORITHMREGISTRY_H
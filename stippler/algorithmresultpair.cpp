@@ -51,28 +51,53 @@
 ** --------------------------------------
 */
 
+#include <utility>
 #include "algorithmresultpair.h"
 
-AlgorithmResultPair::AlgorithmResultPair()
+AlgorithmResultPair::AlgorithmResultPair() :
+    m_image(), m_svgData(), m_originalBits(0)
+{}
+
+AlgorithmResultPair::AlgorithmResultPair(const AlgorithmResultPair &other) :
+    m_image(other.m_image), m_svgData(other.m_svgData), m_originalBits(other.m_originalBits)
+{}
+
+AlgorithmResultPair::AlgorithmResultPair(AlgorithmResultPair &&other) :
+    m_image(std::move(other.m_image)), m_svgData(std::move(other.m_svgData)),
+    m_originalBits(other.m_originalBits)
 {
+    other.m_originalBits = 0;
+}
 
+AlgorithmResultPair::~AlgorithmResultPair()
+{
 }
 
-AlgorithmResultPair::AlgorithmResultPair(const AlgorithmResultPair &other)
+AlgorithmResultPair &AlgorithmResultPair::operator=(const AlgorithmResultPair &other)
 {
     m_image = other.m_image;
     m_svgData = other.m_svgData;
+    m_originalBits = other.m_originalBits;
+    return *this;
 }
 
-AlgorithmResultPair::~AlgorithmResultPair()
+AlgorithmResultPair &AlgorithmResultPair::operator=(AlgorithmResultPair &&other)
 {
+    m_image = std::move(other.m_image);
+    m_svgData = std::move(other.m_svgData);
+    m_originalBits = other.m_originalBits;
+    other.m_originalBits = 0;
+    return *this;
 }
 
-AlgorithmResultPair::AlgorithmResultPair(const QImage &image, const QByteArray &svgData)
-{
-    m_image = image;
-    m_svgData = svgData;
-}
+AlgorithmResultPair::AlgorithmResultPair(const QImage &image, const QByteArray &svgData) :
+    m_image(image), m_svgData(svgData), m_originalBits(image.constBits())
+{}
+
+AlgorithmResultPair::AlgorithmResultPair(QImage &&image, QByteArray &&svgData) :
+    m_image(std::move(image)), m_svgData(std::move(svgData)),
+    m_originalBits(m_image.constBits())
+{}
 
 QByteArray AlgorithmResultPair::svgData() const
 {
@@ -83,3 +108,8 @@ QImage AlgorithmResultPair::image() const
 {
     return m_image;
 }
+
+bool AlgorithmResultPair::hasOriginalImageData() const
+{
+    return m_image.constBits() == m_originalBits;
+}
@@ -64,6 +64,15 @@
  *
  * It appears that slots and signals can transfer single objects, not multiple
  * objects, between the GUI thread and the image processing thread.
+ *
+ * The image data is never duplicated when an instance is copied, as QImage
+ * and QByteArray are implicitly shared. (Queued signals require copyable
+ * types.) Instead, the data is duplicated if one holder modifies it while
+ * another still refers to it, so that every holder on the way from
+ * the worker thread to the final consumer should move its instance onward,
+ * or release it, rather than keep a copy. The move constructor and move
+ * assignment operator do so without touching reference counts.
+ * hasOriginalImageData() lets consumers assert that this was the case.
  */
 class AlgorithmResultPair
 {
@@ -73,12 +82,20 @@ public:
      */
     AlgorithmResultPair();
     /*!
-     * \brief Trivial copy constructor
+     * \brief Copy constructor, which shares the image data of `other`
      * \param [in] other The source object
      */
     AlgorithmResultPair(const AlgorithmResultPair &other);
+    /*!
+     * \brief Move constructor
+     * \param [in] other The source object, which is left empty
+     */
+    AlgorithmResultPair(AlgorithmResultPair &&other);
     ~AlgorithmResultPair();
 
+    AlgorithmResultPair &operator=(const AlgorithmResultPair &other);
+    AlgorithmResultPair &operator=(AlgorithmResultPair &&other);
+
     /*!
      * \brief Construct an instance containing the given image data
      * \param [in] image Raster image data
@@ -86,6 +103,13 @@ public:
      */
     AlgorithmResultPair(const QImage &image, const QByteArray &svgData);
 
+    /*!
+     * \brief Construct an instance which takes over the given image data
+     * \param [in] image Raster image data, which is left null
+     * \param [in] svgData Vector image data (SVG file contents), which is left empty
+     */
+    AlgorithmResultPair(QImage &&image, QByteArray &&svgData);
+
     /*!
      * \brief The contained raster image data
      * \return Raster image data
@@ -97,9 +121,23 @@ public:
      */
     QByteArray svgData() const;
 
+    /*!
+     * \brief Determine whether the raster image data is still the data with
+     * which the instance, or the instance it was copied or moved from, was constructed
+     *
+     * This function is intended for debugging assertions, which check that
+     * the image data has not been duplicated on its way to a consumer.
+     * \return `false` if the image data has been replaced by a deep copy
+     */
+    bool hasOriginalImageData() const;
+
 private:
     QImage m_image;
     QByteArray m_svgData;
+    /*!
+     * \brief The address of the raster image data when the instance was constructed
+     */
+    const uchar *m_originalBits;
 };
 
 Q_DECLARE_METATYPE(AlgorithmResultPair)
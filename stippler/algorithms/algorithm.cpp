@@ -55,12 +55,15 @@
 **
 */
 
+#include <algorithm>
 #include <QSvgGenerator>
 #include <QPainter>
 #include <QBuffer>
 #include "algorithm.h"
 #include "imagedata.h"
 #include "imagemanager.h"
+#include "algorithmprogress.h"
+#include "cancellationtoken.h"
 
 Algorithm::Algorithm() :
     input(0),
@@ -71,7 +74,17 @@ Algorithm::Algorithm() :
     svgGenerator(0),
     svgFileIOWrapper(0),
     failed(false),
-    finished(false)
+    finished(false),
+    resultCache(0),
+    incrementBudget(static_cast<qint64>(ALGORITHM_DEFAULT_INCREMENT_BUDGET) * 1000000),
+    progressChannel(0),
+    cancellationToken(0),
+    incrementScale(1.0),
+    currentPhase(0),
+    phaseIncrementScales(),
+    lastIncrementDuration(0),
+    incrementIsAdaptive(false),
+    lastIncrementIsAdaptive(false)
 {
 
 }
@@ -106,11 +119,32 @@ bool Algorithm::initialize(QVector<ImageData *> *&images) {
 bool Algorithm::initialize(ImageData *&image) {
     cleanup();
     timer.start();
+    processingProfile.clear();
+    phaseIncrementScales.clear();
+    currentPhase = 0;
+    enterPhase(ALGORITHMPROFILE_INITIALIZATION_PHASE);
+    lastIncrementIsAdaptive = false;
     input = image;
     image = 0;
     return true;
 }
 
+bool Algorithm::timedIncrement(bool &f, QString &status) {
+    incrementIsAdaptive = false;
+    qint64 start = timer.nsecsElapsed();
+    processingProfile.startIncrement(start);
+    bool result = increment(f, status);
+    const qint64 end = timer.nsecsElapsed();
+    processingProfile.stopIncrement(end);
+    lastIncrementDuration = end - start;
+    lastIncrementIsAdaptive = incrementIsAdaptive;
+    return result;
+}
+
+void Algorithm::setIncrementBudget(const qint64 &milliseconds) {
+    incrementBudget = milliseconds * 1000000;
+}
+
 bool Algorithm::output(QImage *&image, QByteArray *& svgData) {
     image = 0;
     svgData = 0;
@@ -128,6 +162,70 @@ bool Algorithm::isFinished(void) const {
     return finished;
 }
 
+QString Algorithm::parameterSignature(void) const {
+    return QString();
+}
+
+void Algorithm::setResultCache(ResultCache *cache) {
+    resultCache = cache;
+}
+
+void Algorithm::setProgressChannel(AlgorithmProgress *channel) {
+    progressChannel = channel;
+}
+
+void Algorithm::setCancellationToken(const CancellationToken *token) {
+    cancellationToken = token;
+}
+
+bool Algorithm::isCancelled(void) const {
+    return cancellationToken != 0 && cancellationToken->isCancelled();
+}
+
+const AlgorithmProfile &Algorithm::profile(void) const {
+    return processingProfile;
+}
+
+void Algorithm::enterPhase(const char *phase) {
+    processingProfile.enterPhase(phase, timer.nsecsElapsed());
+    if(phase == currentPhase) {
+        return;
+    }
+    if(currentPhase != 0) {
+        phaseIncrementScales.insert(currentPhase, incrementScale);
+    }
+    currentPhase = phase;
+    incrementScale = phaseIncrementScales.value(phase, 1.0);
+    // The last increment belonged to another phase
+    lastIncrementIsAdaptive = false;
+}
+
+void Algorithm::countWork(const qint64 &iterations, const qint64 &pixels) {
+    processingProfile.countWork(iterations, pixels);
+}
+
+void Algorithm::countAllocation(const qint64 &bytes) {
+    processingProfile.countAllocation(bytes);
+}
+
+void Algorithm::appendNestedProfile(const Algorithm &inner) {
+    processingProfile.appendNested(inner.profile());
+}
+
+void Algorithm::reportProgress(QString &status, const char *phase,
+                               const pxind &done, const pxind &total,
+                               const int detail) const {
+    if(progressChannel != 0) {
+        progressChannel->publish(phase, done, total, detail);
+        status.clear();
+    } else {
+        status = QObject::tr(phase).arg(done).arg(total);
+        if(status.contains("%3")) {
+            status = status.arg(detail);
+        }
+    }
+}
+
 bool Algorithm::initializeOutput(const QColor& fillColor,
         const bool& vectorOutput,
         const QString * const &title,
@@ -140,6 +238,7 @@ bool Algorithm::initializeOutput(const QColor& fillColor,
     // Setup raster output objects
     outputImage = new QImage(input->size(), QImage::Format_ARGB32_Premultiplied);
     outputImage->fill(fillColor);
+    countAllocation(outputImage->byteCount());
 
     // Setup vector output objects
     if(vectorOutput) {
@@ -160,6 +259,38 @@ bool Algorithm::initializeOutput(const QColor& fillColor,
     return !(outputImage->isNull());
 }
 
+pxind Algorithm::adaptiveIncrement(const pxind &granularity) {
+    incrementIsAdaptive = true;
+    qint64 budget = incrementBudget;
+    if(budget == ALGORITHM_RUN_TO_COMPLETION) {
+        if(cancellationToken == 0) {
+            return ALGORITHM_MAX_INCREMENT;
+        }
+        budget = static_cast<qint64>(ALGORITHM_CANCELLATION_LATENCY) * 1000000;
+    }
+
+    // Adjust the scale using the previous increment, if it was also sized by this function
+    if(lastIncrementIsAdaptive) {
+        qreal ratio = static_cast<qreal>(budget) /
+                static_cast<qreal>(std::max(lastIncrementDuration, static_cast<qint64>(1)));
+        if(ratio > ALGORITHM_MAX_INCREMENT_GROWTH) {
+            ratio = ALGORITHM_MAX_INCREMENT_GROWTH;
+        }
+        incrementScale *= ratio;
+        lastIncrementIsAdaptive = false;
+    }
+
+    qreal scaled = incrementScale * static_cast<qreal>(granularity);
+    if(scaled < 1.0) {
+        incrementScale = 1.0 / static_cast<qreal>(granularity);
+        return 1;
+    } else if(scaled > ALGORITHM_MAX_INCREMENT) {
+        incrementScale = ALGORITHM_MAX_INCREMENT / static_cast<qreal>(granularity);
+        return ALGORITHM_MAX_INCREMENT;
+    }
+    return static_cast<pxind>(scaled);
+}
+
 void Algorithm::finalizeOutput(void) {
     // Note that the QPainter::end() function is called by QPainter::~QPainter.
     if(outputSVGPainter != 0) {
@@ -18,7 +18,10 @@
 */
 
 #include <QElapsedTimer>
+#include <QHash>
 #include <QVector>
+#include "imagedata.h"
+#include "algorithmprofile.h"
 
 class QColor;
 class QImage;
@@ -27,7 +30,49 @@ class QString;
 class QByteArray;
 class QSvgGenerator;
 class QBuffer;
-class ImageData;
+class ResultCache;
+class AlgorithmProgress;
+class CancellationToken;
+
+/*!
+  \brief The default target duration of one processing increment, in milliseconds
+  \see Algorithm::setIncrementBudget()
+ */
+#define ALGORITHM_DEFAULT_INCREMENT_BUDGET 20
+
+/*!
+  \brief An increment budget which causes each loop over pixels or superpixels
+  to be completed in a single processing increment
+  \see Algorithm::setIncrementBudget()
+ */
+#define ALGORITHM_RUN_TO_COMPLETION 0
+
+/*!
+  \brief The largest number of loop iterations performed in one processing increment
+
+  This bound keeps loop indices from overflowing when the increment size
+  is added to them.
+ */
+#define ALGORITHM_MAX_INCREMENT (1 << 29)
+
+/*!
+  \brief The target duration of one processing increment, in milliseconds,
+  when the increment budget is #ALGORITHM_RUN_TO_COMPLETION and a
+  cancellation token has been set
+
+  This value bounds the time taken to stop processing after cancellation.
+  \see Algorithm::setCancellationToken()
+ */
+#define ALGORITHM_CANCELLATION_LATENCY 10
+
+/*!
+  \brief The largest factor by which the size of processing increments
+  can grow from one increment to the next
+
+  Increment sizes can shrink by any factor, so that the budget is restored
+  quickly when processing enters a more expensive stage.
+ */
+#define ALGORITHM_MAX_INCREMENT_GROWTH 2.0
 
 /*!
  * \brief Abstract image processing algorithm
@@ -100,6 +145,37 @@ public:
      */
     virtual bool increment(bool & finished, QString & status) = 0;
 
+    /*!
+     * \brief Perform one unit of processing, and measure its duration
+     *
+     * This function calls increment(). Callers should use this function
+     * instead of increment(), so that the sizes of processing increments
+     * can adapt to the increment budget (see setIncrementBudget()).
+     * \param [out] finished Whether or not processing has completed or failed (true),
+     * or is incomplete (false).
+     * \param [out] status A string describing the current progress towards completion
+     * \return The return value of increment()
+     */
+    bool timedIncrement(bool & finished, QString & status);
+
+    /*!
+     * \brief Set the target duration of one processing increment
+     *
+     * Derived classes size their loops with adaptiveIncrement(), which scales
+     * a nominal number of loop iterations such that each processing increment
+     * takes approximately this long. Shorter increments make progress reporting
+     * and aborting more responsive, whereas longer increments reduce overhead.
+     *
+     * The budget is not reset by initialize().
+     * \param [in] milliseconds The target duration, or #ALGORITHM_RUN_TO_COMPLETION,
+     * for headless use, to complete each stage of processing without slicing it
+     * into several increments. If a cancellation token has been set
+     * (setCancellationToken()), stages are still sliced into increments of
+     * #ALGORITHM_CANCELLATION_LATENCY, so that cancellation can be observed
+     * between increments.
+     */
+    virtual void setIncrementBudget(const qint64 &milliseconds);
+
     /*!
      * \brief Collect the results of processing
      *
@@ -123,6 +199,64 @@ public:
      */
     virtual bool isFinished(void) const;
 
+    /*!
+     * \brief Describe the algorithm and the values of all of its parameters
+     *
+     * Two instances with the same signature must produce the same output
+     * from the same input images, as the signature is used to form keys
+     * for ResultCache.
+     * \return A string identifying the algorithm and its parameters, or an empty
+     * string if the algorithm's output should not be cached
+     */
+    virtual QString parameterSignature(void) const;
+
+    /*!
+     * \brief Provide a cache from which the algorithm may retrieve
+     * intermediate results instead of computing them
+     *
+     * This function must be called before initialize().
+     * \param [in] cache The cache, which is not owned by this object,
+     * and must outlive it. Passing null disables caching.
+     */
+    virtual void setResultCache(ResultCache *cache);
+
+    /*!
+     * \brief Provide a channel through which to publish progress information
+     *
+     * When a channel is set, phases of processing which loop over pixels or
+     * superpixels publish their progress to the channel, and leave the `status`
+     * output argument of increment() empty, instead of formatting a status message
+     * after every increment. Other status messages are still
+     * returned through increment().
+     * \param [in] channel The channel, which is not owned by this object,
+     * and must outlive it. Passing null restores the formatting of all
+     * status messages by increment().
+     */
+    virtual void setProgressChannel(AlgorithmProgress *channel);
+
+    /*!
+     * \brief Provide a token through which processing can be cancelled
+     *
+     * The caller is expected to check the token between processing increments,
+     * and to discard this object if it has been cancelled. Cancellation may
+     * leave the object's intermediate results incomplete, as loops run by
+     * TaskScheduler skip their remaining subranges, so no further processing
+     * increments should be performed, and no output collected.
+     * \param [in] token The token, which is not owned by this object,
+     * and must outlive it. Passing null makes processing uncancellable.
+     */
+    virtual void setCancellationToken(const CancellationToken *token);
+
+    /*!
+     * \brief Per-phase measurements of the processing done since the last
+     * call to initialize()
+     *
+     * The profile can be queried once processing has finished, or failed,
+     * as it is not cleared until initialize() is called again.
+     * \return The measurements of the phases entered so far
+     */
+    const AlgorithmProfile &profile(void) const;
+
 protected:
 
     /*!
@@ -168,6 +302,89 @@ protected:
      */
     virtual void finalizeOutput(void);
 
+    /*!
+     * \brief Choose the number of loop iterations to perform in the current
+     * processing increment
+     *
+     * The nominal number of iterations is scaled by a factor which is adjusted
+     * after each processing increment, in proportion to the ratio of the increment
+     * budget to the measured duration of the increment. The factor is only adjusted
+     * when consecutive increments both call this function within the same phase
+     * (enterPhase()), so that the durations of stages without loops, and of
+     * other phases, do not affect it. Each phase keeps its own factor, which
+     * starts at one (the nominal granularity) when the phase is first entered.
+     * \param [in] granularity The nominal number of loop iterations, which
+     * must be positive
+     * \return The number of loop iterations, between 1 and #ALGORITHM_MAX_INCREMENT.
+     * In run-to-completion mode, without a cancellation token, #ALGORITHM_MAX_INCREMENT
+     * is returned, and callers are expected to clamp it to the end of their loops.
+     * \see setIncrementBudget()
+     */
+    pxind adaptiveIncrement(const pxind &granularity);
+
+    /*!
+     * \brief Report the progress of a loop over pixels or superpixels
+     *
+     * If a progress channel has been set, the progress is published to it,
+     * and `status` is cleared. Otherwise, `status` is set to the
+     * translated and formatted message.
+     * \param [out] status The status output argument of increment()
+     * \param [in] phase The untranslated format string describing the loop,
+     * marked with `QT_TRANSLATE_NOOP("QObject", ...)`. See AlgorithmProgress
+     * for a description of its placeholders.
+     * \param [in] done The number of loop iterations performed so far
+     * \param [in] total The total number of loop iterations
+     * \param [in] detail An additional value to substitute for `%3` in `phase`
+     * \see setProgressChannel()
+     */
+    void reportProgress(QString &status, const char *phase,
+                        const pxind &done, const pxind &total,
+                        const int detail = 0) const;
+
+    /*!
+     * \brief Determine whether processing has been cancelled
+     *
+     * Derived classes should check this function before storing intermediate
+     * results which may be incomplete, such as in the ResultCache.
+     * \return `true` if a cancellation token has been set and cancelled
+     * \see setCancellationToken()
+     */
+    bool isCancelled(void) const;
+
+    /*!
+     * \brief Charge subsequent processing time and work to a phase
+     *
+     * Derived classes should call this function as they move between the values
+     * of their `Progress` enumerations, before doing the work of the new phase.
+     * Work done by initialize() is charged to #ALGORITHMPROFILE_INITIALIZATION_PHASE.
+     *
+     * The phase also selects the factor used by adaptiveIncrement().
+     * \param [in] phase The name of the phase, which must have static storage duration
+     * \see profile()
+     */
+    void enterPhase(const char *phase);
+
+    /*!
+     * \brief Count work done in the current phase
+     * \param [in] iterations The number of loop iterations
+     * \param [in] pixels The number of pixels read or written
+     */
+    void countWork(const qint64 &iterations, const qint64 &pixels = 0);
+
+    /*!
+     * \brief Count memory allocated in the current phase
+     * \param [in] bytes The size of the allocation
+     */
+    void countAllocation(const qint64 &bytes);
+
+    /*!
+     * \brief Nest the measurements of an algorithm run internally under the current phase
+     *
+     * This function should be called once, when the inner algorithm has finished.
+     * \param [in] inner The algorithm run by this object
+     */
+    void appendNestedProfile(const Algorithm &inner);
+
     /*!
      * \brief The effective destructor
      *
@@ -233,9 +450,77 @@ protected:
     /*!
      * \brief Used to measure processing time
      *
-     * The timer is started in initialize()
+     * The timer is started in initialize(), and is the wall clock
+     * of Algorithm::processingProfile.
      */
     QElapsedTimer timer;
+    /*!
+     * \brief Measurements of the processing done since the last call to initialize()
+     * \see profile()
+     */
+    AlgorithmProfile processingProfile;
+    /*!
+     * \brief A cache of intermediate results, which is not owned by this object
+     * \see setResultCache()
+     */
+    ResultCache *resultCache;
+    /*!
+     * \brief The target duration of one processing increment, in nanoseconds,
+     * or #ALGORITHM_RUN_TO_COMPLETION
+     *
+     * Derived classes which run other algorithms internally should
+     * pass this value on to them.
+     * \see setIncrementBudget()
+     */
+    qint64 incrementBudget;
+    /*!
+     * \brief The channel to which progress is published, which is not owned
+     * by this object, or null
+     * \see setProgressChannel()
+     */
+    AlgorithmProgress *progressChannel;
+    /*!
+     * \brief The token through which processing is cancelled, which is not owned
+     * by this object, or null
+     *
+     * Derived classes which run other algorithms internally should
+     * pass this value on to them.
+     * \see setCancellationToken()
+     */
+    const CancellationToken *cancellationToken;
+
+private:
+    // Adaptive increment sizing
+    /*!
+     * \brief The factor applied to nominal increment sizes by adaptiveIncrement()
+     * in the current phase
+     */
+    qreal incrementScale;
+    /*!
+     * \brief The phase most recently passed to enterPhase(), or null
+     */
+    const char *currentPhase;
+    /*!
+     * \brief The values of Algorithm::incrementScale of the phases other than
+     * the current phase, keyed by phase name
+     *
+     * Phase names have static storage duration, so they are compared by address.
+     */
+    QHash<const char *, qreal> phaseIncrementScales;
+    /*!
+     * \brief The duration of the last processing increment, in nanoseconds
+     */
+    qint64 lastIncrementDuration;
+    /*!
+     * \brief Whether adaptiveIncrement() was called during the current
+     * processing increment
+     */
+    bool incrementIsAdaptive;
+    /*!
+     * \brief Whether Algorithm::lastIncrementDuration is the duration of an
+     * increment sized by adaptiveIncrement()
+     */
+    bool lastIncrementIsAdaptive;
 };
 
 #endif // ALGORITHM_H
@@ -0,0 +1,200 @@
+/*!
+** \file algorithmprofile.cpp
+** \brief Implementation of the AlgorithmProfile class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <algorithm>
+#include <QJsonArray>
+#include "algorithmprofile.h"
+#include "taskscheduler.h"
+
+AlgorithmProfile::Phase::Phase(void) :
+    name(), depth(0), wallTime(0), cpuTime(0), increments(0),
+    iterations(0), pixels(0), bytesAllocated(0)
+{}
+
+AlgorithmProfile::AlgorithmProfile(void) :
+    phaseList(), currentName(0), currentIndex(-1), isTiming(false),
+    wallStart(0), cpuStart(0)
+{}
+
+void AlgorithmProfile::clear(void) {
+    phaseList.clear();
+    currentName = 0;
+    currentIndex = -1;
+    isTiming = false;
+}
+
+void AlgorithmProfile::startIncrement(const qint64 &wallClock) {
+    wallStart = wallClock;
+    cpuStart = TaskScheduler::cpuTime();
+    isTiming = true;
+}
+
+void AlgorithmProfile::stopIncrement(const qint64 &wallClock) {
+    chargeTime(wallClock);
+    isTiming = false;
+    if(currentName != 0) {
+        currentPhase().increments += 1;
+    }
+}
+
+void AlgorithmProfile::enterPhase(const char *name, const qint64 &wallClock) {
+    if(name == currentName) {
+        return;
+    }
+    chargeTime(wallClock);
+    currentName = name;
+    currentIndex = -1;
+    const QString phaseName = QString::fromLatin1(name);
+    for(int i = 0; i < phaseList.size(); i += 1) {
+        if(phaseList[i].depth == 0 && phaseList[i].name == phaseName) {
+            currentIndex = i;
+            break;
+        }
+    }
+}
+
+void AlgorithmProfile::countWork(const qint64 &iterations, const qint64 &pixels) {
+    if(currentName == 0) {
+        return;
+    }
+    Phase &phase = currentPhase();
+    phase.iterations += iterations;
+    phase.pixels += pixels;
+}
+
+void AlgorithmProfile::countAllocation(const qint64 &bytes) {
+    if(currentName == 0) {
+        return;
+    }
+    currentPhase().bytesAllocated += bytes;
+}
+
+void AlgorithmProfile::appendNested(const AlgorithmProfile &nested) {
+    if(currentName == 0 || nested.isEmpty()) {
+        return;
+    }
+    currentPhase();
+    int position = currentIndex + 1;
+    foreach(Phase phase, nested.phaseList) {
+        phase.depth += 1;
+        phaseList.insert(position, phase);
+        position += 1;
+    }
+}
+
+bool AlgorithmProfile::isEmpty(void) const {
+    return phaseList.isEmpty();
+}
+
+const QVector<AlgorithmProfile::Phase> &AlgorithmProfile::phases(void) const {
+    return phaseList;
+}
+
+AlgorithmProfile::Phase AlgorithmProfile::total(void) const {
+    Phase sum;
+    sum.name = QString("TOTAL");
+    foreach(const Phase &phase, phaseList) {
+        // Nested phases ran within the increments of the phases above them
+        if(phase.depth == 0) {
+            sum.wallTime += phase.wallTime;
+            sum.cpuTime += phase.cpuTime;
+            sum.increments += phase.increments;
+        }
+        sum.iterations += phase.iterations;
+        sum.pixels += phase.pixels;
+        sum.bytesAllocated += phase.bytesAllocated;
+    }
+    return sum;
+}
+
+QString AlgorithmProfile::toTable(void) const {
+    QVector<Phase> rows = phaseList;
+    rows.append(total());
+    const QString header("Phase");
+    int nameWidth = header.size();
+    foreach(const Phase &phase, rows) {
+        nameWidth = std::max(nameWidth, 2 * phase.depth + phase.name.size());
+    }
+
+    QString table = QString("%1 %2 %3 %4 %5 %6 %7\n")
+            .arg(header, -nameWidth)
+            .arg("Wall (ms)", 10)
+            .arg("CPU (ms)", 10)
+            .arg("Increments", 10)
+            .arg("Iterations", 12)
+            .arg("Pixels", 12)
+            .arg("Allocated (B)", 14);
+    foreach(const Phase &phase, rows) {
+        table += QString("%1 %2 %3 %4 %5 %6 %7\n")
+                .arg(QString(2 * phase.depth, QLatin1Char(' ')) + phase.name, -nameWidth)
+                .arg(phase.wallTime / 1.0e6, 10, 'f', 2)
+                .arg(phase.cpuTime / 1.0e6, 10, 'f', 2)
+                .arg(phase.increments, 10)
+                .arg(phase.iterations, 12)
+                .arg(phase.pixels, 12)
+                .arg(phase.bytesAllocated, 14);
+    }
+    return table;
+}
+
+QJsonObject AlgorithmProfile::toJson(void) const {
+    QJsonArray phaseArray;
+    foreach(const Phase &phase, phaseList) {
+        phaseArray.append(phaseToJson(phase));
+    }
+    QJsonObject object;
+    object.insert("phases", phaseArray);
+    object.insert("total", phaseToJson(total()));
+    return object;
+}
+
+AlgorithmProfile::Phase &AlgorithmProfile::currentPhase(void) {
+    Q_ASSERT(currentName != 0);
+    if(currentIndex < 0) {
+        Phase phase;
+        phase.name = QString::fromLatin1(currentName);
+        phaseList.append(phase);
+        currentIndex = phaseList.size() - 1;
+    }
+    return phaseList[currentIndex];
+}
+
+void AlgorithmProfile::chargeTime(const qint64 &wallClock) {
+    if(!isTiming) {
+        return;
+    }
+    const qint64 cpuClock = TaskScheduler::cpuTime();
+    if(currentName != 0) {
+        Phase &phase = currentPhase();
+        phase.wallTime += wallClock - wallStart;
+        phase.cpuTime += cpuClock - cpuStart;
+    }
+    wallStart = wallClock;
+    cpuStart = cpuClock;
+}
+
+QJsonObject AlgorithmProfile::phaseToJson(const Phase &phase) {
+    QJsonObject object;
+    object.insert("name", phase.name);
+    object.insert("depth", phase.depth);
+    object.insert("wallMs", phase.wallTime / 1.0e6);
+    object.insert("cpuMs", phase.cpuTime / 1.0e6);
+    object.insert("increments", phase.increments);
+    // JSON numbers are doubles, which represent these counts exactly up to 2^53
+    object.insert("iterations", static_cast<double>(phase.iterations));
+    object.insert("pixels", static_cast<double>(phase.pixels));
+    object.insert("bytesAllocated", static_cast<double>(phase.bytesAllocated));
+    return object;
+}
@@ -0,0 +1,219 @@
+#ifndef ALGORITHMPROFILE_H
+#define ALGORITHMPROFILE_H
+
+/*!
+** \file algorithmprofile.h
+** \brief Definition of the AlgorithmProfile class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QJsonObject>
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+/*!
+  \brief The name of the phase to which work done by Algorithm::initialize()
+  is attributed
+ */
+#define ALGORITHMPROFILE_INITIALIZATION_PHASE "INITIALIZE"
+
+/*!
+ * \brief Per-phase measurements of the processing done by an Algorithm
+ *
+ * Algorithms divide processing into phases, which usually correspond to the
+ * values of their `Progress` enumerations, and announce each phase as they
+ * enter it. Time spent within processing increments is charged to the
+ * current phase, along with the work counted by the algorithm: loop iterations,
+ * pixels touched, and bytes allocated. A phase entered several times, such as
+ * a phase of an iterative algorithm, accumulates its measurements in a single entry.
+ *
+ * Wall-clock time is only measured during processing increments, so time
+ * spent between increments (e.g. handling events) is excluded. CPU time is
+ * the CPU time of the thread running the algorithm, together with the time
+ * the threads of TaskScheduler spent on its loops (TaskScheduler::cpuTime()),
+ * so it is not affected by other algorithms running concurrently.
+ * In parallel phases, it can exceed the wall-clock time.
+ *
+ * Counting work is cheap, as it only adds to the counters of the current phase,
+ * so it can be done once per processing increment. A phase is recorded once
+ * time or work has been charged to it.
+ *
+ * The measurements of algorithms run internally by another algorithm can be
+ * nested under the phase of the outer algorithm that runs them (appendNested()).
+ */
+class AlgorithmProfile
+{
+public:
+    /*!
+     * \brief The measurements of one phase
+     */
+    struct Phase {
+        Phase(void);
+
+        QString name;
+        /*!
+         * \brief The number of levels by which the phase is nested
+         * under the phases of outer algorithms
+         */
+        int depth;
+        /*!
+         * \brief Wall-clock time, in nanoseconds
+         */
+        qint64 wallTime;
+        /*!
+         * \brief CPU time of the thread running the algorithm, and of the threads
+         * which helped with its loops, in nanoseconds
+         */
+        qint64 cpuTime;
+        /*!
+         * \brief The number of processing increments which ended in the phase
+         */
+        int increments;
+        /*!
+         * \brief The number of loop iterations, in units specific to the phase
+         * (pixels, superpixels, clusters, etc.)
+         */
+        qint64 iterations;
+        qint64 pixels;
+        qint64 bytesAllocated;
+    };
+
+    AlgorithmProfile(void);
+
+    /*!
+     * \brief Discard all measurements
+     */
+    void clear(void);
+
+    /*!
+     * \brief Start measuring time, at the beginning of a processing increment
+     * \param [in] wallClock The current wall-clock time, in nanoseconds,
+     * relative to any fixed reference
+     */
+    void startIncrement(const qint64 &wallClock);
+
+    /*!
+     * \brief Stop measuring time, at the end of a processing increment
+     * \param [in] wallClock The current wall-clock time, relative to the
+     * same reference as in startIncrement()
+     */
+    void stopIncrement(const qint64 &wallClock);
+
+    /*!
+     * \brief Charge subsequent time and work to a phase
+     *
+     * Entering the current phase again has no effect.
+     * \param [in] name The name of the phase, which must have static storage duration
+     * \param [in] wallClock The current wall-clock time, relative to the
+     * same reference as in startIncrement()
+     */
+    void enterPhase(const char *name, const qint64 &wallClock);
+
+    /*!
+     * \brief Count work done in the current phase
+     * \param [in] iterations The number of loop iterations
+     * \param [in] pixels The number of pixels read or written
+     */
+    void countWork(const qint64 &iterations, const qint64 &pixels);
+
+    /*!
+     * \brief Count memory allocated in the current phase
+     * \param [in] bytes The size of the allocation
+     */
+    void countAllocation(const qint64 &bytes);
+
+    /*!
+     * \brief Insert the measurements of an algorithm run during the current phase,
+     * one level below it
+     *
+     * The time of the nested phases is already included in the time of the
+     * current phase, and is therefore excluded from total(). Their work is
+     * counted in total(), however.
+     * \param [in] nested The profile of the inner algorithm, at the end of its processing
+     */
+    void appendNested(const AlgorithmProfile &nested);
+
+    /*!
+     * \brief Determine whether anything has been measured
+     * \return `true` if no phases have been recorded
+     */
+    bool isEmpty(void) const;
+
+    /*!
+     * \brief The recorded phases, in the order in which they were first entered
+     *
+     * Nested phases follow the phase under which they are nested.
+     */
+    const QVector<Phase> &phases(void) const;
+
+    /*!
+     * \brief Sum the measurements of all phases
+     * \return A phase named "TOTAL", with a depth of zero
+     */
+    Phase total(void) const;
+
+    /*!
+     * \brief Format the measurements as a plain text table, with one
+     * row per phase, followed by a row for total()
+     * \return The lines of the table, each terminated by a newline character
+     */
+    QString toTable(void) const;
+
+    /*!
+     * \brief Convert the measurements to JSON
+     *
+     * The object has a "phases" array, and a "total" object. Each phase is
+     * an object with the keys "name", "depth", "wallMs", "cpuMs",
+     * "increments", "iterations", "pixels" and "bytesAllocated".
+     * Times are in milliseconds.
+     * \return A JSON object describing the profile
+     */
+    QJsonObject toJson(void) const;
+
+private:
+    /*!
+     * \brief Retrieve the entry of the current phase, creating it if necessary
+     */
+    Phase &currentPhase(void);
+
+    /*!
+     * \brief Charge the time elapsed since the last measurement to the current phase
+     * \param [in] wallClock The current wall-clock time
+     */
+    void chargeTime(const qint64 &wallClock);
+
+    static QJsonObject phaseToJson(const Phase &phase);
+
+    // Data members
+private:
+    QVector<Phase> phaseList;
+    /*!
+     * \brief The name of the current phase, or null before any phase is entered
+     */
+    const char *currentName;
+    /*!
+     * \brief The index of the current phase in AlgorithmProfile::phaseList,
+     * or -1 if it has not been recorded yet
+     */
+    int currentIndex;
+    /*!
+     * \brief Whether a processing increment is in progress
+     */
+    bool isTiming;
+    qint64 wallStart;
+    qint64 cpuStart;
+};
+
+Q_DECLARE_METATYPE(AlgorithmProfile)
+
+#endif // ALGORITHMPROFILE_H
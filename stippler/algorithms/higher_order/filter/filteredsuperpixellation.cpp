@@ -18,14 +18,17 @@
 FilteredSuperpixellation::FilteredSuperpixellation(
         ImageData *& i,
         pxind *& sL,
+        pxind *& sPx,
+        pxind *& sOff,
+        SuperpixelStatistics *& stats,
         Superpixel **& s,
         const pxind &nS,
         bool *& sS,
         bool *& sP
-    ) : Superpixellation(i, sL, s, nS),
+    ) : Superpixellation(i, sL, sPx, sOff, stats, s, nS),
     selectedSuperpixels(sS),
-    selectedPixels(sP)
-
+    selectedPixels(sP),
+    shareSelections(false)
 {
     sS = 0;
     sP = 0;
@@ -38,7 +41,8 @@ FilteredSuperpixellation::FilteredSuperpixellation(
         bool *& sP
     )  : Superpixellation(*superpixellation),
     selectedSuperpixels(sS),
-    selectedPixels(sP)
+    selectedPixels(sP),
+    shareSelections(false)
 {
     Q_ASSERT(i == img);
     i = 0;
@@ -48,8 +52,25 @@ FilteredSuperpixellation::FilteredSuperpixellation(
     sP = 0;
 }
 
+FilteredSuperpixellation::FilteredSuperpixellation(
+        ImageData *&i,
+        Superpixellation *& superpixellation,
+        const bool * const sS,
+        const bool * const sP,
+        const bool shareS
+    )  : Superpixellation(*superpixellation),
+    selectedSuperpixels(sS),
+    selectedPixels(sP),
+    shareSelections(shareS)
+{
+    Q_ASSERT(i == img);
+    i = 0;
+    delete superpixellation;
+    superpixellation = 0;
+}
+
 FilteredSuperpixellation::~FilteredSuperpixellation(void) {
-    if(!shareAll) {
+    if(!shareAll && !shareSelections) {
         if(selectedSuperpixels != 0) {
             delete [] selectedSuperpixels;
         }
@@ -34,6 +34,11 @@ public:
      * \param [in] superpixelLabels An array with the same number of elements as
      * `img.pixelCount()` (ImageData::pixelCount()), where the element at index
      * `k` stores the superpixel ID of the pixel at 1D coordinate `k`.
+     * \param [in] superpixelPixels The 1D coordinates of all pixels in the image,
+     * grouped by superpixel
+     * \param [in] superpixelOffsets The start of the range of each superpixel
+     * in `superpixelPixels`, followed by `img.pixelCount()`
+     * \param [in] statistics The statistics of the superpixels
      * \param [in] superpixels An array of superpixels corresponding to the data
      * in `superpixelLabels`.
      * \param [in] nSuperpixels The number of superpixels in the `superpixels` array
@@ -43,10 +48,13 @@ public:
      * `img.pixelCount()` (ImageData::pixelCount()), where the elements
      * indicate the selected/rejected status of the superpixels corresponding
      * to the image locations.
-     * \see Superpixellation::Superpixellation(ImageData*&,pxind*&,Superpixel**&,const pxind&,const bool=false)
+     * \see Superpixellation::Superpixellation(ImageData*&,pxind*&,pxind*&,pxind*&,SuperpixelStatistics*&,Superpixel**&,const pxind&,const bool=false)
      */
     FilteredSuperpixellation(ImageData *& img,
                              pxind *& superpixelLabels,
+                             pxind *& superpixelPixels,
+                             pxind *& superpixelOffsets,
+                             SuperpixelStatistics *& statistics,
                              Superpixel **& superpixels,
                              const pxind &nSuperpixels,
                              bool *& selectedSuperpixels,
@@ -78,6 +86,29 @@ public:
                              bool *& selectedPixels
                          );
 
+    /*!
+     * \brief Assemble a FilteredSuperpixellation from an existing Superpixellation
+     * and selection arrays which may be owned by another object
+     *
+     * This constructor is used when the selection arrays are stored in the
+     * memory-mapped file of `superpixellation` (see SuperpixellationFile).
+     * Otherwise, it behaves like
+     * FilteredSuperpixellation(ImageData*&,Superpixellation*&,bool*&,bool*&)
+     * \param [in] img The image corresponding to `superpixellation`
+     * \param [in] superpixellation A superpixel representation of `img`
+     * \param [in] selectedSuperpixels The selected/rejected status of each superpixel
+     * \param [in] selectedPixels The selected/rejected status of each pixel
+     * \param [in] shareSelections If true, this object will not delete
+     * `selectedSuperpixels` and `selectedPixels` when deconstructed, and they must
+     * outlive this object.
+     */
+    FilteredSuperpixellation(ImageData *&img,
+                             Superpixellation *& superpixellation,
+                             const bool* const selectedSuperpixels,
+                             const bool* const selectedPixels,
+                             const bool shareSelections
+                         );
+
     virtual ~FilteredSuperpixellation(void);
 
     // Data members
@@ -95,6 +126,13 @@ public:
      * to the pixel location.
      */
     const bool* const selectedPixels;
+
+private:
+    /*!
+     * \brief Indicates whether or not the selection arrays are owned by this object,
+     * for memory management purposes
+     */
+    const bool shareSelections;
 };
 
 #endif // FILTEREDSUPERPIXELLATION_H
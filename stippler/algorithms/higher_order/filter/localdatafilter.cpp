@@ -22,7 +22,9 @@
 #include <algorithm>
 #include <QObject>
 #include <QDoubleValidator>
+#include <QStringList>
 #include "localdatafilter.h"
+#include "resultcache.h"
 
 /*!
  * \brief The maximum number of bins in the histogram constructed for Otsu
@@ -91,14 +93,25 @@
     ((IMAGEDATA_MAX_LIGHTNESS - IMAGEDATA_MIN_LIGHTNESS) / 2.0)
 
 LocalDataFilter::LocalDataFilter(ISuperpixelGenerator*& generator, const ScoreBasis &b) :
+    LocalDataFilter(generator, QVector<ScoreBasis>(1, b))
+{}
+
+LocalDataFilter::LocalDataFilter(ISuperpixelGenerator*& generator, const QVector<ScoreBasis> &b) :
     SuperpixelFilter(generator),
-    basis(b),
+    bases(b),
+    basisIndex(0),
     selectionMap(0),
     lStarSelectionMap(0),
+    allSuperpixelScores(0),
     superpixelScores(0),
     maxScore(0.0),
     minScore(0.0),
+    basisMaxScores(),
+    basisMinScores(),
+    basisThresholds(),
+    basisSelectedSuperpixels(0),
     inverseBinWidth(0.0),
+    allHistograms(0),
     histogram(0),
     nHistogramBins(0),
     otsuThreshold(0.0),
@@ -109,27 +122,17 @@ LocalDataFilter::LocalDataFilter(ISuperpixelGenerator*& generator, const ScoreBa
     collectStatistics(0),
     normalizeStatistics(0)
 {
-    switch(basis) {
-    case ScoreBasis::SIZE:
-        collectStatistics = collectSizeStatistics;
-        normalizeStatistics = normalizeSizeStatistics;
-        selectBelowThreshold = false;
-        break;
-    case ScoreBasis::STDDEV_LSTAR:
-        collectStatistics = collectStddevLStarStatistics;
-        normalizeStatistics = normalizeStddevLStarStatistics;
-        selectBelowThreshold = true;
-        break;
-    case ScoreBasis::EXTERNAL:
-        collectStatistics = collectExternalStatistics;
-        normalizeStatistics = normalizeExternalStatistics;
-        selectBelowThreshold = true;
-        break;
-    default:
+    Q_ASSERT(!bases.isEmpty());
+    if(bases.isEmpty()) {
         failed = true;
-        Q_ASSERT(false);
+        return;
     }
-
+    foreach(const ScoreBasis &basis, bases) {
+        if(!bindBasis(basis)) {
+            failed = true;
+        }
+    }
+    bindBasis(bases.first());
 }
 
 LocalDataFilter::~LocalDataFilter(void) {
@@ -138,18 +141,18 @@ LocalDataFilter::~LocalDataFilter(void) {
 
 void LocalDataFilter::additionalRequiredImages(QVector<QString> &imageDescriptions) {
     SuperpixelFilter::additionalRequiredImages(imageDescriptions);
-    if(basis == ScoreBasis::EXTERNAL) {
+    if(requiresSelectionMap()) {
         imageDescriptions.append(QObject::tr("Open pixel soft selection map"));
     }
 }
 
 bool LocalDataFilter::initialize(QVector<ImageData *> *&images) {
     QVector<ImageData *>::size_type size = images->size();
-    Q_ASSERT((size == 2 && basis == ScoreBasis::EXTERNAL) ||
-             (size == 1 && basis != ScoreBasis::EXTERNAL));
+    Q_ASSERT((size == 2 && requiresSelectionMap()) ||
+             (size == 1 && !requiresSelectionMap()));
     ImageData * firstImage = (*images)[0];
     ImageData * secondImage = 0;
-    if(basis == ScoreBasis::EXTERNAL) {
+    if(requiresSelectionMap()) {
         secondImage = (*images)[1];
         images->remove(1);
         if(firstImage->width() != secondImage->width() ||
@@ -158,21 +161,38 @@ bool LocalDataFilter::initialize(QVector<ImageData *> *&images) {
             qWarning("Input image and selection map dimensions do not agree.");
         }
     }
-    if(!failed) {
+    /* Selections are only reused when this filter's output image is disabled,
+     * as rendering the output requires the superpixel scores, which are not cached.
+     */
+    selectionKey.clear();
+    if(!failed && resultCache != 0 && !outputIsEnabled && existingSuperpixellation == 0) {
+        QString signature = parameterSignature();
+        if(!signature.isEmpty()) {
+            QVector<QByteArray> imageHashes;
+            imageHashes.append(ResultCache::imageHash(*firstImage));
+            if(secondImage != 0) {
+                imageHashes.append(ResultCache::imageHash(*secondImage));
+            }
+            selectionKey = ResultCache::key(imageHashes, signature);
+        }
+    }
+    if(failed) {
+        // SuperpixelFilter::initialize() has not taken ownership of the input image
+        foreach(ImageData *image, *images) {
+            delete image;
+        }
+        delete images;
+        images = 0;
+    } else {
+        // Takes ownership of the input image, even on failure, and sets `images` to null
         failed = !SuperpixelFilter::initialize(images);
     }
     if(!failed) {
         selectionMap = secondImage;
-    } else {
-        delete firstImage;
-        firstImage = 0;
-        if(secondImage != 0) {
-            delete secondImage;
-            secondImage = 0;
-        }
+    } else if(secondImage != 0) {
+        delete secondImage;
+        secondImage = 0;
     }
-    delete images;
-    images = 0;
     return !failed;
 }
 
@@ -180,19 +200,39 @@ bool LocalDataFilter::initialize(ImageData * &image) {
     failed = !SuperpixelFilter::initialize(image);
     if(failed) {
         return false;
+    } else if(bases.isEmpty()) {
+        failed = true;
+        return false;
     }
-    QDoubleValidator validator;
-    maxScore = validator.bottom();
-    minScore = validator.top();
-    inverseBinWidth = 0.0;
+    basisIndex = 0;
+    startBasis();
+    basisMaxScores.fill(0.0, bases.size());
+    basisMinScores.fill(0.0, bases.size());
+    basisThresholds.fill(0.0, bases.size());
     nHistogramBins = 0;
-    otsuThreshold = 0.0;
     outputInRow = false;
     progress = Progress::START;
     k = 0;
     return true;
 }
 
+QString LocalDataFilter::parameterSignature(void) const {
+    QString generatorSignature = superpixelGenerator->parameterSignature();
+    if(generatorSignature.isEmpty()) {
+        return QString();
+    }
+    QStringList basisList;
+    foreach(const ScoreBasis &basis, bases) {
+        basisList.append(QString::number(static_cast<unsigned int>(basis)));
+    }
+    return QString("LocalDataFilter bases=%1 maxBins=%2 minBinsPerSuperpixel=%3 minBins=%4 (%5)")
+            .arg(basisList.join(","))
+            .arg(LOCALDATAFILTER_MAX_HISTOGRAM_BINS)
+            .arg(LOCALDATAFILTER_MIN_HISTOGRAM_BINS_PER_SUPERPIXEL)
+            .arg(LOCALDATAFILTER_MIN_HISTOGRAM_BINS)
+            .arg(generatorSignature);
+}
+
 bool LocalDataFilter::increment(bool & f, QString & status) {
     if(failed) {
         status = QObject::tr("Cannot increment - Processing has failed.");
@@ -204,6 +244,7 @@ bool LocalDataFilter::increment(bool & f, QString & status) {
     }
 
     pxind incEnd = updateKAndProgress();
+    const pxind nIterations = incEnd - k;
 
     switch(progress) {
     case Progress::GENERATE_SUPERPIXELS: {
@@ -212,62 +253,79 @@ bool LocalDataFilter::increment(bool & f, QString & status) {
     }
     case Progress::RGB2LAB: {
         lStarSelectionMap = selectionMap->lStar();
+        countWork(0, selectionMap->pixelCount());
         status = QObject::tr("Converted the selection map image to the CIE L*a*b* colour space.");
         break;
     }
     case Progress::COLLECT_STATISTICS: {
         if(k == 0) {
-            superpixelScores = new qreal[superpixellation->nSuperpixels];
+            if(allSuperpixelScores == 0) {
+                allSuperpixelScores = new qreal[bases.size() * superpixellation->nSuperpixels];
+                basisSelectedSuperpixels = new bool[bases.size() * superpixellation->nSuperpixels];
+                countAllocation(static_cast<qint64>(bases.size()) * superpixellation->nSuperpixels *
+                                (sizeof(qreal) + sizeof(bool)));
+            }
+            superpixelScores = allSuperpixelScores + basisIndex * superpixellation->nSuperpixels;
         }
         collectStatistics(*this, incEnd);
-        status = QObject::tr("Collecting superpixel statistics (%1 / %2)")
-                .arg(k)
-                .arg(superpixellation->nSuperpixels);
+        countWork(nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Collecting superpixel statistics (%1 / %2)"),
+                k, superpixellation->nSuperpixels);
         break;
     }
     case Progress::NORMALIZE_STATISTICS: {
         normalizeStatistics(*this, incEnd);
-        status = QObject::tr("Normalizing superpixel statistics (%1 / %2)")
-                .arg(k)
-                .arg(superpixellation->nSuperpixels);
+        countWork(nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Normalizing superpixel statistics (%1 / %2)"),
+                k, superpixellation->nSuperpixels);
         break;
     }
     case Progress::CONSTRUCT_HISTOGRAM: {
         if(k == 0) {
-            if((
-                    static_cast<qreal>(superpixellation->nSuperpixels) /
-                    LOCALDATAFILTER_MIN_HISTOGRAM_BINS_PER_SUPERPIXEL) <
-                    LOCALDATAFILTER_MAX_HISTOGRAM_BINS) {
-                nHistogramBins = floor(
-                            static_cast<qreal>(superpixellation->nSuperpixels) /
-                            LOCALDATAFILTER_MIN_HISTOGRAM_BINS_PER_SUPERPIXEL
-                        );
-                if(nHistogramBins < LOCALDATAFILTER_MIN_HISTOGRAM_BINS) {
-                    nHistogramBins = LOCALDATAFILTER_MIN_HISTOGRAM_BINS;
+            if(allHistograms == 0) {
+                if((
+                        static_cast<qreal>(superpixellation->nSuperpixels) /
+                        LOCALDATAFILTER_MIN_HISTOGRAM_BINS_PER_SUPERPIXEL) <
+                        LOCALDATAFILTER_MAX_HISTOGRAM_BINS) {
+                    nHistogramBins = floor(
+                                static_cast<qreal>(superpixellation->nSuperpixels) /
+                                LOCALDATAFILTER_MIN_HISTOGRAM_BINS_PER_SUPERPIXEL
+                            );
+                    if(nHistogramBins < LOCALDATAFILTER_MIN_HISTOGRAM_BINS) {
+                        nHistogramBins = LOCALDATAFILTER_MIN_HISTOGRAM_BINS;
+                    }
+                } else {
+                    nHistogramBins = LOCALDATAFILTER_MAX_HISTOGRAM_BINS;
                 }
-            } else {
-                nHistogramBins = LOCALDATAFILTER_MAX_HISTOGRAM_BINS;
+                allHistograms = new pxind[bases.size() * nHistogramBins];
+                countAllocation(static_cast<qint64>(bases.size()) * nHistogramBins * sizeof(pxind));
             }
-            histogram = new pxind[nHistogramBins];
+            histogram = allHistograms + basisIndex * nHistogramBins;
             std::fill(histogram, histogram + nHistogramBins, 0);
             inverseBinWidth = static_cast<qreal>(nHistogramBins - 1) / (maxScore - minScore);
         }
         constructHistogram(incEnd);
-        status = QObject::tr("Constructing histogram (%1 / %2)")
-                .arg(k)
-                .arg(superpixellation->nSuperpixels);
+        countWork(nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Constructing histogram (%1 / %2)"),
+                k, superpixellation->nSuperpixels);
         break;
     }
     case Progress::CHOOSE_OTSU_THRESHOLD: {
+        basisMaxScores[basisIndex] = maxScore;
+        basisMinScores[basisIndex] = minScore;
         chooseOtsuThreshold();
+        basisThresholds[basisIndex] = otsuThreshold;
         status = QObject::tr("Selected Otsu threshold from histogram.");
         break;
     }
     case Progress::FILTER_SUPERPIXELS: {
         filterSuperpixels(incEnd);
-        status = QObject::tr("Filtering superpixels (%1 / %2)")
-                .arg(k)
-                .arg(superpixellation->nSuperpixels);
+        if(k == superpixellation->nSuperpixels && (basisIndex + 1) == bases.size()) {
+            storeSelections();
+        }
+        countWork(nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Filtering superpixels (%1 / %2)"),
+                k, superpixellation->nSuperpixels);
         break;
     }
     case Progress::INITIALIZE_OUTPUT: {
@@ -281,9 +339,9 @@ bool LocalDataFilter::increment(bool & f, QString & status) {
     }
     case Progress::FILL_OUTPUT: {
         fillOutputImage(incEnd);
-        status = QObject::tr("Filling output image (%1 / %2)")
-                .arg(k)
-                .arg(superpixellation->nSuperpixels);
+        countWork(nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Filling output image (%1 / %2)"),
+                k, superpixellation->nSuperpixels);
         break;
     }
     case Progress::FINALIZE_OUTPUT: {
@@ -325,7 +383,9 @@ pxind LocalDataFilter::updateKAndProgress(void) {
         }
         case Progress::GENERATE_SUPERPIXELS: {
             if(SuperpixelFilter::isFinished()) {
-                if(basis == ScoreBasis::EXTERNAL) {
+                if(hasCachedSelections) {
+                    progress = Progress::END;
+                } else if(requiresSelectionMap()) {
                     progress = Progress::RGB2LAB;
                 } else {
                     progress = Progress::COLLECT_STATISTICS;
@@ -354,7 +414,11 @@ pxind LocalDataFilter::updateKAndProgress(void) {
             break;
         }
         case Progress::FILTER_SUPERPIXELS: {
-            if(outputIsEnabled) {
+            if(basisIndex + 1 < bases.size()) {
+                basisIndex += 1;
+                startBasis();
+                progress = Progress::COLLECT_STATISTICS;
+            } else if(outputIsEnabled) {
                 progress = Progress::INITIALIZE_OUTPUT;
             } else {
                 progress = Progress::END;
@@ -384,6 +448,7 @@ pxind LocalDataFilter::updateKAndProgress(void) {
         // Update the end of a loop
         loopLimit = getLoopLimit();
     }
+    enterPhase(progressName(progress));
 
     // Set increment size
     pxind inc = 0;
@@ -399,29 +464,29 @@ pxind LocalDataFilter::updateKAndProgress(void) {
         break;
     }
     case Progress::COLLECT_STATISTICS: {
-        inc = LOCALDATAFILTER_CLUSTER_GRANULARITY;
+        inc = adaptiveIncrement(LOCALDATAFILTER_CLUSTER_GRANULARITY);
         break;
     }
     case Progress::NORMALIZE_STATISTICS: {
-        inc = LOCALDATAFILTER_CLUSTER_GRANULARITY;
+        inc = adaptiveIncrement(LOCALDATAFILTER_CLUSTER_GRANULARITY);
         break;
     }
     case Progress::CONSTRUCT_HISTOGRAM: {
-        inc = LOCALDATAFILTER_CLUSTER_GRANULARITY;
+        inc = adaptiveIncrement(LOCALDATAFILTER_CLUSTER_GRANULARITY);
         break;
     }
     case Progress::CHOOSE_OTSU_THRESHOLD: {
         break;
     }
     case Progress::FILTER_SUPERPIXELS: {
-        inc = LOCALDATAFILTER_CLUSTER_GRANULARITY;
+        inc = adaptiveIncrement(LOCALDATAFILTER_CLUSTER_GRANULARITY);
         break;
     }
     case Progress::INITIALIZE_OUTPUT: {
         break;
     }
     case Progress::FILL_OUTPUT: {
-        inc = LOCALDATAFILTER_CLUSTER_GRANULARITY;
+        inc = adaptiveIncrement(LOCALDATAFILTER_CLUSTER_GRANULARITY);
         break;
     }
     case Progress::FINALIZE_OUTPUT: {
@@ -443,6 +508,26 @@ pxind LocalDataFilter::updateKAndProgress(void) {
     return incEnd;
 }
 
+const char *LocalDataFilter::progressName(const Progress &p) {
+    static const char * const names[] = {
+        "START",
+        "GENERATE_SUPERPIXELS",
+        "RGB2LAB",
+        "COLLECT_STATISTICS",
+        "NORMALIZE_STATISTICS",
+        "CONSTRUCT_HISTOGRAM",
+        "CHOOSE_OTSU_THRESHOLD",
+        "FILTER_SUPERPIXELS",
+        "INITIALIZE_OUTPUT",
+        "FILL_OUTPUT",
+        "FINALIZE_OUTPUT",
+        "END"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<unsigned int>(Progress::END) + 1,
+                  "Each stage of processing must have a name");
+    return names[static_cast<unsigned int>(p)];
+}
+
 pxind LocalDataFilter::getLoopLimit(void) const {
     pxind loopLimit = 0;
 
@@ -495,14 +580,65 @@ pxind LocalDataFilter::getLoopLimit(void) const {
     return loopLimit;
 }
 
+bool LocalDataFilter::bindBasis(const ScoreBasis &basis) {
+    switch(basis) {
+    case ScoreBasis::SIZE:
+        collectStatistics = collectSizeStatistics;
+        normalizeStatistics = normalizeSizeStatistics;
+        selectBelowThreshold = false;
+        break;
+    case ScoreBasis::STDDEV_LSTAR:
+        collectStatistics = collectStddevLStarStatistics;
+        normalizeStatistics = normalizeStddevLStarStatistics;
+        selectBelowThreshold = true;
+        break;
+    case ScoreBasis::EXTERNAL:
+        collectStatistics = collectExternalStatistics;
+        normalizeStatistics = normalizeExternalStatistics;
+        selectBelowThreshold = true;
+        break;
+    default:
+        Q_ASSERT(false);
+        return false;
+    }
+    return true;
+}
+
+void LocalDataFilter::startBasis(void) {
+    bindBasis(bases[basisIndex]);
+    QDoubleValidator validator;
+    maxScore = validator.bottom();
+    minScore = validator.top();
+    inverseBinWidth = 0.0;
+    otsuThreshold = 0.0;
+}
+
+bool LocalDataFilter::requiresSelectionMap(void) const {
+    return bases.contains(ScoreBasis::EXTERNAL);
+}
+
 void LocalDataFilter::constructHistogram(const pxind &endSuperpixel) {
-    pxind bin = 0;
     for(; k < endSuperpixel; k += 1) {
-        bin = static_cast<pxind>(floor((superpixelScores[k] - minScore) * inverseBinWidth));
-        histogram[bin] += 1;
+        histogram[histogramBin(superpixelScores[k], minScore, inverseBinWidth, nHistogramBins)] += 1;
     }
 }
 
+pxind LocalDataFilter::histogramBin(const qreal &score, const qreal &minScore,
+                                    const qreal &inverseBinWidth, const pxind &nBins) {
+    qreal bin = floor((score - minScore) * inverseBinWidth);
+    // Also catches NaN values, which arise when all scores are equal
+    if(!(bin >= 0.0)) {
+        return 0;
+    } else if(bin >= static_cast<qreal>(nBins - 1)) {
+        return nBins - 1;
+    }
+    return static_cast<pxind>(bin);
+}
+
+void LocalDataFilter::chooseOtsuThreshold(void) {
+    otsuThreshold = otsuThresholdOf(basisIndex);
+}
+
 /*!
  * \brief Apply Otsu's method to the histogram data to find a threshold
  *
@@ -512,10 +648,13 @@ void LocalDataFilter::constructHistogram(const pxind &endSuperpixel) {
  *   June 17, 2010 (Accessed Oct. 25, 2016).
  *   - I adjusted the code so that the output actually matches their example!
  */
-void LocalDataFilter::chooseOtsuThreshold(void) {
+qreal LocalDataFilter::otsuThresholdOf(const int &b) const {
+    const pxind* basisHistogram = allHistograms + b * nHistogramBins;
+    qreal basisInverseBinWidth = static_cast<qreal>(nHistogramBins - 1) /
+            (basisMaxScores[b] - basisMinScores[b]);
     pxind sumAll = 0;
     for(pxind bin = 0; bin < nHistogramBins; bin += 1) {
-        sumAll += bin * histogram[bin];
+        sumAll += bin * basisHistogram[bin];
     }
     pxind sumDark = 0;
     pxind weightDark = 0;
@@ -530,7 +669,7 @@ void LocalDataFilter::chooseOtsuThreshold(void) {
     qreal diffMean = 0.0;
 
     for(pxind bin = 1; bin < nHistogramBins; bin += 1) {
-        weightDark += histogram[bin - 1];
+        weightDark += basisHistogram[bin - 1];
         if(weightDark == 0) {
             continue;
         }
@@ -540,7 +679,7 @@ void LocalDataFilter::chooseOtsuThreshold(void) {
             break;
         }
 
-        sumDark += (bin - 1) * histogram[bin - 1];
+        sumDark += (bin - 1) * basisHistogram[bin - 1];
         meanDark = static_cast<qreal>(sumDark) / static_cast<qreal>(weightDark);
         meanLight = static_cast<qreal>(sumAll - sumDark) / static_cast<qreal>(weightLight);
         diffMean = meanLight - meanDark;
@@ -557,21 +696,26 @@ void LocalDataFilter::chooseOtsuThreshold(void) {
             threshold = bin;
         }
     }
-    otsuThreshold = (static_cast<qreal>(threshold) / inverseBinWidth) + minScore;
+    return (static_cast<qreal>(threshold) / basisInverseBinWidth) + basisMinScores[b];
 }
 
 void LocalDataFilter::filterSuperpixels(const pxind &endSuperpixel) {
     bool choice = false;
     const pxind* superpixelPx = 0;
     pxind nSuperpixelPx = 0;
+    bool* basisSelection = basisSelectedSuperpixels + basisIndex * superpixellation->nSuperpixels;
 
     for(; k < endSuperpixel; k += 1) {
         choice = (selectBelowThreshold) ? superpixelScores[k] < otsuThreshold :
                                           superpixelScores[k] >= otsuThreshold;
-        selectedSuperpixels[k] = choice;
-        superpixellation->superpixels[k]->allPixels(superpixelPx, nSuperpixelPx);
-        for(pxind px = 0; px < nSuperpixelPx; px += 1) {
-            selectedPixels[superpixelPx[px]] = choice;
+        basisSelection[k] = choice;
+        // The first measurement dimension determines the filter's output selection
+        if(basisIndex == 0) {
+            selectedSuperpixels[k] = choice;
+            superpixellation->superpixels[k]->allPixels(superpixelPx, nSuperpixelPx);
+            for(pxind px = 0; px < nSuperpixelPx; px += 1) {
+                selectedPixels[superpixelPx[px]] = choice;
+            }
         }
     }
 }
@@ -588,8 +732,10 @@ bool LocalDataFilter::initializeOutput(void) {
     outputInRow = width <= height;
     if(outputInRow) {
         width *= 2;
+        height *= bases.size();
     } else {
         height *= 2;
+        width *= bases.size();
     }
     outputImage = new QImage(QSize(width, height), QImage::Format_ARGB32_Premultiplied);
     outputImage->fill(LOCALDATAFILTER_DEFAULT_OUTPUT_IMAGE_BACKGROUND);
@@ -598,11 +744,19 @@ bool LocalDataFilter::initializeOutput(void) {
 }
 
 void LocalDataFilter::fillOutputImage(const pxind &endSuperpixel) {
+    for(; k < endSuperpixel; k += 1) {
+        for(int b = 0; b < bases.size(); b += 1) {
+            renderSuperpixel(*outputImage, k, b);
+        }
+    }
+}
+
+void LocalDataFilter::renderSuperpixel(QImage &image, const pxind &s, const int &b) const {
     qreal stat = 0.0;
     int statGrey = 0;
     QRgb choiceColor = 0;
 
-    const Superpixellation::Superpixel *superpixel = 0;
+    const Superpixellation::Superpixel *superpixel = superpixellation->superpixels[s];
     pxind x = 0, y = 0;
     const pxind* interiorPx;
     pxind nInteriorPx = 0;
@@ -611,42 +765,52 @@ void LocalDataFilter::fillOutputImage(const pxind &endSuperpixel) {
 
     pxind width = input->width();
     pxind height = input->height();
+    pxind element = b * superpixellation->nSuperpixels + s;
 
-    for(; k < endSuperpixel; k += 1) {
-        if(selectedSuperpixels[k]) {
-            choiceColor = LOCALDATAFILTER_CHOSEN_COLOR;
-        } else {
-            choiceColor = LOCALDATAFILTER_REJECTED_COLOR;
-        }
-        superpixel = superpixellation->superpixels[k];
-        stat = ((superpixelScores[k] - minScore) *
-                static_cast<qreal>(IMAGEDATA_RGB_RANGE)) /
-                (maxScore - minScore);
-        if(stat > IMAGEDATA_MAX_RGB) {
-            statGrey = IMAGEDATA_MAX_RGB;
-        } else {
-            statGrey = static_cast<int>(floor(stat));
-        }
+    // Offsets of the sub-images for the measurement dimension
+    pxind xOffset = 0, yOffset = 0;
+    if(outputInRow) {
+        yOffset = b * height;
+    } else {
+        xOffset = b * width;
+    }
 
-        superpixel->interiorPixels(interiorPx, nInteriorPx);
-        for(pxind i = 0; i < nInteriorPx; i += 1) {
-            input->kToXY(interiorPx[i], x, y);
-            outputImage->setPixel(x, y, qRgb(statGrey, statGrey, statGrey));
-            if(outputInRow) {
-                outputImage->setPixel(x + width, y, choiceColor);
-            } else {
-                outputImage->setPixel(x, y + height, choiceColor);
-            }
+    if(basisSelectedSuperpixels[element]) {
+        choiceColor = LOCALDATAFILTER_CHOSEN_COLOR;
+    } else {
+        choiceColor = LOCALDATAFILTER_REJECTED_COLOR;
+    }
+    stat = ((allSuperpixelScores[element] - basisMinScores[b]) *
+            static_cast<qreal>(IMAGEDATA_RGB_RANGE)) /
+            (basisMaxScores[b] - basisMinScores[b]);
+    if(stat > IMAGEDATA_MAX_RGB) {
+        statGrey = IMAGEDATA_MAX_RGB;
+    } else {
+        statGrey = static_cast<int>(floor(stat));
+    }
+
+    superpixel->interiorPixels(interiorPx, nInteriorPx);
+    for(pxind i = 0; i < nInteriorPx; i += 1) {
+        input->kToXY(interiorPx[i], x, y);
+        x += xOffset;
+        y += yOffset;
+        image.setPixel(x, y, qRgb(statGrey, statGrey, statGrey));
+        if(outputInRow) {
+            image.setPixel(x + width, y, choiceColor);
+        } else {
+            image.setPixel(x, y + height, choiceColor);
         }
-        superpixel->boundaryPixels(boundaryPx, nBoundaryPx);
-        for(pxind i = 0; i < nBoundaryPx; i += 1) {
-            input->kToXY(boundaryPx[i], x, y);
-            outputImage->setPixel(x, y, LOCALDATAFILTER_BORDER_COLOR_STATS);
-            if(outputInRow) {
-                outputImage->setPixel(x + width, y, LOCALDATAFILTER_BORDER_COLOR_CHOICE);
-            } else {
-                outputImage->setPixel(x, y + height, LOCALDATAFILTER_BORDER_COLOR_CHOICE);
-            }
+    }
+    superpixel->boundaryPixels(boundaryPx, nBoundaryPx);
+    for(pxind i = 0; i < nBoundaryPx; i += 1) {
+        input->kToXY(boundaryPx[i], x, y);
+        x += xOffset;
+        y += yOffset;
+        image.setPixel(x, y, LOCALDATAFILTER_BORDER_COLOR_STATS);
+        if(outputInRow) {
+            image.setPixel(x + width, y, LOCALDATAFILTER_BORDER_COLOR_CHOICE);
+        } else {
+            image.setPixel(x, y + height, LOCALDATAFILTER_BORDER_COLOR_CHOICE);
         }
     }
 }
@@ -737,13 +901,19 @@ void LocalDataFilter::cleanup(void) {
         selectionMap = 0;
     }
     lStarSelectionMap = 0; // Owned by `selectionMap`
-    if(superpixelScores != 0) {
-        delete [] superpixelScores;
-        superpixelScores = 0;
+    if(allSuperpixelScores != 0) {
+        delete [] allSuperpixelScores;
+        allSuperpixelScores = 0;
+    }
+    superpixelScores = 0; // Points into `allSuperpixelScores`
+    if(basisSelectedSuperpixels != 0) {
+        delete [] basisSelectedSuperpixels;
+        basisSelectedSuperpixels = 0;
     }
-    if(histogram != 0) {
-        delete [] histogram;
-        histogram = 0;
+    if(allHistograms != 0) {
+        delete [] allHistograms;
+        allHistograms = 0;
     }
+    histogram = 0; // Points into `allHistograms`
     SuperpixelFilter::cleanup();
 }
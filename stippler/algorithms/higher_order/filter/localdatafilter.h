@@ -21,11 +21,17 @@
 **   June 17, 2010 (Accessed Oct. 25, 2016).
 */
 
+#include <QImage>
+#include <QVector>
 #include "superpixelfilter.h"
 
 /*!
  * \brief A filter for superpixels, which selects superpixels based on their
  * own data, ignoring their relationships with neighbouring superpixels.
+ *
+ * The filter can score superpixels along several measurement dimensions
+ * (ScoreBasis) in one run, over one segmentation of the image. Each dimension
+ * is scored and thresholded independently.
  */
 class LocalDataFilter : public SuperpixelFilter
 {
@@ -68,12 +74,26 @@ public:
      */
     LocalDataFilter(ISuperpixelGenerator*& generator, const ScoreBasis &basis);
 
+    /*!
+     * \brief Construct a superpixel filter which scores superpixels
+     * along several measurement dimensions
+     *
+     * The superpixels are generated once, and then scored, thresholded and
+     * visualized along each dimension in turn. The selection produced
+     * for the first element of `bases` is output by
+     * SuperpixelFilter::outputFilteredSuperpixellation().
+     * \param [in] generator The algorithm used to generate the superpixels
+     * \param [in] bases The measurement dimensions used to select/reject superpixels.
+     * Must not be empty.
+     */
+    LocalDataFilter(ISuperpixelGenerator*& generator, const QVector<ScoreBasis> &bases);
+
     virtual ~LocalDataFilter(void);
 
     /*!
      * \brief Describe the additional images required to initialize this algorithm
      *
-     * If the `basis` parameter of LocalDataFilter(ISuperpixelGenerator*&, const ScoreBasis &)
+     * If any of the measurement dimensions used by this object
      * is ScoreBasis::EXTERNAL, then an externally-generated soft selection map
      * is required.
      * \param [out] imageDescriptions A list of descriptions of the additional input
@@ -84,9 +104,14 @@ public:
     virtual void additionalRequiredImages(QVector<QString> &imageDescriptions) Q_DECL_OVERRIDE;
 
     /*!
-     * \brief If the `basis` parameter of LocalDataFilter(ISuperpixelGenerator*&, const ScoreBasis &)
+     * \brief If any of the measurement dimensions used by this object
      * is ScoreBasis::EXTERNAL, then an externally-generated soft selection map
      * is required.
+     *
+     * If output is disabled (Algorithm::disableOutput()) and a ResultCache has
+     * been provided, the selections of a previous run on the same images with
+     * the same parameters are reused, and filtering is skipped. Thresholds
+     * cannot be adjusted afterwards, as the superpixel scores are not cached.
      * \param [in] images The input images. The algorithm takes ownership of this
      * vector, even if this function returns a failure result, and sets
      * the pointer to null.
@@ -104,6 +129,13 @@ public:
      */
     virtual bool increment(bool & finished, QString & status) Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Describe the algorithm and the values of all of its parameters
+     * \return A string identifying the algorithm and its parameters
+     * \see Algorithm::parameterSignature()
+     */
+    virtual QString parameterSignature(void) const Q_DECL_OVERRIDE;
+
     /*!
      * \brief Indicates if processing has completed.
      *
@@ -160,6 +192,26 @@ protected:
 
 protected:
 
+    /*!
+     * \brief Set LocalDataFilter::collectStatistics, LocalDataFilter::normalizeStatistics
+     * and LocalDataFilter::selectBelowThreshold for a measurement dimension
+     * \param [in] basis The measurement dimension
+     * \return Success (true), or failure (false) if `basis` is not recognized
+     */
+    bool bindBasis(const ScoreBasis &basis);
+
+    /*!
+     * \brief Prepare to score superpixels along the measurement dimension
+     * at index LocalDataFilter::basisIndex in LocalDataFilter::bases
+     */
+    void startBasis(void);
+
+    /*!
+     * \brief Indicates whether an externally-generated selection map is required
+     * \return `true` if LocalDataFilter::bases contains ScoreBasis::EXTERNAL
+     */
+    bool requiresSelectionMap(void) const;
+
     /*!
      * \brief Update state control variables and choose the next stage of processing
      *
@@ -186,6 +238,14 @@ protected:
      */
     pxind getLoopLimit(void) const;
 
+    /*!
+     * \brief The name of a stage of processing, under which it is
+     * recorded in the AlgorithmProfile
+     * \param [in] p The stage of processing
+     * \return The name of the enumeration constant
+     */
+    static const char *progressName(const Progress &p);
+
     /*!
      * \brief Assemble superpixel scores into a histogram
      * \param [in] endSuperpixel The superpixel index bounding the current
@@ -211,13 +271,40 @@ protected:
      */
     void chooseOtsuThreshold(void);
 
+    /*!
+     * \brief Run Otsu's method on the histogram of a measurement dimension
+     *
+     * A helper function for chooseOtsuThreshold().
+     * \param [in] basisIndex The index of the measurement dimension in
+     * LocalDataFilter::bases
+     * \return The threshold
+     */
+    qreal otsuThresholdOf(const int &basisIndex) const;
+
+    /*!
+     * \brief Find the histogram bin of a score
+     *
+     * Scores outside the range of the histogram, including those which
+     * are not numbers, are placed in the first or last bin.
+     * \param [in] score The score
+     * \param [in] minScore The score at the lower edge of the first bin
+     * \param [in] inverseBinWidth The reciprocal of the width of a bin
+     * \param [in] nBins The number of bins in the histogram
+     * \return The index of the bin, in the range `[0, nBins - 1]`
+     */
+    static pxind histogramBin(const qreal &score, const qreal &minScore,
+                              const qreal &inverseBinWidth, const pxind &nBins);
+
     /*!
      * \brief Select superpixels based on the values of their scores
      * in relation to the threshold set by chooseOtsuThreshold()
      *
      * Whether superpixels are selected if their scores are above or below
-     * the threshold is determined by the ScoreBasis enumeration constant
-     * used to construct this object.
+     * the threshold is determined by the current ScoreBasis enumeration constant.
+     *
+     * Selections are recorded in LocalDataFilter::basisSelectedSuperpixels. Only the
+     * selections for the first measurement dimension are recorded in
+     * SuperpixelFilter::selectedSuperpixels and SuperpixelFilter::selectedPixels.
      * \param [in] endSuperpixel The superpixel index bounding the current
      * processing increment
      */
@@ -239,24 +326,38 @@ protected:
      * The right side of the image indicates which superpixels have been
      * selected (black) or rejected (white).
      *
-     * The image is twice as large as the original input image, Algorithm::input.
+     * The image is twice as large as the original input image, Algorithm::input,
+     * for each measurement dimension in LocalDataFilter::bases.
      *
      * In fact, the image may be divided in half vertically or horizontally.
      * The division is such that the image is more square, and therefore
-     * depends on the dimensions of Algorithm::input.
+     * depends on the dimensions of Algorithm::input. The halves for successive
+     * measurement dimensions are stacked in the other direction.
      *
      * \param [in] endSuperpixel The superpixel index bounding the current
      * rendering increment
      */
     void fillOutputImage(const pxind &endSuperpixel);
 
+    /*!
+     * \brief Draw the score and selection status of one superpixel along one
+     * measurement dimension
+     *
+     * A helper function for fillOutputImage().
+     * \param [in,out] image The output image, laid out as described for fillOutputImage()
+     * \param [in] superpixel The index of the superpixel
+     * \param [in] basisIndex The index of the measurement dimension in
+     * LocalDataFilter::bases
+     */
+    void renderSuperpixel(QImage &image, const pxind &superpixel, const int &basisIndex) const;
+
 protected:
     /*!
      * \brief Populate LocalDataFilter::superpixelScores with superpixel sizes
      *
      * This is a static function as opposed to an instance function in order
      * for it to be referred to via a function pointer. It is bound as an instance
-     * function, when the value of the `basis` parameter of LocalDataFilter()
+     * function, when the current measurement dimension
      * is LocalDataFilter::ScoreBasis::SIZE.
      * \param [in] alg The instance of the class to update
      * \param [in] endSuperpixel The superpixel index bounding the current
@@ -274,7 +375,7 @@ protected:
      *
      * This is a static function as opposed to an instance function in order
      * for it to be referred to via a function pointer. It is bound as an instance
-     * function, when the value of the `basis` parameter of LocalDataFilter()
+     * function, when the current measurement dimension
      * is LocalDataFilter::ScoreBasis::SIZE.
      * \param [in] alg The instance of the class to update
      * \param [in] endSuperpixel The superpixel index bounding the current
@@ -293,7 +394,7 @@ protected:
      *
      * This is a static function as opposed to an instance function in order
      * for it to be referred to via a function pointer. It is bound as an instance
-     * function, when the value of the `basis` parameter of LocalDataFilter()
+     * function, when the current measurement dimension
      * is LocalDataFilter::ScoreBasis::STDDEV_LSTAR.
      * \param [in] alg The instance of the class to update
      * \param [in] endSuperpixel The superpixel index bounding the current
@@ -311,7 +412,7 @@ protected:
      *
      * This is a static function as opposed to an instance function in order
      * for it to be referred to via a function pointer. It is bound as an instance
-     * function, when the value of the `basis` parameter of LocalDataFilter()
+     * function, when the current measurement dimension
      * is LocalDataFilter::ScoreBasis::STDDEV_LSTAR.
      * \param [in] alg The instance of the class to update
      * \param [in] endSuperpixel The superpixel index bounding the current
@@ -329,7 +430,7 @@ protected:
      *
      * This is a static function as opposed to an instance function in order
      * for it to be referred to via a function pointer. It is bound as an instance
-     * function, when the value of the `basis` parameter of LocalDataFilter()
+     * function, when the current measurement dimension
      * is LocalDataFilter::ScoreBasis::EXTERNAL.
      * \param [in] alg The instance of the class to update
      * \param [in] endSuperpixel The superpixel index bounding the current
@@ -347,7 +448,7 @@ protected:
      *
      * This is a static function as opposed to an instance function in order
      * for it to be referred to via a function pointer. It is bound as an instance
-     * function, when the value of the `basis` parameter of LocalDataFilter()
+     * function, when the current measurement dimension
      * is LocalDataFilter::ScoreBasis::EXTERNAL.
      * \param [in] alg The instance of the class to update
      * \param [in] endSuperpixel The superpixel index bounding the current
@@ -359,16 +460,21 @@ protected:
     // Data members
 protected:
     /*!
-     * \brief The `basis` parameter of LocalDataFilter(), which determines
+     * \brief The measurement dimensions passed to LocalDataFilter(), which determine
      * the metrics used for filtering superpixels
      */
-    const ScoreBasis basis;
+    const QVector<ScoreBasis> bases;
+    /*!
+     * \brief The index in LocalDataFilter::bases of the measurement dimension
+     * currently being processed
+     */
+    int basisIndex;
     /*!
      * \brief An image where the lightness channel values indicate the strength
      * with which pixels are selected.
      *
-     * This input is necessary when `basis` parameter of LocalDataFilter()
-     * is LocalDataFilter::ScoreBasis::EXTERNAL.
+     * This input is necessary when LocalDataFilter::bases
+     * contains LocalDataFilter::ScoreBasis::EXTERNAL.
      */
     ImageData* selectionMap;
     /*!
@@ -378,10 +484,20 @@ protected:
     const qreal* lStarSelectionMap;
 
     /*!
-     * \brief Superpixel scores
+     * \brief Superpixel scores for all measurement dimensions
+     *
+     * An array of `bases.size() * nSuperpixels` elements, where the scores for
+     * the measurement dimension at index `i` in LocalDataFilter::bases start
+     * at element `i * nSuperpixels`.
+     */
+    qreal* allSuperpixelScores;
+    /*!
+     * \brief Superpixel scores for the current measurement dimension
      *
      * Scores are compared with a threshold to determine which superpixels are
      * selected/rejected by the filter.
+     *
+     * This is a pointer into LocalDataFilter::allSuperpixelScores.
      */
     qreal* superpixelScores;
     /*!
@@ -392,13 +508,41 @@ protected:
      * \brief The smallest score in LocalDataFilter::superpixelScores
      */
     qreal minScore;
+    /*!
+     * \brief The value of LocalDataFilter::maxScore for each measurement dimension
+     */
+    QVector<qreal> basisMaxScores;
+    /*!
+     * \brief The value of LocalDataFilter::minScore for each measurement dimension
+     */
+    QVector<qreal> basisMinScores;
+    /*!
+     * \brief The value of LocalDataFilter::otsuThreshold for each measurement dimension
+     */
+    QVector<qreal> basisThresholds;
+    /*!
+     * \brief The selected/rejected status of each superpixel along each measurement dimension
+     *
+     * Laid out in the same way as LocalDataFilter::allSuperpixelScores.
+     */
+    bool* basisSelectedSuperpixels;
     /*!
      * \brief The reciprocal of the bin width of LocalDataFilter::inverseBinWidth
      */
     qreal inverseBinWidth;
+    /*!
+     * \brief Histograms of the superpixel scores for all measurement dimensions
+     *
+     * An array of `bases.size() * nHistogramBins` elements, where the histogram for
+     * the measurement dimension at index `i` in LocalDataFilter::bases starts
+     * at element `i * nHistogramBins`.
+     */
+    pxind* allHistograms;
     /*!
      * \brief A histogram constructed from the superpixel scores in
      * LocalDataFilter::superpixelScores
+     *
+     * This is a pointer into LocalDataFilter::allHistograms.
      */
     pxind* histogram;
     /*!
@@ -416,8 +560,7 @@ protected:
      * \brief Whether to select superpixels with scores below or above
      * LocalDataFilter::otsuThreshold
      *
-     * The value of this member depends on the value of the `basis` parameter of
-     * LocalDataFilter()
+     * The value of this member depends on the current measurement dimension
      */
     bool selectBelowThreshold;
 
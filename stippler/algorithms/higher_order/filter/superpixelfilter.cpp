@@ -14,12 +14,15 @@
 */
 
 #include "superpixelfilter.h"
+#include "resultcache.h"
 
 SuperpixelFilter::SuperpixelFilter(ISuperpixelGenerator*& generator) :
+    existingSuperpixellation(0),
     superpixelGenerator(generator),
     superpixellation(0),
     selectedSuperpixels(0),
     selectedPixels(0),
+    hasCachedSelections(false),
     isSuperpixelGenerationFinished(false),
     canDeleteInput(true)
 {
@@ -39,14 +42,114 @@ void SuperpixelFilter::additionalRequiredImages(QVector<QString> &imageDescripti
     superpixelGenerator->additionalRequiredImages(imageDescriptions);
 }
 
+void SuperpixelFilter::setSuperpixellation(const Superpixellation * const existing) {
+    existingSuperpixellation = existing;
+}
+
+void SuperpixelFilter::setIncrementBudget(const qint64 &milliseconds) {
+    Algorithm::setIncrementBudget(milliseconds);
+    superpixelGenerator->setIncrementBudget(milliseconds);
+}
+
+void SuperpixelFilter::setProgressChannel(AlgorithmProgress *channel) {
+    Algorithm::setProgressChannel(channel);
+    superpixelGenerator->setProgressChannel(channel);
+}
+
+void SuperpixelFilter::setCancellationToken(const CancellationToken *token) {
+    Algorithm::setCancellationToken(token);
+    superpixelGenerator->setCancellationToken(token);
+}
+
 bool SuperpixelFilter::initialize(QVector<ImageData *> *&images) {
     ImageData *temp = (*images)[0];
-    failed = !superpixelGenerator->initialize(images); // Sets `images` to null
+    superpixellationKey.clear();
+    hasCachedSelections = false;
+    if(existingSuperpixellation != 0) {
+        ImageData *existingImage = existingSuperpixellation->img;
+        bool dimensionsAgree = (temp->width() == existingImage->width() &&
+                                temp->height() == existingImage->height());
+        // The existing superpixellation's image replaces the input image
+        for(QVector<ImageData *>::size_type i = 0; i < images->size(); i += 1) {
+            delete (*images)[i];
+        }
+        delete images;
+        images = 0;
+        canDeleteInput = false;
+        if(!dimensionsAgree) {
+            qWarning("Input image and existing superpixellation dimensions do not agree.");
+            failed = true;
+            return false;
+        }
+        // Clears the superpixellation
+        if(!initialize(existingImage)) {
+            input = 0;
+            return false;
+        }
+        superpixellation = new Superpixellation(existingSuperpixellation);
+        return true;
+    }
+
+    QString signature = superpixelGenerator->parameterSignature();
+    if(resultCache == 0 || signature.isEmpty() || images->size() != 1) {
+        failed = !superpixelGenerator->initialize(images); // Sets `images` to null
+        canDeleteInput = false;
+        if(failed) {
+            return false;
+        }
+        return initialize(temp);
+    }
+
+    QVector<QByteArray> imageHashes;
+    imageHashes.append(ResultCache::imageHash(*temp));
+    QString key = ResultCache::key(imageHashes, signature);
+    delete images;
+    images = 0;
     canDeleteInput = false;
-    if(failed) {
+    // Clears the superpixellation and sets `temp` to null
+    if(!initialize(temp)) {
+        /* The image is not shared with the generator, and `canDeleteInput`
+         * is false, so it must be deleted here
+         */
+        delete input;
+        input = 0;
         return false;
     }
-    return initialize(temp);
+
+    /* As for a superpixellation produced by the generator, the cached
+     * superpixellation takes ownership of the input image.
+     */
+    ImageData *img = input;
+    const bool *cachedSelectedSuperpixels = 0;
+    const bool *cachedSelectedPixels = 0;
+    if(!selectionKey.isEmpty() && resultCache->lookupSuperpixellation(selectionKey, img,
+            superpixellation, cachedSelectedSuperpixels, cachedSelectedPixels)) {
+        if(cachedSelectedSuperpixels != 0 && cachedSelectedPixels != 0) {
+            /* The cached selections belong to the memory-mapped file,
+             * whereas the selections of this object are passed on to its output
+             */
+            selectedSuperpixels = new bool[superpixellation->nSuperpixels];
+            std::copy(cachedSelectedSuperpixels,
+                      cachedSelectedSuperpixels + superpixellation->nSuperpixels,
+                      selectedSuperpixels);
+            selectedPixels = new bool[input->pixelCount()];
+            std::copy(cachedSelectedPixels, cachedSelectedPixels + input->pixelCount(), selectedPixels);
+            hasCachedSelections = true;
+        }
+        return true;
+    }
+    cachedSelectedSuperpixels = 0;
+    cachedSelectedPixels = 0;
+    if(resultCache->lookupSuperpixellation(key, img, superpixellation,
+            cachedSelectedSuperpixels, cachedSelectedPixels)) {
+        return true;
+    }
+
+    // Cache miss - The generator takes ownership of the input image
+    superpixellationKey = key;
+    images = new QVector<ImageData *>(1, input);
+    failed = !superpixelGenerator->initialize(images);
+    return !failed;
 }
 
 bool SuperpixelFilter::initialize(ImageData * &image) {
@@ -70,28 +173,40 @@ bool SuperpixelFilter::increment(bool & f, QString & status) {
         return false;
     }
 
-    if(superpixelGenerator->isFinished()) {
+    if(superpixellation == 0 && superpixelGenerator->isFinished()) {
         failed = !superpixelGenerator->outputSuperpixellation(superpixellation);
+        appendNestedProfile(*superpixelGenerator);
         if(failed) {
             status = QObject::tr("Superpixel retrieval failed.");
+        } else if(resultCache != 0 && !superpixellationKey.isEmpty() && !isCancelled()) {
+            resultCache->storeSuperpixellation(superpixellationKey, *superpixellation);
+        }
+    }
+
+    if(failed) {
+        // The status message has already been set
+    } else if(superpixellation != 0) {
+        // Cleanup superpixel generation data
+        /* Actually, I cannot, otherwise it is impossible to re-run
+         * this algorithm on a new input image (via initialize() ).
+         */
+        // delete superpixelGenerator;
+        // superpixelGenerator = 0;
+        // Initialize superpixel filtering data
+        if(hasCachedSelections) {
+            status = QObject::tr("Retrieved superpixel selections from the cache.");
         } else {
-            // Cleanup superpixel generation data
-            /* Actually, I cannot, otherwise it is impossible to re-run
-             * this algorithm on a new input image (via initialize() ).
-             */
-            // delete superpixelGenerator;
-            // superpixelGenerator = 0;
-            // Initialize superpixel filtering data
             selectedSuperpixels = new bool[superpixellation->nSuperpixels];
             std::fill(selectedSuperpixels, selectedSuperpixels + superpixellation->nSuperpixels, false);
             selectedPixels = new bool[input->pixelCount()];
+            countAllocation((static_cast<qint64>(superpixellation->nSuperpixels) + input->pixelCount()) * sizeof(bool));
             std::fill(selectedPixels, selectedPixels + input->pixelCount(), false);
             status = QObject::tr("Initialized superpixel filtering data.");
-            isSuperpixelGenerationFinished = true;
         }
+        isSuperpixelGenerationFinished = true;
     } else {
         bool ignored = false;
-        failed = !superpixelGenerator->increment(ignored, status);
+        failed = !superpixelGenerator->timedIncrement(ignored, status);
     }
 
     f = isSuperpixelGenerationFinished;
@@ -116,6 +231,13 @@ bool SuperpixelFilter::outputFilteredSuperpixellation(FilteredSuperpixellation *
     return true;
 }
 
+void SuperpixelFilter::storeSelections(void) {
+    if(resultCache != 0 && !selectionKey.isEmpty() && !hasCachedSelections && !isCancelled()) {
+        resultCache->storeSuperpixellation(selectionKey, *superpixellation,
+                                           selectedSuperpixels, selectedPixels);
+    }
+}
+
 void SuperpixelFilter::cleanup(void) {
     if(!canDeleteInput) {
         input = 0;
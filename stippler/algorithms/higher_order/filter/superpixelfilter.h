@@ -54,11 +54,70 @@ public:
      */
     virtual void additionalRequiredImages(QVector<QString> &imageDescriptions) Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Filter an existing superpixellation instead of generating superpixels
+     *
+     * When set, initialize(QVector<ImageData *> *&) discards the primary
+     * input image and uses the image of `existing` in its place, and superpixel
+     * generation by SuperpixelFilter::superpixelGenerator is skipped.
+     * This allows several filters to process a single segmentation of an image.
+     *
+     * The setting persists across calls to initialize(), until this function
+     * is called again with a null pointer.
+     *
+     * ## Notes
+     * - The primary input image is only checked against the image of `existing`
+     *   for agreement in dimensions. It is the caller's responsibility to ensure
+     *   that `existing` is a superpixellation of the input image.
+     * - Derived classes may compute data on demand from the image of `existing`
+     *   (e.g. ImageData::lStar()). Filters sharing a superpixellation should
+     *   therefore not be run concurrently.
+     * \param [in] existing The superpixellation to filter, which must outlive
+     * any processing by this object, or null to resume generating superpixels.
+     * This object does not take ownership of `existing`, and does not modify it.
+     */
+    void setSuperpixellation(const Superpixellation * const existing);
+
+    /*!
+     * \brief Set the target duration of one processing increment, for this object
+     * and for SuperpixelFilter::superpixelGenerator
+     * \param [in] milliseconds The target duration
+     * \see Algorithm::setIncrementBudget()
+     */
+    virtual void setIncrementBudget(const qint64 &milliseconds) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Set the progress channel for this object
+     * and for SuperpixelFilter::superpixelGenerator
+     * \param [in] channel The progress channel
+     * \see Algorithm::setProgressChannel()
+     */
+    virtual void setProgressChannel(AlgorithmProgress *channel) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Set the cancellation token for this object
+     * and for SuperpixelFilter::superpixelGenerator
+     * \param [in] token The cancellation token
+     * \see Algorithm::setCancellationToken()
+     */
+    virtual void setCancellationToken(const CancellationToken *token) Q_DECL_OVERRIDE;
+
     /*!
      * \brief Set the algorithm's input data and parameters
      *
      * Internally, calls initialize(ImageData *&) after passing additional
      * images to SuperpixelFilter::superpixelGenerator
+     *
+     * If an existing superpixellation has been provided (see setSuperpixellation()),
+     * it is used, and superpixel generation is skipped. Otherwise, if a ResultCache
+     * has been provided (see setResultCache()), and it contains
+     * a superpixellation of the input image produced by an algorithm with the
+     * same parameters as SuperpixelFilter::superpixelGenerator, the cached
+     * superpixellation is used, and superpixel generation is skipped.
+     * Before looking up the superpixellation, the cache is searched for
+     * the selections of a previous run of this filter, if derived classes have
+     * set SuperpixelFilter::selectionKey. If they are found, SuperpixelFilter::hasCachedSelections
+     * is set, and derived classes can skip filtering.
      * \param [in] images The input images. The algorithm takes ownership of this
      * vector, even if this function returns a failure result, and sets
      * the pointer to null.
@@ -141,8 +200,38 @@ protected:
      */
     virtual void cleanup(void) Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Store the current selections, and the superpixellation, in Algorithm::resultCache
+     *
+     * Derived classes call this function once they have finished filtering.
+     * Nothing is stored if SuperpixelFilter::selectionKey is empty, if the
+     * selections were retrieved from the cache, or if processing was cancelled.
+     */
+    void storeSelections(void);
+
     // Data members
 protected:
+    /*!
+     * \brief The key under which the superpixellation of the input image
+     * is stored in Algorithm::resultCache, or an empty string if the superpixellation
+     * is not to be cached
+     */
+    QString superpixellationKey;
+    /*!
+     * \brief The key under which the selections of this filter are stored
+     * in Algorithm::resultCache, along with the superpixellation, or an empty string
+     * if the selections are not to be cached
+     *
+     * Derived classes set this key before calling initialize(QVector<ImageData *> *&),
+     * as it must reflect all of their inputs and parameters.
+     */
+    QString selectionKey;
+    /*!
+     * \brief A superpixellation which is not owned by this object,
+     * to be filtered in place of the output of SuperpixelFilter::superpixelGenerator
+     * \see setSuperpixellation()
+     */
+    const Superpixellation* existingSuperpixellation;
     /*!
      * \brief The algorithm used to generate a Superpixellation of the input image
      */
@@ -150,6 +239,10 @@ protected:
     /*!
      * \brief The superpixellation of the input image produced by
      * SuperpixelFilter::superpixelGenerator
+     *
+     * If SuperpixelFilter::existingSuperpixellation is not null, this is
+     * a view of SuperpixelFilter::existingSuperpixellation
+     * (see Superpixellation::Superpixellation(const Superpixellation * const)).
      */
     Superpixellation* superpixellation;
     /*!
@@ -164,6 +257,11 @@ protected:
      * to the pixel location.
      */
     bool* selectedPixels;
+    /*!
+     * \brief Indicates whether SuperpixelFilter::selectedSuperpixels and
+     * SuperpixelFilter::selectedPixels were retrieved from Algorithm::resultCache
+     */
+    bool hasCachedSelections;
 
 private:
     /*!
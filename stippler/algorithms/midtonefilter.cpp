@@ -15,6 +15,9 @@
 
 #include "midtonefilter.h"
 #include <cmath>
+#include <algorithm>
+#include <QPair>
+#include "taskscheduler.h"
 
 /*!
  * \brief The default CIE L*a*b* lightness threshold marking the lower
@@ -49,7 +52,27 @@
 /*!
  * \brief The number of pixels to loop over per increment of processing
  */
-#define MIDTONEFILTER_PIXEL_GRANULARITY 10000
+#define MIDTONEFILTER_PIXEL_GRANULARITY 262144
+
+/*!
+ * \brief The minimum number of pixels to process in each task
+ * run by the TaskScheduler
+ *
+ * The input and output lightness values of this many pixels should fit
+ * in a per-core cache.
+ */
+#define MIDTONEFILTER_MIN_PIXELS_PER_TASK 16384
+
+/*!
+ * \brief The number of intervals in the table of thresholded lightness values
+ *
+ * The error of linear interpolation between table entries is bounded by
+ * `h^2 / 8` times the largest second derivative of the thresholding function,
+ * where `h` is the interval width. With the default bandwidths, this is below
+ * 1e-4 lightness units.
+ * \see MidtoneFilter::thresholdTable
+ */
+#define MIDTONEFILTER_TABLE_SIZE 4096
 
 MidtoneFilter::MidtoneFilter(void) :
     lStarInput(0),
@@ -59,6 +82,8 @@ MidtoneFilter::MidtoneFilter(void) :
     highBandwidth(MIDTONEFILTER_DEFAULT_HIGH_BANDWIDTH),
     lowFactor(0.0),
     highFactor(0.0),
+    thresholdTable(0),
+    thresholdTableScale(0.0),
     lStarThresholded(0),
     minLStar(IMAGEDATA_MAX_LIGHTNESS),
     maxLStar(IMAGEDATA_MIN_LIGHTNESS),
@@ -68,10 +93,48 @@ MidtoneFilter::MidtoneFilter(void) :
 {
     lowFactor = -log((1.0 - 0.95) / 0.95) / lowBandwidth;
     highFactor = -log((1.0 - 0.95) / 0.95) / highBandwidth;
+
+    thresholdTable = new qreal[MIDTONEFILTER_TABLE_SIZE + 1];
+    thresholdTableScale = MIDTONEFILTER_TABLE_SIZE / IMAGEDATA_RANGE_LIGHTNESS;
+    qreal x = 0.0;
+    for(pxind i = 0; i <= MIDTONEFILTER_TABLE_SIZE; i += 1) {
+        x = IMAGEDATA_MIN_LIGHTNESS + static_cast<qreal>(i) / thresholdTableScale;
+        thresholdTable[i] = 0.5 * (
+                    sigmoid(
+                        IMAGEDATA_MIN_LIGHTNESS,
+                        IMAGEDATA_MAX_LIGHTNESS,
+                        lowFactor,
+                        lowThreshold,
+                        true,
+                        x
+                    ) +
+                    sigmoid(
+                        IMAGEDATA_MIN_LIGHTNESS,
+                        IMAGEDATA_MAX_LIGHTNESS,
+                        highFactor,
+                        highThreshold,
+                        false,
+                        x
+                    )
+                );
+    }
 }
 
 MidtoneFilter::~MidtoneFilter(void) {
     cleanup();
+    if(thresholdTable != 0) {
+        delete [] thresholdTable;
+        thresholdTable = 0;
+    }
+}
+
+QString MidtoneFilter::parameterSignature(void) const {
+    return QString("MidtoneFilter lowThreshold=%1 highThreshold=%2 lowBandwidth=%3 highBandwidth=%4 tableSize=%5")
+            .arg(lowThreshold, 0, 'g', 17)
+            .arg(highThreshold, 0, 'g', 17)
+            .arg(lowBandwidth, 0, 'g', 17)
+            .arg(highBandwidth, 0, 'g', 17)
+            .arg(MIDTONEFILTER_TABLE_SIZE);
 }
 
 bool MidtoneFilter::increment(bool & f, QString & status) {
@@ -85,28 +148,31 @@ bool MidtoneFilter::increment(bool & f, QString & status) {
     }
 
     pxind incEnd = updateKAndProgress();
+    const pxind nIterations = incEnd - k;
 
     switch(progress) {
     case Progress::RGB2LAB: {
         lStarInput = input->lStar();
+        countWork(0, input->pixelCount());
         status = QObject::tr("Converted the input image to the CIE L*a*b* colour space.");
         break;
     }
     case Progress::THRESHOLD: {
         if(k == 0) {
             lStarThresholded = new qreal[input->pixelCount()];
+            countAllocation(static_cast<qint64>(input->pixelCount()) * sizeof(qreal));
         }
         thresholdImage(incEnd);
-        status = QObject::tr("Thresholding pixels (%1 / %2)")
-                .arg(k)
-                .arg(input->pixelCount());
+        countWork(nIterations, nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Thresholding pixels (%1 / %2)"),
+                k, input->pixelCount());
         break;
     }
     case Progress::RESCALE: {
         rescaleImage(incEnd);
-        status = QObject::tr("Rescaling pixels (%1 / %2)")
-                .arg(k)
-                .arg(input->pixelCount());
+        countWork(nIterations, nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Rescaling pixels (%1 / %2)"),
+                k, input->pixelCount());
         break;
     }
     case Progress::CREATE_LAB_IMAGE: {
@@ -116,12 +182,15 @@ bool MidtoneFilter::increment(bool & f, QString & status) {
     }
     case Progress::LAB2RGB: {
         thresholdedImage->red();
+        countWork(0, input->pixelCount());
         status = QObject::tr("Converted the output image data to the RGB colour space.");
         break;
     }
     case Progress::FILL_OUTPUT: {
         outputImage = new QImage;
         thresholdedImage->toImage(*outputImage);
+        countWork(0, input->pixelCount());
+        countAllocation(outputImage->byteCount());
         status = QObject::tr("Converted the output image data to a displayable image.");
         break;
     }
@@ -223,11 +292,12 @@ pxind MidtoneFilter::updateKAndProgress(void) {
         // Update the end of a loop
         loopLimit = getLoopLimit();
     }
+    enterPhase(progressName(progress));
 
     // Set increment size
     pxind inc = 0;
     if(progress == Progress::THRESHOLD || progress == Progress::RESCALE) {
-        inc = MIDTONEFILTER_PIXEL_GRANULARITY;
+        inc = adaptiveIncrement(MIDTONEFILTER_PIXEL_GRANULARITY);
     }
 
     pxind incEnd = k + inc;
@@ -238,6 +308,22 @@ pxind MidtoneFilter::updateKAndProgress(void) {
     return incEnd;
 }
 
+const char *MidtoneFilter::progressName(const Progress &p) {
+    static const char * const names[] = {
+        "START",
+        "RGB2LAB",
+        "THRESHOLD",
+        "RESCALE",
+        "CREATE_LAB_IMAGE",
+        "LAB2RGB",
+        "FILL_OUTPUT",
+        "END"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<unsigned int>(Progress::END) + 1,
+                  "Each stage of processing must have a name");
+    return names[static_cast<unsigned int>(p)];
+}
+
 pxind MidtoneFilter::getLoopLimit(void) const {
     if(progress == Progress::THRESHOLD || progress == Progress::RESCALE) {
         return input->pixelCount();
@@ -247,43 +333,81 @@ pxind MidtoneFilter::getLoopLimit(void) const {
 }
 
 void MidtoneFilter::thresholdImage(const pxind &endPixel) {
-    qreal lowValue = 0.0;
-    qreal highValue = 0.0;
+    // The lowest and highest thresholded lightness values
+    typedef QPair<qreal, qreal> Extremes;
+    Extremes extremes = TaskScheduler::instance().parallelReduce(
+                k,
+                endPixel,
+                MIDTONEFILTER_MIN_PIXELS_PER_TASK,
+                Extremes(IMAGEDATA_MAX_LIGHTNESS, IMAGEDATA_MIN_LIGHTNESS),
+                [this](pxind startPixel, pxind rangeEnd, Extremes &partial) {
+                    thresholdRange(startPixel, rangeEnd, &(partial.first), &(partial.second));
+                },
+                [](Extremes &result, const Extremes &partial) {
+                    result.first = std::min(result.first, partial.first);
+                    result.second = std::max(result.second, partial.second);
+                }
+            );
+    if(extremes.second > maxLStar) {
+        maxLStar = extremes.second;
+    }
+    if(extremes.first < minLStar) {
+        minLStar = extremes.first;
+    }
+    k = endPixel;
+}
+
+void MidtoneFilter::thresholdRange(const pxind startPixel, const pxind endPixel, qreal *min, qreal *max) {
+    qreal minValue = IMAGEDATA_MAX_LIGHTNESS;
+    qreal maxValue = IMAGEDATA_MIN_LIGHTNESS;
+    qreal position = 0.0;
+    pxind index = 0;
+    qreal fraction = 0.0;
     qreal currentValue = 0.0;
-    for(; k < endPixel; k += 1) {
-        lowValue = sigmoid(
-                    IMAGEDATA_MIN_LIGHTNESS,
-                    IMAGEDATA_MAX_LIGHTNESS,
-                    lowFactor,
-                    lowThreshold,
-                    true,
-                    lStarInput[k]
-                );
-        highValue = sigmoid(
-                    IMAGEDATA_MIN_LIGHTNESS,
-                    IMAGEDATA_MAX_LIGHTNESS,
-                    highFactor,
-                    highThreshold,
-                    false,
-                    lStarInput[k]
-                );
-        currentValue = 0.5 * (lowValue + highValue);
-        if(currentValue > maxLStar) {
-            maxLStar = currentValue;
+    for(pxind i = startPixel; i < endPixel; i += 1) {
+        position = (lStarInput[i] - IMAGEDATA_MIN_LIGHTNESS) * thresholdTableScale;
+        // Lightness values may fall slightly outside the nominal range
+        if(position <= 0.0) {
+            currentValue = thresholdTable[0];
+        } else if(position >= MIDTONEFILTER_TABLE_SIZE) {
+            currentValue = thresholdTable[MIDTONEFILTER_TABLE_SIZE];
+        } else {
+            index = static_cast<pxind>(position);
+            fraction = position - static_cast<qreal>(index);
+            currentValue = thresholdTable[index] +
+                    fraction * (thresholdTable[index + 1] - thresholdTable[index]);
+        }
+        if(currentValue > maxValue) {
+            maxValue = currentValue;
         }
-        if(currentValue < minLStar) {
-            minLStar = currentValue;
+        if(currentValue < minValue) {
+            minValue = currentValue;
         }
-        lStarThresholded[k] = currentValue;
+        lStarThresholded[i] = currentValue;
     }
+    *min = minValue;
+    *max = maxValue;
 }
 
 void MidtoneFilter::rescaleImage(const pxind &endPixel) {
-    qreal rangeInv = 1.0 / (maxLStar - minLStar);
-    for(; k < endPixel; k += 1) {
-        lStarThresholded[k] =
-                rangeInv * (lStarThresholded[k] -minLStar) * IMAGEDATA_RANGE_LIGHTNESS
-                + IMAGEDATA_MIN_LIGHTNESS;
+    TaskScheduler::instance().parallelFor(
+                k,
+                endPixel,
+                MIDTONEFILTER_MIN_PIXELS_PER_TASK,
+                [this](pxind startPixel, pxind rangeEnd) {
+                    rescaleRange(startPixel, rangeEnd);
+                }
+            );
+    k = endPixel;
+}
+
+void MidtoneFilter::rescaleRange(const pxind startPixel, const pxind endPixel) {
+    // The transformation is reduced to a multiply-add, which the compiler can vectorize
+    const qreal scale = IMAGEDATA_RANGE_LIGHTNESS / (maxLStar - minLStar);
+    const qreal offset = IMAGEDATA_MIN_LIGHTNESS - minLStar * scale;
+    qreal * const values = lStarThresholded;
+    for(pxind i = startPixel; i < endPixel; i += 1) {
+        values[i] = values[i] * scale + offset;
     }
 }
 
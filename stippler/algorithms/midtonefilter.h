@@ -31,6 +31,11 @@
  *
  * Following thresholding, the image lightnesses are linearly rescaled to
  * the full range.
+ *
+ * The sum of the two sigmoidal functions is tabulated when the filter
+ * is constructed, so that thresholding a pixel requires one table lookup
+ * rather than two evaluations of `exp()`. Thresholding and rescaling
+ * are divided among threads.
  */
 class MidtoneFilter : public Algorithm
 {
@@ -52,6 +57,13 @@ public:
      */
     virtual bool increment(bool & finished, QString & status) Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Describe the algorithm and the values of all of its parameters
+     * \return A string identifying the algorithm and its parameters
+     * \see Algorithm::parameterSignature()
+     */
+    virtual QString parameterSignature(void) const Q_DECL_OVERRIDE;
+
 protected:
     /*!
      * \brief Set the algorithm's input data and parameters
@@ -105,19 +117,45 @@ protected:
     /*!
      * \brief Apply soft thresholding to the image
      *
+     * The pixels in the current processing increment are divided into ranges
+     * by TaskScheduler::parallelReduce(), each of which is processed by thresholdRange().
      * \param [in] endPixel The pixel index bounding the current
      * processing increment
      */
     void thresholdImage(const pxind &endPixel);
 
+    /*!
+     * \brief Apply soft thresholding to a range of pixels
+     *
+     * A helper function for thresholdImage(), which can be run concurrently
+     * on disjoint ranges of pixels.
+     * \param [in] startPixel The first pixel in the range
+     * \param [in] endPixel The pixel index bounding the range
+     * \param [out] min The lowest thresholded lightness value in the range
+     * \param [out] max The highest thresholded lightness value in the range
+     */
+    void thresholdRange(const pxind startPixel, const pxind endPixel, qreal *min, qreal *max);
+
     /*!
      * \brief Linearly rescale image lightness values to the full range
      *
+     * The pixels in the current processing increment are divided into ranges
+     * by TaskScheduler::parallelFor(), each of which is processed by rescaleRange().
      * \param [in] endPixel The pixel index bounding the current
      * processing increment
      */
     void rescaleImage(const pxind &endPixel);
 
+    /*!
+     * \brief Linearly rescale the lightness values of a range of pixels
+     *
+     * A helper function for rescaleImage(), which can be run concurrently
+     * on disjoint ranges of pixels.
+     * \param [in] startPixel The first pixel in the range
+     * \param [in] endPixel The pixel index bounding the range
+     */
+    void rescaleRange(const pxind startPixel, const pxind endPixel);
+
     /*!
      * \brief Sigmoidal function used for thresholding
      * \param [in] min The lower horizontal asymptote of the function
@@ -156,6 +194,14 @@ protected:
         END
     };
 
+    /*!
+     * \brief The name of a stage of processing, under which it is
+     * recorded in the AlgorithmProfile
+     * \param [in] p The stage of processing
+     * \return The name of the enumeration constant
+     */
+    static const char *progressName(const Progress &p);
+
     // Data members
 protected:
     /*!
@@ -200,6 +246,18 @@ protected:
      * \brief Sigmoidal function x-value scaling derived from MidtoneFilter::highBandwidth
      */
     qreal highFactor;
+    /*!
+     * \brief The thresholded lightness values at #MIDTONEFILTER_TABLE_SIZE + 1 evenly-spaced
+     * lightness values spanning the range of lightness values
+     *
+     * Thresholded values are linearly interpolated between table entries.
+     */
+    qreal* thresholdTable;
+    /*!
+     * \brief The number of intervals between entries of MidtoneFilter::thresholdTable
+     * per unit of lightness
+     */
+    qreal thresholdTableScale;
 
     // Other data members
     /*!
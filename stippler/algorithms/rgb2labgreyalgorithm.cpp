@@ -40,30 +40,42 @@ Rgb2LabGreyAlgorithm::~Rgb2LabGreyAlgorithm(void) {
     cleanup();
 }
 
+QString Rgb2LabGreyAlgorithm::parameterSignature(void) const {
+    return QString("Rgb2LabGreyAlgorithm");
+}
+
 bool Rgb2LabGreyAlgorithm::increment(bool & f, QString & status) {
 
     switch(progress) {
     case 0: {
+        enterPhase("RGB2LAB");
         l = input->lStar();
+        countWork(0, input->pixelCount());
         status = "Converted image to CIE L*a*b* colour space.";
         break;
     }
     case 1: {
+        enterPhase("COPY_LIGHTNESS");
         pxind n = input->pixelCount();
         lCopy = new qreal[n];
+        countAllocation(static_cast<qint64>(n) * sizeof(qreal));
         for(pxind i = 0; i < n; i += 1) {
             lCopy[i] = l[i];
         }
+        countWork(n, n);
         status = "Copied the L* colour channel.";
         break;
     }
     case 2: {
+        enterPhase("CREATE_LAB_IMAGE");
         outputData = new ImageData(lCopy, input->width(), input->height());
         status = "Produced image data containing only the L* channel.";
         break;
     }
     case 3: {
+        enterPhase("LAB2RGB");
         outputData->red();
+        countWork(0, input->pixelCount());
         status = "Converted the greyscale image data to the RGB colour space.";
         finished = true;
         break;
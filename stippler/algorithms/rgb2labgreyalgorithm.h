@@ -46,6 +46,13 @@ public:
      */
     virtual bool increment(bool & finished, QString & status) Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Describe the algorithm and the values of all of its parameters
+     * \return A string identifying the algorithm and its parameters
+     * \see Algorithm::parameterSignature()
+     */
+    virtual QString parameterSignature(void) const Q_DECL_OVERRIDE;
+
     /*!
      * \brief Collect the results of processing
      * \param [out] image Raster image output, which must be deallocated by the caller
@@ -0,0 +1,232 @@
+/*!
+** \file regionadjacencygraph.cpp
+** \brief Implementation of the RegionAdjacencyGraph class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <math.h>
+#include <algorithm>
+#include "regionadjacencygraph.h"
+#include "taskscheduler.h"
+
+RegionAdjacencyGraph::RegionAdjacencyGraph(const ImageData &img,
+        const pxind * const labels,
+        const SuperpixelStatistics &statistics
+    ) :
+    nLabels(statistics.size()),
+    nEdges(0),
+    offsets(0),
+    adjacency(0),
+    lengths(0),
+    differences(0)
+{
+    pxind height = img.height();
+    int nThreads = std::min(
+                TaskScheduler::instance().threadCount(),
+                static_cast<int>(height / REGIONADJACENCYGRAPH_MIN_ROWS_PER_THREAD)
+            );
+    if(nThreads < 1) {
+        nThreads = 1;
+    }
+
+    // Find edges within strips of rows
+    QVector<Edge> *threadEdges = new QVector<Edge>[nThreads];
+    TaskScheduler::instance().parallelFor(
+                0,
+                nThreads,
+                1,
+                [&](pxind startStrip, pxind endStrip) {
+                    for(pxind i = startStrip; i < endStrip; i += 1) {
+                        findEdges(
+                                threadEdges + i,
+                                &img,
+                                labels,
+                                (height * i) / nThreads,
+                                (height * (i + 1)) / nThreads
+                            );
+                    }
+                }
+            );
+
+    // Combine edges found by different threads
+    QVector<Edge> &edges = threadEdges[0];
+    for(int i = 1; i < nThreads; i += 1) {
+        edges += threadEdges[i];
+        threadEdges[i].clear();
+    }
+    if(nThreads > 1) {
+        combineEdges(edges);
+    }
+    nEdges = edges.size();
+
+    // Count the neighbours of each superpixel
+    offsets = new pxind[nLabels + 1];
+    std::fill(offsets, offsets + nLabels + 1, 0);
+    for(pxind i = 0; i < nEdges; i += 1) {
+        offsets[edges[i].first] += 1;
+        offsets[edges[i].second] += 1;
+    }
+    pxind count = 0;
+    pxind start = 0;
+    for(pxind i = 0; i <= nLabels; i += 1) {
+        count = offsets[i];
+        offsets[i] = start;
+        start += count;
+    }
+
+    /* Fill the neighbour lists. Edges are sorted, so the neighbours
+     * of each superpixel are inserted in ascending order.
+     */
+    adjacency = new pxind[2 * nEdges];
+    lengths = new pxind[2 * nEdges];
+    differences = new qreal[2 * nEdges];
+    pxind *insertion = new pxind[nLabels];
+    std::copy(offsets, offsets + nLabels, insertion);
+    pxind ends[2] = {0};
+    pxind position = 0;
+    qreal difference = 0.0;
+    qreal channelDifference = 0.0;
+    for(int pass = 0; pass < 2; pass += 1) {
+        /* The first pass inserts smaller IDs into the lists of larger IDs,
+         * and the second pass does the reverse, preserving ascending order.
+         */
+        for(pxind i = 0; i < nEdges; i += 1) {
+            const Edge &edge = edges[i];
+            if(pass == 0) {
+                ends[0] = edge.second;
+                ends[1] = edge.first;
+            } else {
+                ends[0] = edge.first;
+                ends[1] = edge.second;
+            }
+            const SuperpixelStatistics::Statistics &s1 = statistics[edge.first];
+            const SuperpixelStatistics::Statistics &s2 = statistics[edge.second];
+            difference = 0.0;
+            for(int j = 0; j < 3; j += 1) {
+                channelDifference = s1.meanLab[j] - s2.meanLab[j];
+                difference += channelDifference * channelDifference;
+            }
+            position = insertion[ends[0]];
+            adjacency[position] = ends[1];
+            lengths[position] = edge.length;
+            differences[position] = sqrt(difference);
+            insertion[ends[0]] += 1;
+        }
+    }
+    delete [] insertion;
+    delete [] threadEdges;
+}
+
+RegionAdjacencyGraph::~RegionAdjacencyGraph(void) {
+    if(offsets != 0) {
+        delete [] offsets;
+        offsets = 0;
+    }
+    if(adjacency != 0) {
+        delete [] adjacency;
+        adjacency = 0;
+    }
+    if(lengths != 0) {
+        delete [] lengths;
+        lengths = 0;
+    }
+    if(differences != 0) {
+        delete [] differences;
+        differences = 0;
+    }
+}
+
+pxind RegionAdjacencyGraph::size(void) const {
+    return nLabels;
+}
+
+pxind RegionAdjacencyGraph::edgeCount(void) const {
+    return nEdges;
+}
+
+void RegionAdjacencyGraph::neighbours(const pxind &label, const pxind*& n, pxind& degree) const {
+    Q_ASSERT(label >= 0 && label < nLabels);
+    n = adjacency + offsets[label];
+    degree = offsets[label + 1] - offsets[label];
+}
+
+void RegionAdjacencyGraph::boundaryLengths(const pxind &label, const pxind*& l, pxind& degree) const {
+    Q_ASSERT(label >= 0 && label < nLabels);
+    l = lengths + offsets[label];
+    degree = offsets[label + 1] - offsets[label];
+}
+
+void RegionAdjacencyGraph::colorDifferences(const pxind &label, const qreal*& d, pxind& degree) const {
+    Q_ASSERT(label >= 0 && label < nLabels);
+    d = differences + offsets[label];
+    degree = offsets[label + 1] - offsets[label];
+}
+
+void RegionAdjacencyGraph::findEdges(QVector<Edge> *edges,
+        const ImageData *img,
+        const pxind *labels,
+        const pxind startY,
+        const pxind endY
+    ) {
+    pxind width = img->width();
+    pxind height = img->height();
+    pxind k = startY * width;
+    pxind label = 0;
+    pxind neighbourLabel = 0;
+    Edge edge;
+    edge.length = 1;
+    for(pxind y = startY; y < endY; y += 1) {
+        if(TaskScheduler::cancellationRequested()) {
+            return;
+        }
+        for(pxind x = 0; x < width; x += 1) {
+            label = labels[k];
+            // Right
+            if(x < (width - 1)) {
+                neighbourLabel = labels[k + 1];
+                if(neighbourLabel != label) {
+                    edge.first = std::min(label, neighbourLabel);
+                    edge.second = std::max(label, neighbourLabel);
+                    edges->append(edge);
+                }
+            }
+            // Bottom
+            if(y < (height - 1)) {
+                neighbourLabel = labels[k + width];
+                if(neighbourLabel != label) {
+                    edge.first = std::min(label, neighbourLabel);
+                    edge.second = std::max(label, neighbourLabel);
+                    edges->append(edge);
+                }
+            }
+            k += 1;
+        }
+    }
+    combineEdges(*edges);
+}
+
+void RegionAdjacencyGraph::combineEdges(QVector<Edge> &edges) {
+    if(edges.isEmpty()) {
+        return;
+    }
+    std::sort(edges.begin(), edges.end());
+    int last = 0;
+    for(int i = 1; i < edges.size(); i += 1) {
+        if(edges[i].first == edges[last].first && edges[i].second == edges[last].second) {
+            edges[last].length += edges[i].length;
+        } else {
+            last += 1;
+            edges[last] = edges[i];
+        }
+    }
+    edges.resize(last + 1);
+}
@@ -0,0 +1,200 @@
+#ifndef REGIONADJACENCYGRAPH_H
+#define REGIONADJACENCYGRAPH_H
+
+/*!
+** \file regionadjacencygraph.h
+** \brief Definition of the RegionAdjacencyGraph class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QVector>
+#include "imagedata.h"
+#include "superpixelstatistics.h"
+
+/*!
+  \brief The minimum number of image rows processed by a single thread
+  when building a region adjacency graph
+ */
+#define REGIONADJACENCYGRAPH_MIN_ROWS_PER_THREAD 64
+
+/*!
+ * \brief The adjacency relationships between the superpixels of an image
+ *
+ * Two superpixels are adjacent if any of their pixels are 4-neighbours.
+ * The neighbours of each superpixel are stored in compressed sparse row form,
+ * in ascending order of superpixel ID, so that they can be retrieved
+ * in time proportional to the number of neighbours.
+ *
+ * The graph is built in a single raster-order pass over the superpixel label map,
+ * distributed across threads by horizontal strips of rows.
+ */
+class RegionAdjacencyGraph
+{
+public:
+    /*!
+     * \brief Build a region adjacency graph
+     * \param [in] img The image which was segmented into superpixels
+     * \param [in] labels An array with the same number of elements as
+     * `img.pixelCount()` (ImageData::pixelCount()), where the element at index
+     * `k` stores the superpixel ID of the pixel at 1D coordinate `k`.
+     * \param [in] statistics The statistics of the superpixels in `labels`,
+     * used to compute the colour differences between neighbouring superpixels
+     */
+    RegionAdjacencyGraph(const ImageData &img,
+            const pxind* const labels,
+            const SuperpixelStatistics &statistics
+        );
+
+    ~RegionAdjacencyGraph(void);
+
+    /*!
+     * \brief The number of superpixels (vertices) in the graph
+     * \return The number of superpixels
+     */
+    pxind size(void) const;
+
+    /*!
+     * \brief The number of pairs of adjacent superpixels (edges) in the graph
+     * \return The number of pairs of adjacent superpixels
+     */
+    pxind edgeCount(void) const;
+
+    /*!
+     * \brief Access the neighbours of a superpixel
+     * \param [in] label The superpixel ID
+     * \param [out] n The IDs of the neighbouring superpixels, in ascending order
+     * \param [out] degree The number of elements in `n`
+     */
+    void neighbours(const pxind &label, const pxind*& n, pxind& degree) const;
+
+    /*!
+     * \brief Access the lengths of the boundaries shared with the neighbours
+     * of a superpixel
+     *
+     * The length of a boundary is the number of pairs of 4-neighbouring pixels
+     * which straddle it.
+     * \param [in] label The superpixel ID
+     * \param [out] lengths The boundary lengths, in the same order as the output
+     * of neighbours()
+     * \param [out] degree The number of elements in `lengths`
+     */
+    void boundaryLengths(const pxind &label, const pxind*& lengths, pxind& degree) const;
+
+    /*!
+     * \brief Access the differences between the mean colour of a superpixel
+     * and the mean colours of its neighbours
+     *
+     * Differences are Euclidean distances in the CIE L*a*b* colour space.
+     * \param [in] label The superpixel ID
+     * \param [out] differences The colour differences, in the same order as the
+     * output of neighbours()
+     * \param [out] degree The number of elements in `differences`
+     */
+    void colorDifferences(const pxind &label, const qreal*& differences, pxind& degree) const;
+
+private:
+    /*!
+     * \brief A pair of adjacent superpixels
+     */
+    struct Edge {
+        /*!
+         * \brief The smaller of the two superpixel IDs
+         */
+        pxind first;
+        /*!
+         * \brief The larger of the two superpixel IDs
+         */
+        pxind second;
+        /*!
+         * \brief The length of the shared boundary
+         */
+        pxind length;
+
+        /*!
+         * \brief Order edges by superpixel IDs
+         * \param [in] rhs The other edge
+         * \return A comparison result to be used for sorting Edge objects
+         */
+        bool operator<(const Edge &rhs) const {
+            return (first < rhs.first) || (first == rhs.first && second < rhs.second);
+        }
+    };
+
+    /*!
+     * \brief Find the pairs of adjacent superpixels in a range of image rows
+     *
+     * Each pair of 4-neighbouring pixels is visited from its left or upper pixel.
+     * This function is run concurrently on disjoint ranges of rows.
+     * \param [out] edges The pairs of adjacent superpixels found, in ascending order,
+     * without duplicates. This vector must not be accessed by other threads.
+     * \param [in] img The image which was segmented into superpixels
+     * \param [in] labels The superpixel IDs of the pixels in the image
+     * \param [in] startY The first row to process
+     * \param [in] endY The row at which to end processing
+     */
+    static void findEdges(QVector<Edge> *edges,
+            const ImageData *img,
+            const pxind *labels,
+            const pxind startY,
+            const pxind endY
+        );
+
+    /*!
+     * \brief Sort edges and combine duplicate edges, summing their boundary lengths
+     * \param [in,out] edges The edges to process
+     */
+    static void combineEdges(QVector<Edge> &edges);
+
+    /*!
+     * \brief The number of superpixels
+     */
+    const pxind nLabels;
+
+    /*!
+     * \brief The number of pairs of adjacent superpixels
+     */
+    pxind nEdges;
+
+    /*!
+     * \brief The start of the range of each superpixel's neighbours in
+     * RegionAdjacencyGraph::adjacency
+     *
+     * This array has RegionAdjacencyGraph::nLabels + 1 elements.
+     */
+    pxind *offsets;
+
+    /*!
+     * \brief The neighbours of all superpixels, grouped by superpixel
+     *
+     * Each edge is stored twice, once for each of its superpixels.
+     */
+    pxind *adjacency;
+
+    /*!
+     * \brief Boundary lengths corresponding to the elements of
+     * RegionAdjacencyGraph::adjacency
+     */
+    pxind *lengths;
+
+    /*!
+     * \brief Colour differences corresponding to the elements of
+     * RegionAdjacencyGraph::adjacency
+     */
+    qreal *differences;
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    RegionAdjacencyGraph(const RegionAdjacencyGraph& other);
+    RegionAdjacencyGraph& operator=(const RegionAdjacencyGraph& other);
+};
+
+#endif // REGIONADJACENCYGRAPH_H
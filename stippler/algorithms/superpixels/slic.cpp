@@ -24,9 +24,11 @@
 */
 
 #include <math.h>
+#include <cstdlib>
 #include <algorithm>
 #include <QDoubleValidator>
 #include "slic.h"
+#include "taskscheduler.h"
 
 /*!
  * \brief A typedef to shorten the typename for convenience
@@ -103,6 +105,60 @@ typedef Superpixellation::Center<QVector2D> Center;
  */
 #define SLIC_MAX_KMEANS_ITERATIONS 15
 
+/*!
+  \brief A flag determining whether K-Means iteration is started on downsampled
+  copies of large input images, and then refined at full resolution
+
+  \see SLIC::initializeCoarseLevel()
+ */
+#define SLIC_ENABLE_MULTISCALE 1
+
+/*!
+  \brief The factor by which the image width and height are reduced
+  between consecutive levels of the image pyramid
+ */
+#define SLIC_MULTISCALE_FACTOR 2
+
+/*!
+  \brief The minimum number of pixels in an image which will be downsampled
+  to start K-Means iteration at a coarser level of the image pyramid
+ */
+#define SLIC_MULTISCALE_MIN_PIXELS 100000
+
+/*!
+  \brief The minimum value of SLIC::S on a coarser level of the image pyramid
+
+  Below this size, the superpixels on the downsampled image would be too
+  small to provide a good starting point for K-Means iteration at full resolution.
+ */
+#define SLIC_MULTISCALE_MIN_S 8
+
+/*!
+  \brief The number of K-Means iterations, including pixel labelling, to perform
+  at full resolution after upsampling clusters from a coarser level of the image pyramid
+  \see SLIC::maxIterations
+ */
+#define SLIC_MULTISCALE_REFINEMENT_ITERATIONS 2
+
+/*!
+  \brief The minimum size of a connected component that can be preserved
+  during post-processing, specified as a fraction of the square of SLIC::S
+
+  Smaller connected components are merged into their neighbours,
+  as in the connectivity enforcement step of the reference implementation of SLIC,
+  which uses a value of 0.25. If zero, connected components are preserved or merged
+  based only on the criterion determined by #SLIC_SELECT_LARGEST_COMPONENTS.
+  \see SLIC::dissolveSmallComponents()
+ */
+#define SLIC_MIN_COMPONENT_SIZE_FRACTION 0.0
+
+/*!
+  \brief The height, in pixels, of the horizontal strips of the image
+  in which connected components are found independently, before being merged
+  \see SLIC::labelConnectedComponents()
+ */
+#define SLIC_CONNECTED_COMPONENTS_STRIP_HEIGHT 64
+
 /*!
   \brief The number of pixels to loop over per increment of processing
  */
@@ -113,6 +169,15 @@ typedef Superpixellation::Center<QVector2D> Center;
  */
 #define SLIC_CLUSTER_GRANULARITY 10
 
+/*!
+  \brief The nominal number of Superpixel objects created per increment
+  of processing
+
+  Creating a Superpixel object takes constant time, regardless of its size.
+  \see SLIC::createSuperpixels()
+ */
+#define SLIC_SUPERPIXEL_CREATION_GRANULARITY 2000
+
 /*!
  * \brief The border colour for SLIC regions
  */
@@ -144,19 +209,30 @@ SLIC::SLIC() :
     distancesToCenters(0),
     clusterLabels(0),
     nPixelsPerCluster(0),
+    componentParents(0),
     connectedComponentLabels(0),
     nConnectedComponents(0),
+    connectedComponentSizes(0),
+    connectedComponentClusters(0),
 #if SLIC_SELECT_LARGEST_COMPONENTS
-    connectedComponentHeap(0),
+    largestComponents(0),
 #endif //SLIC_SELECT_LARGEST_COMPONENTS
     connectedComponentClassifications(0),
-    visited(0),
-    unvisitedPixels(0),
-    lastVisitedPixel(0),
-    visitedPx(0),
+    componentAdjacencyOffsets(0),
+    componentAdjacency(0),
+    componentReassignments(0),
+    componentQueue(0),
+    componentQueueLength(0),
+    nSuperpixels(0),
     pixelSortingOffsets(0),
+    interiorSortingOffsets(0),
     sortedPixels(0),
+    superpixelStatistics(0),
     superpixels(0),
+    coarseLevel(0),
+    isMultiscale(false),
+    kmeansOnly(false),
+    maxIterations(SLIC_MAX_KMEANS_ITERATIONS),
     progress(Progress::START),
     k(0),
     iterationCount(0)
@@ -186,23 +262,63 @@ bool SLIC::initialize(ImageData * &image) {
     distancesToCenters = new qreal[input->pixelCount()];
     clusterLabels = new pxind[input->pixelCount()];
     nPixelsPerCluster = new pxind[kParam];
+    componentParents = new pxind[input->pixelCount()];
     connectedComponentLabels = new pxind[input->pixelCount()];
     nConnectedComponents = 0;
+    connectedComponentSizes = new pxind[input->pixelCount()];
+    connectedComponentClusters = new pxind[input->pixelCount()];
 #if SLIC_SELECT_LARGEST_COMPONENTS
-    connectedComponentHeap = new ods::BinaryHeap<SizeLabelsPair, pxind>();
+    largestComponents = new pxind[kParam];
 #endif //SLIC_SELECT_LARGEST_COMPONENTS
-    visited = new bool[input->pixelCount()];
-    unvisitedPixels = new QLinkedList<pxind>();
-    lastVisitedPixel = 0;
-    visitedPx = new pxind[input->pixelCount()];
-    pixelSortingOffsets = new pxind[kParam];
+    componentQueueLength = 0;
+    nSuperpixels = kParam;
+    pixelSortingOffsets = new pxind[kParam + 1];
+    interiorSortingOffsets = new pxind[kParam];
     sortedPixels = new pxind[input->pixelCount()];
+    countAllocation(
+            static_cast<qint64>(input->pixelCount()) * (sizeof(qreal) + 6 * sizeof(pxind)) +
+            static_cast<qint64>(kParam) * (2 * sizeof(Center) + 3 * sizeof(pxind)) +
+            sizeof(pxind)
+        );
+#if SLIC_SELECT_LARGEST_COMPONENTS
+    countAllocation(static_cast<qint64>(kParam) * sizeof(pxind));
+#endif //SLIC_SELECT_LARGEST_COMPONENTS
+    isMultiscale = false;
+    maxIterations = SLIC_MAX_KMEANS_ITERATIONS;
     progress = Progress::START;
     k = 0;
     iterationCount = 0;
     return true;
 }
 
+QString SLIC::parameterSignature(void) const {
+    /* Include the compile-time options which affect the superpixels.
+     * The effective iteration limit, SLIC::maxIterations, is only chosen
+     * during processing, from the image size and the multiscale options,
+     * so all of the options from which it is chosen are included instead.
+     */
+    return QString("SLIC k=%1 m=%2 maxIterations=%3 errorThreshold=%4 multiscale=%5 postprocessing=%6 "
+                   "largestComponents=%7 minComponentSizeFraction=%8 visualizeLabels=%9 "
+                   "visualizeComponents=%10")
+            .arg(kParam)
+            .arg(m, 0, 'g', 17)
+            .arg(SLIC_MAX_KMEANS_ITERATIONS)
+            .arg(SLIC_ERROR_THRESHOLD, 0, 'g', 17)
+            .arg(SLIC_ENABLE_MULTISCALE)
+            .arg(SLIC_ENABLE_POSTPROCESSING)
+            .arg(SLIC_SELECT_LARGEST_COMPONENTS)
+            .arg(SLIC_MIN_COMPONENT_SIZE_FRACTION, 0, 'g', 17)
+            .arg(SLIC_VISUALIZE_LABELS)
+            .arg(SLIC_VISUALIZE_CONNECTED_COMPONENT_LABELS) +
+            QString(" multiscaleFactor=%1 multiscaleMinPixels=%2 multiscaleMinS=%3 "
+                    "multiscaleRefinementIterations=%4 kmeansOnly=%5")
+            .arg(SLIC_MULTISCALE_FACTOR)
+            .arg(SLIC_MULTISCALE_MIN_PIXELS)
+            .arg(SLIC_MULTISCALE_MIN_S)
+            .arg(SLIC_MULTISCALE_REFINEMENT_ITERATIONS)
+            .arg(static_cast<int>(kmeansOnly));
+}
+
 bool SLIC::increment(bool & f, QString & status) {
     if(failed) {
         status = QObject::tr("Cannot increment - Processing has failed.");
@@ -214,33 +330,82 @@ bool SLIC::increment(bool & f, QString & status) {
     }
 
     pxind incEnd = updateKAndProgress();
+    // Loops over pixels sorted into superpixels run backwards
+    const pxind nIterations = std::abs(incEnd - k);
 
     switch(progress) {
     case Progress::RGB2LAB: {
         lStarOrigin = input->lStar();
         aStarOrigin = input->aStar();
         bStarOrigin = input->bStar();
+        countWork(0, input->pixelCount());
         status = QObject::tr("Converted the input image to the CIE L*a*b* colour space.");
         break;
     }
+    case Progress::DOWNSAMPLE_INPUT: {
+        failed = !initializeCoarseLevel();
+        countWork(0, input->pixelCount());
+        if(failed) {
+            status = QObject::tr("Failed to initialize K-means iteration on a downsampled image.");
+        } else {
+            status = QObject::tr("Downsampled the input image to %1 x %2 pixels.")
+                    .arg(coarseLevel->input->width())
+                    .arg(coarseLevel->input->height());
+        }
+        break;
+    }
+    case Progress::COARSE_KMEANS: {
+        bool coarseFinished = false;
+        QString coarseStatus;
+        failed = !coarseLevel->timedIncrement(coarseFinished, coarseStatus);
+        if(coarseFinished) {
+            appendNestedProfile(*coarseLevel);
+        }
+        if(coarseStatus.isEmpty()) {
+            // Progress was published to the shared progress channel
+            status.clear();
+        } else {
+            status = QObject::tr("Downsampled image: %1").arg(coarseStatus);
+        }
+        break;
+    }
+    case Progress::UPSAMPLE_CLUSTERS: {
+        if(k == 0) {
+            initializeSearchWindow();
+        }
+        upsampleClusters(incEnd);
+        countWork(nIterations, nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Upsampling K-means clusters (%1 / %2)"),
+                k, input->pixelCount());
+        break;
+    }
     case Progress::SEED_CENTERS: {
         initializeCenters(incEnd);
-        status = QObject::tr("Initializing cluster centers (%1 / %2)")
-                .arg(k)
-                .arg(kParam);
+        countWork(nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Initializing cluster centers (%1 / %2)"),
+                k, kParam);
+        break;
+    }
+    case Progress::K_MEANS_RESET_LABELS: {
+        /* A pass over all pixels, which is divided into increments
+         * like any other, rather than done at the start of K_MEANS_LABEL_PIXELS
+         */
+        QDoubleValidator validator;
+        std::fill(distancesToCenters + k, distancesToCenters + incEnd, validator.top());
+        std::fill(clusterLabels + k, clusterLabels + incEnd, SUPERPIXELLATION_NONE_LABEL);
+        k = incEnd;
+        countWork(nIterations, nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "K-means iteration %3, resetting pixel labels (%1 / %2)"),
+                k, input->pixelCount(), iterationCount);
         break;
     }
     case Progress::K_MEANS_LABEL_PIXELS: {
-        if(k == 0) {
-            QDoubleValidator validator;
-            std::fill(distancesToCenters, distancesToCenters + input->pixelCount(), validator.top());
-            std::fill(clusterLabels, clusterLabels + input->pixelCount(), SUPERPIXELLATION_NONE_LABEL);
-        }
         kmeansLabelPixels(incEnd);
-        status = QObject::tr("K-means iteration %1, labelling pixels (%2 / %3)")
-                .arg(iterationCount)
-                .arg(k)
-                .arg(kParam);
+        // An upper bound, as search windows are clipped to the image
+        countWork(nIterations, static_cast<qint64>(nIterations) *
+                  ((2 * searchHalfWidth) + 1) * ((2 * searchHalfHeight) + 1));
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "K-means iteration %3, labelling pixels (%1 / %2)"),
+                k, kParam, iterationCount);
         break;
     }
     case Progress::K_MEANS_UPDATE_CENTERS: {
@@ -250,85 +415,165 @@ bool SLIC::increment(bool & f, QString & status) {
             std::fill(currentCenters, currentCenters+kParam, blankCenter);
         }
         kmeansUpdateCenters(incEnd);
-        status = QObject::tr("K-means iteration %1, recomputing cluster centers (%2 / %3)")
-                .arg(iterationCount)
-                .arg(k)
-                .arg(input->pixelCount());
+        countWork(nIterations, nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "K-means iteration %3, recomputing cluster centers (%1 / %2)"),
+                k, input->pixelCount(), iterationCount);
         break;
     }
     case Progress::K_MEANS_ASSESS_ITERATION: {
-        if( iterationCount > 0 ) {
+        /* Cluster centers upsampled from a coarser level of the image pyramid
+         * are a valid reference for the first iteration.
+         */
+        countWork(nIterations);
+        if( iterationCount > 0 || isMultiscale ) {
             kmeansResidualError(incEnd);
-            status = QObject::tr("K-means iteration %1, calculating residual error (%2 / %3)")
-                    .arg(iterationCount)
-                    .arg(k)
-                    .arg(kParam);
+            reportProgress(status, QT_TRANSLATE_NOOP("QObject", "K-means iteration %3, calculating residual error (%1 / %2)"),
+                k, kParam, iterationCount);
         } else {
             kmeansResidualError(incEnd, true);
-            status = QObject::tr("K-means iteration %1, normalizing cluster centers (%2 / %3)")
-                    .arg(iterationCount)
-                    .arg(k)
-                    .arg(kParam);
+            reportProgress(status, QT_TRANSLATE_NOOP("QObject", "K-means iteration %3, normalizing cluster centers (%1 / %2)"),
+                k, kParam, iterationCount);
         }
         break;
     }
     case Progress::FIND_CONNECTED_COMPONENTS: {
+        labelConnectedComponents(incEnd);
+        countWork(nIterations, static_cast<qint64>(nIterations) * SLIC_CONNECTED_COMPONENTS_STRIP_HEIGHT * input->width());
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Finding connected components in image strips (%1 / %2)"),
+                k, getLoopLimit());
+        break;
+    }
+    case Progress::MERGE_CONNECTED_COMPONENT_STRIPS: {
+        mergeConnectedComponentStrips(incEnd);
+        countWork(nIterations, static_cast<qint64>(nIterations) * input->width());
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Merging connected components between image strips (%1 / %2)"),
+                k, getLoopLimit());
+        break;
+    }
+    case Progress::RESOLVE_CONNECTED_COMPONENTS: {
         if(k == 0) {
-            std::fill(visited, visited + input->pixelCount(), false);
-            std::fill(connectedComponentLabels, connectedComponentLabels + input->pixelCount(), SUPERPIXELLATION_NONE_LABEL);
+            nConnectedComponents = 0;
         }
-        labelConnectedComponents(incEnd);
-        status = QObject::tr("Finding connected components (%1 / %2)")
-                .arg(k)
-                .arg(input->pixelCount());
+        resolveConnectedComponents(incEnd);
+        countWork(nIterations, nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Labelling connected components (%1 / %2)"),
+                k, input->pixelCount());
         break;
     }
     case Progress::CLASSIFY_CONNECTED_COMPONENTS: {
         if(k == 0) {
             connectedComponentClassifications = new bool[nConnectedComponents];
+            countAllocation(static_cast<qint64>(nConnectedComponents) * sizeof(bool));
             std::fill(
                     connectedComponentClassifications,
                     connectedComponentClassifications + nConnectedComponents,
                     false
                 );
+#if SLIC_SELECT_LARGEST_COMPONENTS
+            findLargestComponents();
+#endif //SLIC_SELECT_LARGEST_COMPONENTS
         }
         classifyConnectedComponents(incEnd);
-        status = QObject::tr("Finding cluster centers in connected components (%1 / %2)")
-                .arg(k)
-                .arg(kParam);
+        countWork(nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Finding cluster centers in connected components (%1 / %2)"),
+                k, kParam);
+        break;
+    }
+    case Progress::COUNT_COMPONENT_ADJACENCY: {
+        if(k == 0) {
+            dissolveSmallComponents();
+            componentAdjacencyOffsets = new pxind[nConnectedComponents + 1];
+            countAllocation(static_cast<qint64>(nConnectedComponents + 1) * sizeof(pxind));
+            std::fill(componentAdjacencyOffsets, componentAdjacencyOffsets + nConnectedComponents + 1, 0);
+        }
+        countComponentAdjacency(incEnd);
+        countWork(nIterations, nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Finding neighbouring connected components (%1 / %2)"),
+                k, input->pixelCount());
+        break;
+    }
+    case Progress::LIST_COMPONENT_ADJACENCY: {
+        if(k == 0) {
+            /* As in counting sort, the offsets are first set to the ends
+             * of the lists, and are decremented as the lists are filled.
+             */
+            for(pxind i = 1; i < nConnectedComponents; i += 1) {
+                componentAdjacencyOffsets[i] += componentAdjacencyOffsets[i - 1];
+            }
+            componentAdjacencyOffsets[nConnectedComponents] = componentAdjacencyOffsets[nConnectedComponents - 1];
+            componentAdjacency = new pxind[componentAdjacencyOffsets[nConnectedComponents]];
+            countAllocation(static_cast<qint64>(componentAdjacencyOffsets[nConnectedComponents]) * sizeof(pxind));
+        }
+        listComponentAdjacency(incEnd);
+        countWork(nIterations, nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Listing neighbouring connected components (%1 / %2)"),
+                k, input->pixelCount());
         break;
     }
     case Progress::REASSIGN_CONNECTED_COMPONENTS: {
         if(k == 0) {
-            std::fill(visited, visited + input->pixelCount(), false);
+            componentReassignments = new pxind[nConnectedComponents];
+            componentQueue = new pxind[nConnectedComponents];
+            countAllocation(static_cast<qint64>(nConnectedComponents) * 2 * sizeof(pxind));
+            componentQueueLength = 0;
         }
         reassignConnectedComponents(incEnd);
-        status = QObject::tr("Reassigning connected components (%1 / %2)")
-                .arg(k)
-                .arg(input->pixelCount());
+        countWork(nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Reassigning connected components (%1 / %2)"),
+                k, nConnectedComponents);
+        break;
+    }
+    case Progress::PROPAGATE_COMPONENT_REASSIGNMENT: {
+        propagateComponentReassignment();
+        status = QObject::tr("Reassigned isolated connected components, leaving %1 superpixels.")
+                .arg(nSuperpixels);
+        break;
+    }
+    case Progress::RELABEL_PIXELS: {
+        relabelPixels(incEnd);
+        countWork(nIterations, nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Relabelling pixels (%1 / %2)"),
+                k, input->pixelCount());
+        break;
+    }
+    case Progress::COMPUTE_SUPERPIXEL_STATISTICS: {
+        superpixelStatistics = new SuperpixelStatistics(*input, clusterLabels, nSuperpixels);
+        countWork(0, input->pixelCount());
+        status = QObject::tr("Measured superpixels.");
         break;
     }
     case Progress::SORT_PIXELS_AS_SUPERPIXELS: {
         if(k == (input->pixelCount() - 1)) {
-            pixelSortingOffsets[0] = nPixelsPerCluster[0];
-            for(pxind i = 1; i < kParam; i += 1) {
-                pixelSortingOffsets[i] = nPixelsPerCluster[i] + pixelSortingOffsets[i - 1];
+            /* Each superpixel's range starts with its boundary pixels, followed
+             * by its interior pixels. As in counting sort, the offsets are
+             * first set to the ends of the two sub-ranges.
+             */
+            pxind start = 0;
+            for(pxind i = 0; i < nSuperpixels; i += 1) {
+                const SuperpixelStatistics::Statistics &statistics = (*superpixelStatistics)[i];
+                pixelSortingOffsets[i] = start + statistics.boundaryCount;
+                interiorSortingOffsets[i] = start + statistics.count;
+                start += statistics.count;
             }
+            Q_ASSERT(start == input->pixelCount());
+            pixelSortingOffsets[nSuperpixels] = input->pixelCount();
         }
         sortPixelsIntoSuperpixels(incEnd);
-        status = QObject::tr("Sorting pixels into superpixels (%1 / %2)")
-                .arg(k)
-                .arg(input->pixelCount());
+        countWork(nIterations, nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Sorting pixels into superpixels (%1 / %2)"),
+                k, input->pixelCount());
         break;
     }
     case Progress::CREATE_SUPERPIXEL_OBJECTS: {
         if(k == 0) {
-            superpixels = new Superpixel*[kParam];
+            // Null pointers mark superpixels not yet created, in case processing stops early
+            superpixels = new Superpixel*[nSuperpixels]();
+            countAllocation(static_cast<qint64>(nSuperpixels) * sizeof(Superpixel*));
         }
         createSuperpixels(incEnd);
-        status = QObject::tr("Creating and measuring superpixels (%1 / %2)")
-                .arg(k)
-                .arg(kParam);
+        countWork(nIterations);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Creating superpixels (%1 / %2)"),
+                k, nSuperpixels);
         break;
     }
     case Progress::INITIALIZE_OUTPUT: {
@@ -341,10 +586,10 @@ bool SLIC::increment(bool & f, QString & status) {
         break;
     }
     case Progress::FILL_OUTPUT: {
+        countWork(nIterations, pixelSortingOffsets[incEnd] - pixelSortingOffsets[k]);
         fillOutputImage(incEnd);
-        status = QObject::tr("Filling output image (%1 / %2)")
-                .arg(k)
-                .arg(kParam);
+        reportProgress(status, QT_TRANSLATE_NOOP("QObject", "Filling output image (%1 / %2)"),
+                k, nSuperpixels);
         break;
     }
     case Progress::FINALIZE_OUTPUT: {
@@ -372,7 +617,15 @@ bool SLIC::outputSuperpixellation(Superpixellation *& superpixellation) {
         return false;
     }
     Q_ASSERT(superpixellation == 0);
-    superpixellation = new Superpixellation(input, clusterLabels, superpixels, kParam);
+    superpixellation = new Superpixellation(
+                input,
+                clusterLabels,
+                sortedPixels,
+                pixelSortingOffsets,
+                superpixelStatistics,
+                superpixels,
+                nSuperpixels
+            );
     return true;
 }
 
@@ -392,10 +645,46 @@ pxind SLIC::updateKAndProgress(void) {
             break;
         }
         case Progress::RGB2LAB: {
+#if SLIC_ENABLE_MULTISCALE
+            if(
+                (input->pixelCount() >= SLIC_MULTISCALE_MIN_PIXELS) &&
+                (S >= (SLIC_MULTISCALE_FACTOR * SLIC_MULTISCALE_MIN_S))
+                ) {
+                isMultiscale = true;
+                maxIterations = SLIC_MULTISCALE_REFINEMENT_ITERATIONS + 1;
+                progress = Progress::DOWNSAMPLE_INPUT;
+            } else {
+                progress = Progress::SEED_CENTERS;
+            }
+#else
             progress = Progress::SEED_CENTERS;
+#endif // SLIC_ENABLE_MULTISCALE
+            break;
+        }
+        case Progress::DOWNSAMPLE_INPUT: {
+            progress = Progress::COARSE_KMEANS;
+            break;
+        }
+        case Progress::COARSE_KMEANS: {
+            if(coarseLevel->isFinished()) {
+                progress = Progress::UPSAMPLE_CLUSTERS;
+            }
+            break;
+        }
+        case Progress::UPSAMPLE_CLUSTERS: {
+            delete coarseLevel;
+            coarseLevel = 0;
+            /* The first iteration at full resolution starts from the
+             * upsampled cluster labels, rather than from cluster centers.
+             */
+            progress = Progress::K_MEANS_UPDATE_CENTERS;
             break;
         }
         case Progress::SEED_CENTERS: {
+            progress = Progress::K_MEANS_RESET_LABELS;
+            break;
+        }
+        case Progress::K_MEANS_RESET_LABELS: {
             progress = Progress::K_MEANS_LABEL_PIXELS;
             break;
         }
@@ -410,18 +699,21 @@ pxind SLIC::updateKAndProgress(void) {
         case Progress::K_MEANS_ASSESS_ITERATION: {
             qreal errorChange = abs((sqrt(residualError) - sqrt(previousResidualError))/ sqrt(previousResidualError));
             if(
-                (iterationCount == (SLIC_MAX_KMEANS_ITERATIONS - 1)) || (
+                (iterationCount == (maxIterations - 1)) || (
                     (iterationCount > 1) && (errorChange <= SLIC_ERROR_THRESHOLD)
                     )
                 ) {
+                if(kmeansOnly) {
+                    progress = Progress::END;
+                    break;
+                }
 #if SLIC_ENABLE_POSTPROCESSING
                 progress = Progress::FIND_CONNECTED_COMPONENTS;
 #else
-                k = input->pixelCount() - 1;
-                progress = Progress::SORT_PIXELS_AS_SUPERPIXELS;
+                progress = Progress::COMPUTE_SUPERPIXEL_STATISTICS;
 #endif //SLIC_ENABLE_POSTPROCESSING
             } else {
-                progress = Progress::K_MEANS_LABEL_PIXELS;
+                progress = Progress::K_MEANS_RESET_LABELS;
                 iterationCount += 1;
                 std::copy(currentCenters, currentCenters + kParam, previousCenters);
                 previousResidualError = residualError;
@@ -430,14 +722,42 @@ pxind SLIC::updateKAndProgress(void) {
             break;
         }
         case Progress::FIND_CONNECTED_COMPONENTS: {
+            progress = Progress::MERGE_CONNECTED_COMPONENT_STRIPS;
+            break;
+        }
+        case Progress::MERGE_CONNECTED_COMPONENT_STRIPS: {
+            progress = Progress::RESOLVE_CONNECTED_COMPONENTS;
+            break;
+        }
+        case Progress::RESOLVE_CONNECTED_COMPONENTS: {
             progress = Progress::CLASSIFY_CONNECTED_COMPONENTS;
             break;
         }
         case Progress::CLASSIFY_CONNECTED_COMPONENTS: {
+            progress = Progress::COUNT_COMPONENT_ADJACENCY;
+            break;
+        }
+        case Progress::COUNT_COMPONENT_ADJACENCY: {
+            progress = Progress::LIST_COMPONENT_ADJACENCY;
+            break;
+        }
+        case Progress::LIST_COMPONENT_ADJACENCY: {
             progress = Progress::REASSIGN_CONNECTED_COMPONENTS;
             break;
         }
         case Progress::REASSIGN_CONNECTED_COMPONENTS: {
+            progress = Progress::PROPAGATE_COMPONENT_REASSIGNMENT;
+            break;
+        }
+        case Progress::PROPAGATE_COMPONENT_REASSIGNMENT: {
+            progress = Progress::RELABEL_PIXELS;
+            break;
+        }
+        case Progress::RELABEL_PIXELS: {
+            progress = Progress::COMPUTE_SUPERPIXEL_STATISTICS;
+            break;
+        }
+        case Progress::COMPUTE_SUPERPIXEL_STATISTICS: {
             k = input->pixelCount() - 1;
             progress = Progress::SORT_PIXELS_AS_SUPERPIXELS;
             break;
@@ -477,6 +797,7 @@ pxind SLIC::updateKAndProgress(void) {
         // Update the end of a loop
         loopLimit = getLoopLimit();
     }
+    enterPhase(progressName(progress));
 
     // Set increment size and direction
     pxind inc = 0;
@@ -488,47 +809,90 @@ pxind SLIC::updateKAndProgress(void) {
     case Progress::RGB2LAB: {
         break;
     }
+    case Progress::DOWNSAMPLE_INPUT: {
+        break;
+    }
+    case Progress::COARSE_KMEANS: {
+        break;
+    }
+    case Progress::UPSAMPLE_CLUSTERS: {
+        inc = adaptiveIncrement(SLIC_PIXEL_GRANULARITY);
+        break;
+    }
     case Progress::SEED_CENTERS: {
-        inc = SLIC_CLUSTER_GRANULARITY;
+        inc = adaptiveIncrement(SLIC_CLUSTER_GRANULARITY);
+        break;
+    }
+    case Progress::K_MEANS_RESET_LABELS: {
+        inc = adaptiveIncrement(SLIC_PIXEL_GRANULARITY);
         break;
     }
     case Progress::K_MEANS_LABEL_PIXELS: {
-        inc = SLIC_CLUSTER_GRANULARITY;
+        inc = adaptiveIncrement(SLIC_CLUSTER_GRANULARITY);
         break;
     }
     case Progress::K_MEANS_UPDATE_CENTERS: {
-        inc = SLIC_PIXEL_GRANULARITY;
+        inc = adaptiveIncrement(SLIC_PIXEL_GRANULARITY);
         break;
     }
     case Progress::K_MEANS_ASSESS_ITERATION: {
-        inc = SLIC_CLUSTER_GRANULARITY;
+        inc = adaptiveIncrement(SLIC_CLUSTER_GRANULARITY);
         break;
     }
     case Progress::FIND_CONNECTED_COMPONENTS: {
-        inc = SLIC_PIXEL_GRANULARITY;
+        // Each image strip is #SLIC_CONNECTED_COMPONENTS_STRIP_HEIGHT rows of pixels
+        inc = adaptiveIncrement(std::max(
+                SLIC_PIXEL_GRANULARITY / (SLIC_CONNECTED_COMPONENTS_STRIP_HEIGHT * input->width()), 1));
+        break;
+    }
+    case Progress::MERGE_CONNECTED_COMPONENT_STRIPS: {
+        // Each strip boundary is one row of pixels
+        inc = adaptiveIncrement(std::max(SLIC_PIXEL_GRANULARITY / input->width(), 1));
+        break;
+    }
+    case Progress::RESOLVE_CONNECTED_COMPONENTS: {
+        inc = adaptiveIncrement(SLIC_PIXEL_GRANULARITY);
         break;
     }
     case Progress::CLASSIFY_CONNECTED_COMPONENTS: {
-        inc = SLIC_CLUSTER_GRANULARITY;
+        inc = adaptiveIncrement(SLIC_CLUSTER_GRANULARITY);
+        break;
+    }
+    case Progress::COUNT_COMPONENT_ADJACENCY: {
+        inc = adaptiveIncrement(SLIC_PIXEL_GRANULARITY);
+        break;
+    }
+    case Progress::LIST_COMPONENT_ADJACENCY: {
+        inc = adaptiveIncrement(SLIC_PIXEL_GRANULARITY);
         break;
     }
     case Progress::REASSIGN_CONNECTED_COMPONENTS: {
-        inc = SLIC_PIXEL_GRANULARITY;
+        inc = adaptiveIncrement(SLIC_CLUSTER_GRANULARITY);
+        break;
+    }
+    case Progress::PROPAGATE_COMPONENT_REASSIGNMENT: {
+        break;
+    }
+    case Progress::RELABEL_PIXELS: {
+        inc = adaptiveIncrement(SLIC_PIXEL_GRANULARITY);
         break;
     }
     case Progress::SORT_PIXELS_AS_SUPERPIXELS: {
-        inc = -(SLIC_PIXEL_GRANULARITY);
+        inc = -adaptiveIncrement(SLIC_PIXEL_GRANULARITY);
+        break;
+    }
+    case Progress::COMPUTE_SUPERPIXEL_STATISTICS: {
         break;
     }
     case Progress::CREATE_SUPERPIXEL_OBJECTS: {
-        inc = SLIC_CLUSTER_GRANULARITY;
+        inc = adaptiveIncrement(SLIC_SUPERPIXEL_CREATION_GRANULARITY);
         break;
     }
     case Progress::INITIALIZE_OUTPUT: {
         break;
     }
     case Progress::FILL_OUTPUT: {
-        inc = SLIC_CLUSTER_GRANULARITY;
+        inc = adaptiveIncrement(SLIC_CLUSTER_GRANULARITY);
         break;
     }
     case Progress::FINALIZE_OUTPUT: {
@@ -552,6 +916,40 @@ pxind SLIC::updateKAndProgress(void) {
     return incEnd;
 }
 
+const char *SLIC::progressName(const Progress &p) {
+    static const char * const names[] = {
+        "START",
+        "RGB2LAB",
+        "DOWNSAMPLE_INPUT",
+        "COARSE_KMEANS",
+        "UPSAMPLE_CLUSTERS",
+        "SEED_CENTERS",
+        "K_MEANS_RESET_LABELS",
+        "K_MEANS_LABEL_PIXELS",
+        "K_MEANS_UPDATE_CENTERS",
+        "K_MEANS_ASSESS_ITERATION",
+        "FIND_CONNECTED_COMPONENTS",
+        "MERGE_CONNECTED_COMPONENT_STRIPS",
+        "RESOLVE_CONNECTED_COMPONENTS",
+        "CLASSIFY_CONNECTED_COMPONENTS",
+        "COUNT_COMPONENT_ADJACENCY",
+        "LIST_COMPONENT_ADJACENCY",
+        "REASSIGN_CONNECTED_COMPONENTS",
+        "PROPAGATE_COMPONENT_REASSIGNMENT",
+        "RELABEL_PIXELS",
+        "COMPUTE_SUPERPIXEL_STATISTICS",
+        "SORT_PIXELS_AS_SUPERPIXELS",
+        "CREATE_SUPERPIXEL_OBJECTS",
+        "INITIALIZE_OUTPUT",
+        "FILL_OUTPUT",
+        "FINALIZE_OUTPUT",
+        "END"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<unsigned int>(Progress::END) + 1,
+                  "Each stage of processing must have a name");
+    return names[static_cast<unsigned int>(p)];
+}
+
 pxind SLIC::getLoopLimit(void) const {
     pxind loopLimit = 0;
 
@@ -562,10 +960,24 @@ pxind SLIC::getLoopLimit(void) const {
     case Progress::RGB2LAB: {
         break;
     }
+    case Progress::DOWNSAMPLE_INPUT: {
+        break;
+    }
+    case Progress::COARSE_KMEANS: {
+        break;
+    }
+    case Progress::UPSAMPLE_CLUSTERS: {
+        loopLimit = input->pixelCount();
+        break;
+    }
     case Progress::SEED_CENTERS: {
         loopLimit = kParam;
         break;
     }
+    case Progress::K_MEANS_RESET_LABELS: {
+        loopLimit = input->pixelCount();
+        break;
+    }
     case Progress::K_MEANS_LABEL_PIXELS: {
         loopLimit = kParam;
         break;
@@ -579,6 +991,15 @@ pxind SLIC::getLoopLimit(void) const {
         break;
     }
     case Progress::FIND_CONNECTED_COMPONENTS: {
+        loopLimit = (input->height() + SLIC_CONNECTED_COMPONENTS_STRIP_HEIGHT - 1) /
+                SLIC_CONNECTED_COMPONENTS_STRIP_HEIGHT;
+        break;
+    }
+    case Progress::MERGE_CONNECTED_COMPONENT_STRIPS: {
+        loopLimit = (input->height() - 1) / SLIC_CONNECTED_COMPONENTS_STRIP_HEIGHT;
+        break;
+    }
+    case Progress::RESOLVE_CONNECTED_COMPONENTS: {
         loopLimit = input->pixelCount();
         break;
     }
@@ -586,22 +1007,40 @@ pxind SLIC::getLoopLimit(void) const {
         loopLimit = kParam;
         break;
     }
+    case Progress::COUNT_COMPONENT_ADJACENCY: {
+        loopLimit = input->pixelCount();
+        break;
+    }
+    case Progress::LIST_COMPONENT_ADJACENCY: {
+        loopLimit = input->pixelCount();
+        break;
+    }
     case Progress::REASSIGN_CONNECTED_COMPONENTS: {
+        loopLimit = nConnectedComponents;
+        break;
+    }
+    case Progress::PROPAGATE_COMPONENT_REASSIGNMENT: {
+        break;
+    }
+    case Progress::RELABEL_PIXELS: {
         loopLimit = input->pixelCount();
         break;
     }
     case Progress::SORT_PIXELS_AS_SUPERPIXELS: {
         break;
     }
+    case Progress::COMPUTE_SUPERPIXEL_STATISTICS: {
+        break;
+    }
     case Progress::CREATE_SUPERPIXEL_OBJECTS: {
-        loopLimit = kParam;
+        loopLimit = nSuperpixels;
         break;
     }
     case Progress::INITIALIZE_OUTPUT: {
         break;
     }
     case Progress::FILL_OUTPUT: {
-        loopLimit = kParam;
+        loopLimit = nSuperpixels;
         break;
     }
     case Progress::FINALIZE_OUTPUT: {
@@ -617,24 +1056,26 @@ pxind SLIC::getLoopLimit(void) const {
     return loopLimit;
 }
 
-void SLIC::initializeCenters(const pxind &endCluster) {
-    pxind sampleX = 0;
-    pxind sampleY = 0;
-    pxind sampleK = 0;
-
+void SLIC::seedingGrid(pxind &widthInS, qreal &widthConversion, qreal &heightConversion, qreal &kConversion) const {
     /* Find the smallest grid with square dimensions of `S` containing
      * the input image.
      */
-    pxind widthInS = ceil(static_cast<qreal>(input->width()) / static_cast<qreal>(S));
+    widthInS = ceil(static_cast<qreal>(input->width()) / static_cast<qreal>(S));
     pxind width = widthInS * S;
-    qreal widthConversion = S * static_cast<qreal>(input->width()) / static_cast<qreal>(width);
-    pxind sDiv2Width = static_cast<pxind>(widthConversion) / 2;
+    widthConversion = S * static_cast<qreal>(input->width()) / static_cast<qreal>(width);
     pxind heightInS = ceil(static_cast<qreal>(input->height()) / static_cast<qreal>(S));
     pxind height = heightInS * S;
-    qreal heightConversion = S * static_cast<qreal>(input->height()) / static_cast<qreal>(height);
-    pxind sDiv2Height = static_cast<pxind>(heightConversion) / 2;
+    heightConversion = S * static_cast<qreal>(input->height()) / static_cast<qreal>(height);
     pxind lengthInSSquares = widthInS * heightInS;
-    qreal kConversion = static_cast<qreal>(lengthInSSquares) / static_cast<qreal>(kParam);
+    kConversion = static_cast<qreal>(lengthInSSquares) / static_cast<qreal>(kParam);
+}
+
+void SLIC::initializeSearchWindow(void) {
+    pxind widthInS = 0;
+    qreal widthConversion = 0.0;
+    qreal heightConversion = 0.0;
+    qreal kConversion = 0.0;
+    seedingGrid(widthInS, widthConversion, heightConversion, kConversion);
 
     /* `kConversion` is the ratio of the number of squares in the initialization
      * grid to the number of cluster centers.
@@ -652,19 +1093,84 @@ void SLIC::initializeCenters(const pxind &endCluster) {
      * A similar calculation is applied to determine the cluster search window
      * half height.
      */
-    if(clusterSearchWindow == 0) {
-        searchHalfWidth = static_cast<pxind>(ceil((ceil(kConversion) - 0.5) * widthConversion)) + 4;
-        searchHalfHeight = static_cast<pxind>(ceil((ceil(kConversion) - 0.5) * heightConversion)) + 4;
-        /* However, for smaller values of SLIC::m, I will get visible clipping
-         * of clusters to the search window, so I prefer to be more generous.
+    searchHalfWidth = static_cast<pxind>(ceil((ceil(kConversion) - 0.5) * widthConversion)) + 4;
+    searchHalfHeight = static_cast<pxind>(ceil((ceil(kConversion) - 0.5) * heightConversion)) + 4;
+    /* However, for smaller values of SLIC::m, I will get visible clipping
+     * of clusters to the search window, so I prefer to be more generous.
+     */
+    if(searchHalfWidth < (SLIC_MIN_SEARCH_WINDOW_SIZE * S)) {
+        searchHalfWidth = (SLIC_MIN_SEARCH_WINDOW_SIZE * S);
+    }
+    if(searchHalfHeight < (SLIC_MIN_SEARCH_WINDOW_SIZE * S)) {
+        searchHalfHeight = (SLIC_MIN_SEARCH_WINDOW_SIZE * S);
+    }
+    if(clusterSearchWindow != 0) {
+        delete [] clusterSearchWindow;
+    }
+    clusterSearchWindow = new pxind[((2 * searchHalfWidth) + 1) * ((2 * searchHalfHeight) + 1)];
+    countAllocation(static_cast<qint64>((2 * searchHalfWidth) + 1) * ((2 * searchHalfHeight) + 1) * sizeof(pxind));
+}
+
+bool SLIC::initializeCoarseLevel(void) {
+    if(coarseLevel != 0) {
+        delete coarseLevel;
+        coarseLevel = 0;
+    }
+    ImageData *coarseImage = input->downsampleLab(SLIC_MULTISCALE_FACTOR);
+    coarseLevel = new SLIC();
+    coarseLevel->kParam = kParam;
+    coarseLevel->m = m;
+    coarseLevel->kmeansOnly = true;
+    coarseLevel->incrementBudget = incrementBudget;
+    coarseLevel->cancellationToken = cancellationToken;
+    coarseLevel->progressChannel = progressChannel;
+    coarseLevel->disableOutput();
+    return coarseLevel->initialize(coarseImage); // Sets `coarseImage` to null
+}
+
+void SLIC::upsampleClusters(const pxind &endPx) {
+    const ImageData *coarseImage = coarseLevel->input;
+    const pxind *coarseLabels = coarseLevel->clusterLabels;
+    if(k == 0) {
+        const Center *coarseCenters = coarseLevel->currentCenters;
+        /* A pixel at integer position `x` in the coarse image covers pixels
+         * `x * SLIC_MULTISCALE_FACTOR` through `(x + 1) * SLIC_MULTISCALE_FACTOR - 1`
+         * in the full resolution image.
          */
-        if(searchHalfWidth < (SLIC_MIN_SEARCH_WINDOW_SIZE * S)) {
-            searchHalfWidth = (SLIC_MIN_SEARCH_WINDOW_SIZE * S);
-        }
-        if(searchHalfHeight < (SLIC_MIN_SEARCH_WINDOW_SIZE * S)) {
-            searchHalfHeight = (SLIC_MIN_SEARCH_WINDOW_SIZE * S);
+        QVector2D offset(
+                    (SLIC_MULTISCALE_FACTOR - 1) / 2.0,
+                    (SLIC_MULTISCALE_FACTOR - 1) / 2.0
+                );
+        for(pxind i = 0; i < kParam; i += 1) {
+            previousCenters[i].position = (coarseCenters[i].position * SLIC_MULTISCALE_FACTOR) + offset;
+            previousCenters[i].color = coarseCenters[i].color;
         }
-        clusterSearchWindow = new pxind[((2 * searchHalfWidth) + 1) * ((2 * searchHalfHeight) + 1)];
+    }
+
+    pxind x = 0, y = 0;
+    for(; k < endPx; k += 1) {
+        input->kToXY(k, x, y);
+        clusterLabels[k] = coarseLabels[
+                coarseImage->xyToK(x / SLIC_MULTISCALE_FACTOR, y / SLIC_MULTISCALE_FACTOR)
+            ];
+    }
+}
+
+void SLIC::initializeCenters(const pxind &endCluster) {
+    pxind sampleX = 0;
+    pxind sampleY = 0;
+    pxind sampleK = 0;
+
+    pxind widthInS = 0;
+    qreal widthConversion = 0.0;
+    qreal heightConversion = 0.0;
+    qreal kConversion = 0.0;
+    seedingGrid(widthInS, widthConversion, heightConversion, kConversion);
+    pxind sDiv2Width = static_cast<pxind>(widthConversion) / 2;
+    pxind sDiv2Height = static_cast<pxind>(heightConversion) / 2;
+
+    if(clusterSearchWindow == 0) {
+        initializeSearchWindow();
     }
 
     pxind adjustedK = 0;
@@ -766,80 +1272,110 @@ void SLIC::kmeansResidualError(const pxind &endCluster, const bool& firstIterati
     }
 }
 
-void SLIC::labelConnectedComponents(const pxind &endPx) {
-    pxind px = SUPERPIXELLATION_NONE_LABEL;
-    pxind pxNeighbour = 0;
-    pxind neighbours[4] = {0};
-    pxind nNeighbours = 0;
+void SLIC::labelConnectedComponents(const pxind &endStrip) {
+    TaskScheduler::instance().parallelFor(
+                k,
+                endStrip,
+                1,
+                [this](pxind startStrip, pxind rangeEnd) {
+                    labelStripRange(startStrip, rangeEnd);
+                }
+            );
+    k = endStrip;
+}
+
+void SLIC::labelStripRange(const pxind startStrip, const pxind endStrip) {
+    pxind x = 0, y = 0;
+    pxind width = input->width();
     pxind clusterLabel = SUPERPIXELLATION_NONE_LABEL;
-    pxind componentLabel = SUPERPIXELLATION_NONE_LABEL;
-    for(; k < endPx; k += 1) {
+    pxind px = input->xyToK(0, startStrip * SLIC_CONNECTED_COMPONENTS_STRIP_HEIGHT);
+    pxind endPx = std::min(
+                endStrip * SLIC_CONNECTED_COMPONENTS_STRIP_HEIGHT * width,
+                input->pixelCount()
+            );
+    for(; px < endPx; px += 1) {
+        input->kToXY(px, x, y);
+        clusterLabel = clusterLabels[px];
 
-        // Get the next pixel to process
-        if(!unvisitedPixels->isEmpty()) {
-            do {
-                px = unvisitedPixels->first();
-                unvisitedPixels->removeFirst();
-            } while(visited[px] && !unvisitedPixels->isEmpty());
+        // Join the left neighbour's tree, or start a new tree
+        if(x > 0 && clusterLabels[px - 1] == clusterLabel) {
+            componentParents[px] = findComponentRoot(px - 1);
+        } else {
+            componentParents[px] = px;
+        }
+
+        /* Join the upper neighbour's tree, unless the upper neighbour
+         * is in a different image strip
+         */
+        if((y % SLIC_CONNECTED_COMPONENTS_STRIP_HEIGHT) != 0 && clusterLabels[px - width] == clusterLabel) {
+            uniteComponents(px, px - width);
+        }
+    }
+}
+
+void SLIC::mergeConnectedComponentStrips(const pxind &endBoundary) {
+    pxind width = input->width();
+    pxind px = 0;
+    pxind endPx = 0;
+    for(; k < endBoundary; k += 1) {
+        px = input->xyToK(0, (k + 1) * SLIC_CONNECTED_COMPONENTS_STRIP_HEIGHT);
+        endPx = px + width;
+        for(; px < endPx; px += 1) {
+            if(clusterLabels[px] == clusterLabels[px - width]) {
+                uniteComponents(px, px - width);
+            }
         }
-        if(px == SUPERPIXELLATION_NONE_LABEL || visited[px]) {
+    }
+}
+
+void SLIC::resolveConnectedComponents(const pxind &endPx) {
+    pxind root = 0;
+    pxind componentLabel = SUPERPIXELLATION_NONE_LABEL;
+    for(; k < endPx; k += 1) {
+        root = findComponentRoot(k);
+        if(root == k) {
             // Start a new connected component
             componentLabel = nConnectedComponents;
             nConnectedComponents += 1;
-            pxind n = input->pixelCount();
-            for(; lastVisitedPixel < n; lastVisitedPixel += 1) {
-                if(!visited[lastVisitedPixel]) {
-                    px = lastVisitedPixel;
-                    break;
-                }
-            }
-#if SLIC_SELECT_LARGEST_COMPONENTS
-            connectedComponentHeap->add(SizeLabelsPair(clusterLabels[px], componentLabel));
-#endif //SLIC_SELECT_LARGEST_COMPONENTS
+            connectedComponentSizes[componentLabel] = 0;
+            connectedComponentClusters[componentLabel] = clusterLabels[k];
+        } else {
+            // The root precedes this pixel in raster order, so it already has a label
+            componentLabel = connectedComponentLabels[root];
         }
+        connectedComponentLabels[k] = componentLabel;
+        connectedComponentSizes[componentLabel] += 1;
+    }
+}
 
-        /* Add its neighbours to the queue of pixels to visit, if they are
-         * in the same connected component
-         */
-        clusterLabel = clusterLabels[px];
-        input->fourNeighbours(neighbours, nNeighbours, px);
-        for(pxind j = 0; j < nNeighbours; j += 1) {
-            pxNeighbour = neighbours[j];
-            if(clusterLabel == clusterLabels[pxNeighbour]) {
-                if(visited[pxNeighbour]) {
-                    componentLabel = connectedComponentLabels[pxNeighbour];
-                } else {
-                    unvisitedPixels->append(pxNeighbour);
-                }
-            }
-        }
+pxind SLIC::findComponentRoot(pxind px) {
+    while(componentParents[px] != px) {
+        componentParents[px] = componentParents[componentParents[px]];
+        px = componentParents[px];
+    }
+    return px;
+}
 
-        // Visit the pixel
-        visited[px] = true;
-        Q_ASSERT(componentLabel != SUPERPIXELLATION_NONE_LABEL);
-        connectedComponentLabels[px] = componentLabel;
-#if SLIC_SELECT_LARGEST_COMPONENTS
-        (*connectedComponentHeap)[componentLabel].size += 1;
-        connectedComponentHeap->increase(componentLabel);
-#endif //SLIC_SELECT_LARGEST_COMPONENTS
+void SLIC::uniteComponents(const pxind &px1, const pxind &px2) {
+    pxind root1 = findComponentRoot(px1);
+    pxind root2 = findComponentRoot(px2);
+    if(root1 < root2) {
+        componentParents[root2] = root1;
+    } else if(root2 < root1) {
+        componentParents[root1] = root2;
     }
 }
 
 void SLIC::classifyConnectedComponents(const pxind &endCluster) {
-#if SLIC_SELECT_LARGEST_COMPONENTS
-    SizeLabelsPair item;
-#else
+#if !SLIC_SELECT_LARGEST_COMPONENTS
     QPoint centerIntegerPosition;
     pxind px = 0;
-#endif //SLIC_SELECT_LARGEST_COMPONENTS
+#endif //!SLIC_SELECT_LARGEST_COMPONENTS
 
     for(;k < endCluster; k += 1) {
 #if SLIC_SELECT_LARGEST_COMPONENTS
-        while(item.cluster < k && connectedComponentHeap->size() > 0) {
-            item = connectedComponentHeap->remove();
-        }
-        if(item.cluster == k) {
-            connectedComponentClassifications[item.component] = true;
+        if(largestComponents[k] != SUPERPIXELLATION_NONE_LABEL) {
+            connectedComponentClassifications[largestComponents[k]] = true;
         }
 #else
         centerIntegerPosition = currentCenters[k].position.toPoint();
@@ -854,87 +1390,225 @@ void SLIC::classifyConnectedComponents(const pxind &endCluster) {
     }
 }
 
-void SLIC::reassignConnectedComponents(const pxind &endPx) {
-    pxind px = SUPERPIXELLATION_NONE_LABEL;
-    pxind pxNeighbour = 0;
-    pxind neighbours[4] = {0};
+#if SLIC_SELECT_LARGEST_COMPONENTS
+void SLIC::findLargestComponents(void) {
+    std::fill(largestComponents, largestComponents + kParam, SUPERPIXELLATION_NONE_LABEL);
+    pxind cluster = 0;
+    pxind largest = SUPERPIXELLATION_NONE_LABEL;
+    for(pxind i = 0; i < nConnectedComponents; i += 1) {
+        cluster = connectedComponentClusters[i];
+        largest = largestComponents[cluster];
+        if(largest == SUPERPIXELLATION_NONE_LABEL ||
+                connectedComponentSizes[i] > connectedComponentSizes[largest]) {
+            largestComponents[cluster] = i;
+        }
+    }
+}
+#endif //SLIC_SELECT_LARGEST_COMPONENTS
+
+void SLIC::dissolveSmallComponents(void) {
+    pxind minSize = static_cast<pxind>(SLIC_MIN_COMPONENT_SIZE_FRACTION * sSquared);
+    for(pxind i = 0; i < nConnectedComponents; i += 1) {
+        if(connectedComponentSizes[i] < minSize) {
+            connectedComponentClassifications[i] = false;
+        }
+    }
+}
+
+void SLIC::countComponentAdjacency(const pxind &endPx) {
+    pxind x = 0, y = 0;
+    pxind width = input->width();
+    pxind height = input->height();
+    pxind component = SUPERPIXELLATION_NONE_LABEL;
+    pxind neighbours[2] = {0};
     pxind nNeighbours = 0;
-    pxind nVisited = SUPERPIXELLATION_NONE_LABEL;
-    bool done = false;
+    pxind neighbourComponent = SUPERPIXELLATION_NONE_LABEL;
     for(; k < endPx; k += 1) {
-        /* Process pixels not in the same connected components
-         * as their cluster centers
-         */
-        if(!connectedComponentClassifications[connectedComponentLabels[k]]) {
+        input->kToXY(k, x, y);
+        component = connectedComponentLabels[k];
 
-            /* Initialize breadth-first search for nearest connected component
-             * containing a cluster center.
-             */
-            unvisitedPixels->clear();
-            unvisitedPixels->append(k);
-            done = false;
-
-            while(!done) {
-                if(!unvisitedPixels->isEmpty()) {
-                    do {
-                        px = unvisitedPixels->first();
-                        unvisitedPixels->removeFirst();
-                    } while(visited[px] && !unvisitedPixels->isEmpty());
+        // Each pair of adjacent pixels is visited once, from its left or upper pixel
+        nNeighbours = 0;
+        if(x < (width - 1)) {
+            neighbours[nNeighbours++] = k + 1;
+        }
+        if(y < (height - 1)) {
+            neighbours[nNeighbours++] = k + width;
+        }
+        for(pxind j = 0; j < nNeighbours; j += 1) {
+            neighbourComponent = connectedComponentLabels[neighbours[j]];
+            if(neighbourComponent != component) {
+                if(!connectedComponentClassifications[component]) {
+                    componentAdjacencyOffsets[component] += 1;
                 }
+                if(!connectedComponentClassifications[neighbourComponent]) {
+                    componentAdjacencyOffsets[neighbourComponent] += 1;
+                }
+            }
+        }
+    }
+}
 
-                // Add its neighbours to the queue of pixels to visit
-                input->fourNeighbours(neighbours, nNeighbours, px);
-                for(pxind j = 0; j < nNeighbours; j += 1) {
-                    pxNeighbour = neighbours[j];
-                    if(!visited[pxNeighbour]) {
-                        if(connectedComponentClassifications[connectedComponentLabels[pxNeighbour]]) {
-                            nPixelsPerCluster[clusterLabels[k]] -= 1;
-                            clusterLabels[k] = clusterLabels[pxNeighbour];
-                            nPixelsPerCluster[clusterLabels[k]] += 1;
-                            done = true;
-                            break;
-                        } else {
-                            unvisitedPixels->append(pxNeighbour);
-                        }
-                    }
+void SLIC::listComponentAdjacency(const pxind &endPx) {
+    pxind x = 0, y = 0;
+    pxind width = input->width();
+    pxind height = input->height();
+    pxind component = SUPERPIXELLATION_NONE_LABEL;
+    pxind neighbours[2] = {0};
+    pxind nNeighbours = 0;
+    pxind neighbourComponent = SUPERPIXELLATION_NONE_LABEL;
+    for(; k < endPx; k += 1) {
+        input->kToXY(k, x, y);
+        component = connectedComponentLabels[k];
+
+        nNeighbours = 0;
+        if(x < (width - 1)) {
+            neighbours[nNeighbours++] = k + 1;
+        }
+        if(y < (height - 1)) {
+            neighbours[nNeighbours++] = k + width;
+        }
+        for(pxind j = 0; j < nNeighbours; j += 1) {
+            neighbourComponent = connectedComponentLabels[neighbours[j]];
+            if(neighbourComponent != component) {
+                if(!connectedComponentClassifications[component]) {
+                    componentAdjacencyOffsets[component] -= 1;
+                    componentAdjacency[componentAdjacencyOffsets[component]] = neighbourComponent;
                 }
+                if(!connectedComponentClassifications[neighbourComponent]) {
+                    componentAdjacencyOffsets[neighbourComponent] -= 1;
+                    componentAdjacency[componentAdjacencyOffsets[neighbourComponent]] = component;
+                }
+            }
+        }
+    }
+}
+
+void SLIC::reassignConnectedComponents(const pxind &endComponent) {
+    pxind *neighbourStart = 0;
+    pxind *neighbourEnd = 0;
+    pxind *run = 0;
+    pxind runLength = 0;
+    pxind bestNeighbour = SUPERPIXELLATION_NONE_LABEL;
+    pxind bestRunLength = 0;
+    for(; k < endComponent; k += 1) {
+        if(connectedComponentClassifications[k]) {
+            componentReassignments[k] = k;
+            continue;
+        }
 
-                // Visit the pixel
-                visited[px] = true;
-                nVisited += 1;
-                visitedPx[nVisited] = px;
+        /* Group identical neighbours together. The number of times that a
+         * neighbour appears is the length of the boundary shared with it.
+         */
+        neighbourStart = componentAdjacency + componentAdjacencyOffsets[k];
+        neighbourEnd = componentAdjacency + componentAdjacencyOffsets[k + 1];
+        std::sort(neighbourStart, neighbourEnd);
+
+        bestNeighbour = SUPERPIXELLATION_NONE_LABEL;
+        bestRunLength = 0;
+        for(run = neighbourStart; run < neighbourEnd; run += runLength) {
+            runLength = std::upper_bound(run, neighbourEnd, *run) - run;
+            if(connectedComponentClassifications[*run] && runLength > bestRunLength) {
+                bestNeighbour = *run;
+                bestRunLength = runLength;
             }
+        }
+
+        componentReassignments[k] = bestNeighbour;
+        if(bestNeighbour != SUPERPIXELLATION_NONE_LABEL) {
+            componentQueue[componentQueueLength] = k;
+            componentQueueLength += 1;
+        }
+    }
+}
 
-            // Cleanup for the next iteration
-            for(; nVisited >= 0;nVisited -= 1) {
-                visited[visitedPx[nVisited]] = false;
+void SLIC::propagateComponentReassignment(void) {
+    // Breadth-first search through connected components flagged for dissolution
+    pxind component = SUPERPIXELLATION_NONE_LABEL;
+    pxind neighbour = SUPERPIXELLATION_NONE_LABEL;
+    pxind end = 0;
+    for(pxind i = 0; i < componentQueueLength; i += 1) {
+        component = componentQueue[i];
+        end = componentAdjacencyOffsets[component + 1];
+        for(pxind j = componentAdjacencyOffsets[component]; j < end; j += 1) {
+            neighbour = componentAdjacency[j];
+            if(componentReassignments[neighbour] == SUPERPIXELLATION_NONE_LABEL) {
+                componentReassignments[neighbour] = componentReassignments[component];
+                componentQueue[componentQueueLength] = neighbour;
+                componentQueueLength += 1;
             }
         }
     }
+
+    // Count the pixels remaining in each cluster
+    std::fill(nPixelsPerCluster, nPixelsPerCluster + kParam, 0);
+    for(pxind i = 0; i < nConnectedComponents; i += 1) {
+        if(componentReassignments[i] == SUPERPIXELLATION_NONE_LABEL) {
+            // Not connected to any preserved connected component
+            componentReassignments[i] = i;
+        }
+        nPixelsPerCluster[connectedComponentClusters[componentReassignments[i]]] += connectedComponentSizes[i];
+    }
+
+    // Remove empty clusters
+    pxind *clusterRelabelling = new pxind[kParam];
+    nSuperpixels = 0;
+    for(pxind i = 0; i < kParam; i += 1) {
+        if(nPixelsPerCluster[i] > 0) {
+            clusterRelabelling[i] = nSuperpixels;
+            nPixelsPerCluster[nSuperpixels] = nPixelsPerCluster[i];
+            nSuperpixels += 1;
+        } else {
+            clusterRelabelling[i] = SUPERPIXELLATION_NONE_LABEL;
+        }
+    }
+    for(pxind i = 0; i < nConnectedComponents; i += 1) {
+        componentReassignments[i] = clusterRelabelling[connectedComponentClusters[componentReassignments[i]]];
+    }
+    delete [] clusterRelabelling;
+}
+
+void SLIC::relabelPixels(const pxind &endPx) {
+    for(; k < endPx; k += 1) {
+        clusterLabels[k] = componentReassignments[connectedComponentLabels[k]];
+    }
 }
 
 void SLIC::sortPixelsIntoSuperpixels(const pxind &endPx) {
+    pxind x = 0, y = 0;
+    pxind width = input->width();
+    pxind height = input->height();
     pxind label = SUPERPIXELLATION_NONE_LABEL;
+    bool isBoundary = false;
     for(; k >= endPx; k -= 1) {
         label = clusterLabels[k];
         Q_ASSERT(label != SUPERPIXELLATION_NONE_LABEL);
-        pixelSortingOffsets[label] -= 1;
-        sortedPixels[pixelSortingOffsets[label]] = k;
+        input->kToXY(k, x, y);
+        isBoundary = (x == 0) || (y == 0) || (x == (width - 1)) || (y == (height - 1));
+        if(!isBoundary) {
+            isBoundary = (clusterLabels[k - 1] != label) || (clusterLabels[k + 1] != label) ||
+                    (clusterLabels[k - width] != label) || (clusterLabels[k + width] != label);
+        }
+        if(isBoundary) {
+            pixelSortingOffsets[label] -= 1;
+            sortedPixels[pixelSortingOffsets[label]] = k;
+        } else {
+            interiorSortingOffsets[label] -= 1;
+            sortedPixels[interiorSortingOffsets[label]] = k;
+        }
     }
 }
 
 void SLIC::createSuperpixels(const pxind &endCluster) {
-    pxind *superpixelPx = 0;
-    pxind nPx = 0;
     pxind startPx = 0;
-    pxind endPx = 0;
-    for(;k < endCluster; k += 1) {
-        nPx = nPixelsPerCluster[k];
+    for(; k < endCluster; k += 1) {
         startPx = pixelSortingOffsets[k];
-        endPx = startPx + nPx;
-        superpixelPx = new pxind[nPx];
-        std::copy(sortedPixels + startPx, sortedPixels + endPx, superpixelPx);
-        superpixels[k] = new Superpixel(k, superpixelPx, nPx, clusterLabels, *input);
+        superpixels[k] = new Superpixel(
+                    k,
+                    sortedPixels + startPx,
+                    pixelSortingOffsets[k + 1] - startPx,
+                    (*superpixelStatistics)[k]
+                );
     }
 }
 
@@ -957,7 +1631,7 @@ void SLIC::fillOutputImage(const pxind &endCluster) {
     for(; k < endCluster; k += 1) {
         superpixel = superpixels[k];
 #if SLIC_VISUALIZE_LABELS && !SLIC_VISUALIZE_CONNECTED_COMPONENT_LABELS
-        label = (static_cast<qreal>(superpixel->label()) * static_cast<qreal>(IMAGEDATA_RGB_RANGE)) / static_cast<qreal>(kParam);
+        label = (static_cast<qreal>(superpixel->label()) * static_cast<qreal>(IMAGEDATA_RGB_RANGE)) / static_cast<qreal>(nSuperpixels);
         if(label > IMAGEDATA_MAX_RGB) {
             labelGrey = IMAGEDATA_MAX_RGB;
         } else {
@@ -1027,6 +1701,10 @@ bool SLIC::initializeOutput(void) {
 
 void SLIC::cleanup(void) {
     finalizeOutput();
+    if(coarseLevel != 0) {
+        delete coarseLevel;
+        coarseLevel = 0;
+    }
     if(previousCenters != 0) {
         delete [] previousCenters;
         previousCenters = 0;
@@ -1051,42 +1729,66 @@ void SLIC::cleanup(void) {
         delete [] nPixelsPerCluster;
         nPixelsPerCluster = 0;
     }
+    if(componentParents != 0) {
+        delete [] componentParents;
+        componentParents = 0;
+    }
     if(connectedComponentLabels != 0) {
         delete [] connectedComponentLabels;
         connectedComponentLabels = 0;
     }
 #if SLIC_SELECT_LARGEST_COMPONENTS
-    if(connectedComponentHeap != 0) {
-        delete connectedComponentHeap;
-        connectedComponentHeap = 0;
+    if(largestComponents != 0) {
+        delete [] largestComponents;
+        largestComponents = 0;
     }
 #endif //SLIC_SELECT_LARGEST_COMPONENTS
     if(connectedComponentClassifications != 0) {
         delete [] connectedComponentClassifications;
         connectedComponentClassifications = 0;
     }
-    if(visited != 0) {
-        delete [] visited;
-        visited = 0;
+    if(connectedComponentSizes != 0) {
+        delete [] connectedComponentSizes;
+        connectedComponentSizes = 0;
+    }
+    if(connectedComponentClusters != 0) {
+        delete [] connectedComponentClusters;
+        connectedComponentClusters = 0;
     }
-    if(unvisitedPixels != 0) {
-        delete unvisitedPixels;
-        unvisitedPixels = 0;
+    if(componentAdjacencyOffsets != 0) {
+        delete [] componentAdjacencyOffsets;
+        componentAdjacencyOffsets = 0;
     }
-    if(visitedPx != 0) {
-        delete [] visitedPx;
-        visitedPx = 0;
+    if(componentAdjacency != 0) {
+        delete [] componentAdjacency;
+        componentAdjacency = 0;
+    }
+    if(componentReassignments != 0) {
+        delete [] componentReassignments;
+        componentReassignments = 0;
+    }
+    if(componentQueue != 0) {
+        delete [] componentQueue;
+        componentQueue = 0;
     }
     if(pixelSortingOffsets != 0) {
         delete [] pixelSortingOffsets;
         pixelSortingOffsets = 0;
     }
+    if(interiorSortingOffsets != 0) {
+        delete [] interiorSortingOffsets;
+        interiorSortingOffsets = 0;
+    }
     if(sortedPixels != 0) {
         delete [] sortedPixels;
         sortedPixels = 0;
     }
+    if(superpixelStatistics != 0) {
+        delete superpixelStatistics;
+        superpixelStatistics = 0;
+    }
     if(superpixels != 0) {
-        for(pxind i = 0; i < kParam; i += 1) {
+        for(pxind i = 0; i < nSuperpixels; i += 1) {
             if(superpixels[i] != 0) {
                 delete superpixels[i];
                 superpixels[i] = 0;
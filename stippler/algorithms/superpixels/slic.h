@@ -27,10 +27,8 @@
 */
 
 #include <QtGlobal>
-#include <QLinkedList>
 #include "imagedata.h"
 #include "algorithms/superpixels/isuperpixelgenerator.h"
-#include "ods/BinaryHeap.h"
 
 /*!
   \brief Choice of the post-processing method
@@ -71,6 +69,13 @@ public:
      */
     virtual bool increment(bool & finished, QString & status) Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Describe the algorithm and the values of all of its parameters
+     * \return A string identifying the algorithm and its parameters
+     * \see Algorithm::parameterSignature()
+     */
+    virtual QString parameterSignature(void) const Q_DECL_OVERRIDE;
+
     /*!
      * \brief Output superpixel data
      * \param [out] superpixellation A superpixellation of an image.
@@ -89,13 +94,24 @@ protected:
     enum class Progress : unsigned int {
         START,
         RGB2LAB,
+        DOWNSAMPLE_INPUT,
+        COARSE_KMEANS,
+        UPSAMPLE_CLUSTERS,
         SEED_CENTERS,
+        K_MEANS_RESET_LABELS,
         K_MEANS_LABEL_PIXELS,
         K_MEANS_UPDATE_CENTERS,
         K_MEANS_ASSESS_ITERATION,
         FIND_CONNECTED_COMPONENTS,
+        MERGE_CONNECTED_COMPONENT_STRIPS,
+        RESOLVE_CONNECTED_COMPONENTS,
         CLASSIFY_CONNECTED_COMPONENTS,
+        COUNT_COMPONENT_ADJACENCY,
+        LIST_COMPONENT_ADJACENCY,
         REASSIGN_CONNECTED_COMPONENTS,
+        PROPAGATE_COMPONENT_REASSIGNMENT,
+        RELABEL_PIXELS,
+        COMPUTE_SUPERPIXEL_STATISTICS,
         SORT_PIXELS_AS_SUPERPIXELS,
         CREATE_SUPERPIXEL_OBJECTS,
         INITIALIZE_OUTPUT,
@@ -128,7 +144,7 @@ protected:
      *
      * This function also contains the logic for deciding when to stop K-Means
      * iteration. K-Means iteration ends when either:
-     * - The maximum number of iterations, #SLIC_MAX_KMEANS_ITERATIONS, is reached, or
+     * - The maximum number of iterations, SLIC::maxIterations, is reached, or
      * - When the fractional difference between the changes in cluster center
      *   positions during the current and previous iteration drops below #SLIC_ERROR_THRESHOLD.
      *   - With this criteria, there is no need to set an absolute threshold
@@ -137,6 +153,11 @@ protected:
      *   - In a sense, the second derivative of cluster center positions
      *     which is being compared with #SLIC_ERROR_THRESHOLD.
      *
+     * If K-Means iteration was carried out on a coarser level of the image
+     * pyramid (see initializeCoarseLevel() ), the first iteration at full
+     * resolution starts by recomputing cluster centers from the upsampled
+     * cluster labels, rather than by labelling pixels.
+     *
      * \return The final value that should be reached by SLIC::k
      * during the current processing increment
      * \see getLoopLimit()
@@ -152,6 +173,68 @@ protected:
      */
     pxind getLoopLimit(void) const;
 
+    /*!
+     * \brief The name of a stage of processing, under which it is
+     * recorded in the AlgorithmProfile
+     * \param [in] p The stage of processing
+     * \return The name of the enumeration constant
+     */
+    static const char *progressName(const Progress &p);
+
+    /*!
+     * \brief Compute the dimensions of the grid used to seed cluster centers
+     *
+     * A helper function for initializeCenters() and initializeSearchWindow().
+     * See initializeCenters() for a description of the grid.
+     * \param [out] widthInS The number of grid squares in the horizontal direction
+     * \param [out] widthConversion The width of a grid square, after scaling
+     * the grid to fit within the input image
+     * \param [out] heightConversion The height of a grid square, after scaling
+     * the grid to fit within the input image
+     * \param [out] kConversion The ratio of the number of grid squares to SLIC::kParam
+     */
+    void seedingGrid(pxind &widthInS, qreal &widthConversion, qreal &heightConversion, qreal &kConversion) const;
+
+    /*!
+     * \brief Determine the dimensions of the search window around a cluster
+     * center, and allocate SLIC::clusterSearchWindow
+     *
+     * The search window dimensions are chosen such that all pixels will be
+     * labelled, given cluster centers seeded by initializeCenters().
+     * \see SLIC::searchHalfWidth
+     * \see SLIC::searchHalfHeight
+     * \see #SLIC_MIN_SEARCH_WINDOW_SIZE
+     */
+    void initializeSearchWindow(void);
+
+    /*!
+     * \brief Set up K-Means iteration on a reduced-size copy of the input image
+     *
+     * If the input image is large enough, according to #SLIC_MULTISCALE_MIN_PIXELS
+     * and #SLIC_MULTISCALE_MIN_S, a copy of the CIE L*a*b* colour channels is
+     * downsampled by a factor of #SLIC_MULTISCALE_FACTOR, and assigned to a
+     * new instance of this class, SLIC::coarseLevel. The new instance stops
+     * after K-Means iteration, and may itself use a coarser level. Therefore,
+     * K-Means iteration starts at the top of an image pyramid.
+     *
+     * The K-Means clusters are transferred to this object by upsampleClusters(),
+     * after which only #SLIC_MULTISCALE_REFINEMENT_ITERATIONS iterations are
+     * performed at full resolution.
+     * \return Success (true) or failure (false)
+     */
+    bool initializeCoarseLevel(void);
+
+    /*!
+     * \brief Transfer K-Means clusters from SLIC::coarseLevel to this object
+     *
+     * Each pixel is given the cluster label of the corresponding pixel in the
+     * downsampled image. Cluster centers are scaled to full resolution
+     * and stored in SLIC::previousCenters, so that the first full-resolution
+     * K-Means iteration can measure how far they move.
+     * \param [in] endPx The pixel index at which to end processing
+     */
+    void upsampleClusters(const pxind &endPx);
+
     /*!
      * \brief Find initial positions for the K-means clusters
      *
@@ -181,9 +264,7 @@ protected:
      *
      * \param [in] endCluster The cluster index at which to end processing
      * during the current increment
-     * \see SLIC::searchHalfWidth
-     * \see SLIC::searchHalfHeight
-     * \see #SLIC_MIN_SEARCH_WINDOW_SIZE
+     * \see initializeSearchWindow()
      */
     void initializeCenters(const pxind &endCluster);
 
@@ -236,13 +317,75 @@ protected:
      * a connected components algorithm is used to find groups of connected
      * pixels corresponding to each cluster.
      *
-     * I used breadth-first search to find connected components.
+     * This function is the first pass of a two-pass raster scan connected
+     * components algorithm, using a union-find data structure
+     * (SLIC::componentParents). Each pixel is merged with its left and upper
+     * neighbours, if they belong to the same cluster. The image is divided
+     * into horizontal strips of #SLIC_CONNECTED_COMPONENTS_STRIP_HEIGHT rows,
+     * which are labelled independently of each other, and are joined afterwards
+     * by mergeConnectedComponentStrips(). The strips in the current processing
+     * increment are therefore divided among threads by TaskScheduler::parallelFor(),
+     * and each range of strips is processed by labelStripRange().
+     *
+     * The second pass is performed by resolveConnectedComponents().
+     * \param [in] endStrip The index of the image strip at which to end processing
+     */
+    void labelConnectedComponents(const pxind &endStrip);
+
+    /*!
+     * \brief Label the pixels of a range of image strips
+     *
+     * A helper function for labelConnectedComponents(), which can be run
+     * concurrently on disjoint ranges of strips, as the union-find trees
+     * built within a strip only contain pixels of that strip.
+     * \param [in] startStrip The first strip in the range
+     * \param [in] endStrip The strip index bounding the range
+     */
+    void labelStripRange(const pxind startStrip, const pxind endStrip);
+
+    /*!
+     * \brief Join connected components across the boundaries between the
+     * image strips processed by labelConnectedComponents()
+     * \param [in] endBoundary The index of the strip boundary at which to end processing.
+     * The boundary with index `i` is the top row of strip `i + 1`.
+     */
+    void mergeConnectedComponentStrips(const pxind &endBoundary);
+
+    /*!
+     * \brief Assign consecutive connected component labels to pixels
+     *
+     * This is the second pass of the connected components algorithm started
+     * by labelConnectedComponents(). Each pixel is given the label of the root
+     * of its tree in the union-find data structure. As the root is the first
+     * pixel of its tree in raster order, labels are assigned in a single
+     * forward pass.
      *
-     * If #SLIC_SELECT_LARGEST_COMPONENTS is true, then connected component sizes
-     * are calculated as well.
+     * The size and K-Means cluster of each connected component are recorded
+     * as well.
      * \param [in] endPx The pixel index at which to end processing
      */
-    void labelConnectedComponents(const pxind &endPx);
+    void resolveConnectedComponents(const pxind &endPx);
+
+    /*!
+     * \brief Find the root of a pixel's tree in the union-find data structure
+     *
+     * Path halving is used to shorten the path from the pixel to the root.
+     * \param [in] px The pixel index
+     * \return The index of the root pixel, which is the first pixel of the
+     * connected component in raster order
+     */
+    pxind findComponentRoot(pxind px);
+
+    /*!
+     * \brief Merge the trees of two pixels in the union-find data structure
+     *
+     * The root with the larger pixel index is attached to the root with the
+     * smaller pixel index, so that the root of a tree is always its
+     * first pixel in raster order.
+     * \param [in] px1 The first pixel index
+     * \param [in] px2 The second pixel index
+     */
+    void uniteComponents(const pxind &px1, const pxind &px2);
 
     /*!
      * \brief Identify connected components as to be kept or discarded.
@@ -255,32 +398,110 @@ protected:
      */
     void classifyConnectedComponents(const pxind &endCluster);
 
+#if SLIC_SELECT_LARGEST_COMPONENTS
+    /*!
+     * \brief Find the largest connected component in each K-Means cluster
+     *
+     * A single linear pass is made over the connected component sizes
+     * computed by resolveConnectedComponents(). In case of a tie, the first
+     * connected component in raster order is selected.
+     *
+     * Clusters which do not contain any pixels are assigned
+     * #SUPERPIXELLATION_NONE_LABEL.
+     */
+    void findLargestComponents(void);
+#endif //SLIC_SELECT_LARGEST_COMPONENTS
+
+    /*!
+     * \brief Flag connected components that are too small to be kept
+     *
+     * Connected components with fewer pixels than #SLIC_MIN_COMPONENT_SIZE_FRACTION
+     * times the square of SLIC::S are flagged for dissolution, regardless of
+     * the result of classifyConnectedComponents(const pxind &).
+     * This is similar to the connectivity enforcement step of the reference
+     * implementation of SLIC.
+     */
+    void dissolveSmallComponents(void);
+
+    /*!
+     * \brief Count the pixel adjacencies between connected components
+     *
+     * The first of two passes which build a list of neighbouring connected
+     * components for each connected component flagged for dissolution.
+     * Every pair of 4-connected pixels in different connected components is
+     * counted once for each connected component that is flagged for dissolution.
+     * \param [in] endPx The pixel index at which to end processing
+     * \see listComponentAdjacency()
+     */
+    void countComponentAdjacency(const pxind &endPx);
+
+    /*!
+     * \brief Record the pixel adjacencies between connected components
+     *
+     * The second of two passes which build a list of neighbouring connected
+     * components for each connected component flagged for dissolution,
+     * stored in SLIC::componentAdjacency. A neighbouring
+     * connected component appears once for each pair of adjacent pixels
+     * on the boundary between the two connected components.
+     * \param [in] endPx The pixel index at which to end processing
+     * \see countComponentAdjacency()
+     */
+    void listComponentAdjacency(const pxind &endPx);
+
     /*!
-     * \brief Remove connected components flagged for dissolution
+     * \brief Choose connected components into which to merge the connected
+     * components flagged for dissolution
+     *
+     * Connected components that are to be discarded, as determined by classifyConnectedComponents(const pxind &)
+     * and dissolveSmallComponents(), are merged with the adjacent connected
+     * component that will be preserved and which has the longest shared boundary
+     * with them. Connected components which are not adjacent to any preserved
+     * connected components are handled by propagateComponentReassignment().
      *
-     * Connected components that are to be discarded, as determined by classifyConnectedComponents(const pxind &),
-     * have their pixels reassigned to adjacent connected components
-     * that will be preserved.
+     * Dr. David Mould also assigns all pixels of a connected component
+     * to an adjacent connected component, whereas my original approach
+     * reassigned each pixel independently to the nearest connected component
+     * using breadth-first search, which took quadratic time in the size
+     * of the connected components being reassigned.
+     * \param [in] endComponent The connected component index at which to end processing
+     */
+    void reassignConnectedComponents(const pxind &endComponent);
+
+    /*!
+     * \brief Finish choosing connected components into which to merge the
+     * connected components flagged for dissolution, and update cluster sizes
      *
-     * As such, this function updates the K-Means cluster labelling of pixels
-     * (SLIC::clusterLabels), as well as the sizes of clusters (SLIC::nPixelsPerCluster).
+     * Connected components flagged for dissolution that are only adjacent
+     * to other connected components flagged for dissolution are merged
+     * with the same preserved connected components as their neighbours,
+     * by breadth-first search outwards from the connected components handled
+     * by reassignConnectedComponents(const pxind &). Any remaining connected
+     * components (which are not connected to preserved connected components)
+     * are preserved.
      *
-     * A given pixel is assigned to the nearest adjacent connected component,
-     * as determined using breadth-first search. Note that this is probably
-     * not how most people implement SLIC. For instance, Dr. David Mould assigns
-     * all pixels to the largest adjacent connected component. As such, connected
-     * components are not split apart when merged into their neighbours,
-     * unlike my approach, which treats each pixel independently.
+     * K-Means clusters left without any pixels are removed, and the remaining
+     * clusters are relabelled consecutively. As such, this function updates
+     * SLIC::nSuperpixels, as well as the sizes of clusters (SLIC::nPixelsPerCluster).
+     */
+    void propagateComponentReassignment(void);
+
+    /*!
+     * \brief Update the K-Means cluster labelling of pixels (SLIC::clusterLabels)
+     * to reflect the merging of connected components
      * \param [in] endPx The pixel index at which to end processing
      */
-    void reassignConnectedComponents(const pxind &endPx);
+    void relabelPixels(const pxind &endPx);
 
     /*!
      * \brief Organize pixels according to their cluster labels
      *
      * This is a pre-processing step prior to createSuperpixels(const pxind &).
      *
-     * Pixels are sorted by cluster label using counting sort.
+     * Pixels are sorted by cluster label using counting sort. Each pixel
+     * is also classified as a boundary or interior pixel of its cluster,
+     * and placed in the corresponding sub-range of its cluster's range,
+     * whose sizes are known from SLIC::superpixelStatistics. Superpixel
+     * objects can therefore be created without examining their pixels again.
      * \param [in] endPx The pixel index at which to end processing
      */
     void sortPixelsIntoSuperpixels(const pxind &endPx);
@@ -289,8 +510,13 @@ protected:
      * \brief Create Superpixel objects to represent clusters
      *
      * This function populates the SLIC::superpixels array, which is the
-     * non-graphical output of the SLIC algorithm.
+     * non-graphical output of the SLIC algorithm. The Superpixel objects
+     * are views onto the ranges of SLIC::sortedPixels belonging to each cluster.
+     *
+     * Each Superpixel object is created in constant time, so the objects
+     * are created serially, in order of cluster index.
      * \param [in] endCluster The cluster index at which to end processing
+     * \see #SLIC_SUPERPIXEL_CREATION_GRANULARITY
      */
     void createSuperpixels(const pxind &endCluster);
 
@@ -453,101 +679,49 @@ protected:
      */
     pxind *nPixelsPerCluster;
     /*!
-     * \brief An array storing the connected component identifiers of each pixel
+     * \brief The union-find data structure used to find connected components
      *
+     * An array storing the index of the parent pixel of each pixel. Root pixels
+     * are their own parents.
      * \see labelConnectedComponents()
      */
+    pxind *componentParents;
+    /*!
+     * \brief An array storing the connected component identifiers of each pixel
+     *
+     * \see resolveConnectedComponents()
+     */
     pxind *connectedComponentLabels;
     /*!
      * \brief The number of connected components, which is greater than or equal
      * to the number of K-Means clusters
      *
-     * \see labelConnectedComponents()
+     * \see resolveConnectedComponents()
      */
     pxind nConnectedComponents;
+    /*!
+     * \brief An array storing the number of pixels in each connected component
+     *
+     * \see resolveConnectedComponents()
+     */
+    pxind *connectedComponentSizes;
+    /*!
+     * \brief An array storing the K-Means cluster label of each connected component
+     *
+     * \see resolveConnectedComponents()
+     */
+    pxind *connectedComponentClusters;
 
 #if SLIC_SELECT_LARGEST_COMPONENTS
     /*!
-     * \brief The association of a connected component with its size in pixels,
-     * and its corresponding K-Means cluster.
-     *
-     * This class is needed if #SLIC_SELECT_LARGEST_COMPONENTS is set, in which
-     * case labelConnectedComponents() computes connected component sizes.
-     */
-    struct SizeLabelsPair {
-        /*!
-         * \brief The number of pixels in the connected component
-         */
-        pxind size;
-        /*!
-         * \brief The K-Means cluster whose pixels are a superset of those
-         * in this connected component
-         */
-        pxind cluster;
-        /*!
-         * \brief The identifier of the connected component
-         */
-        pxind component;
-
-        /*!
-         * \brief Construct an empty instance
-         */
-        SizeLabelsPair(void) :
-            size(0), cluster(SUPERPIXELLATION_NONE_LABEL), component(SUPERPIXELLATION_NONE_LABEL)
-        {}
-
-        /*!
-         * \brief Construct an instance with initial data
-         *
-         * The size of the connected component is assumed to be unknown at the time.
-         * \param [in] clusterLabel The identifier of the K-Means cluster containing
-         * this connected component
-         * \param [in] componentLabel The identifier of this connected component
-         */
-        SizeLabelsPair(const pxind& clusterLabel, const pxind& componentLabel) :
-            size(0), cluster(clusterLabel), component(componentLabel)
-        {}
-
-        /*!
-         * \brief Compare connected component sizes and cluster identifiers
-         *
-         * In a max-heap, SizeLabelsPair objects will be in descending order
-         * by cluster identifier, and in ascending order by size.
-         * \param [in] rhs The other connected component
-         * \return A comparison result to be used for sorting SizeLabelsPair objects
-         */
-        bool operator<(SizeLabelsPair const & rhs) const
-        {
-            if(cluster < rhs.cluster) {
-                return false;
-            } else if(cluster > rhs.cluster) {
-                return true;
-            } else { // cluster == rhs.cluster
-                return (size < rhs.size);
-            }
-        }
-
-        /*!
-         * \brief Assignment operator
-         * \param [in] rhs The other instance
-         * \return A reference to this instance
-         */
-        SizeLabelsPair& operator=(const SizeLabelsPair &rhs) {
-            size = rhs.size;
-            cluster = rhs.cluster;
-            component = rhs.component;
-            return *this;
-        }
-    };
-    /*!
-     * \brief A max-heap used to determine which connected components are
-     * the largest connected components in their corresponding K-Means clusters.
+     * \brief An array storing the largest connected component in each
+     * K-Means cluster
      *
      * This member is needed if #SLIC_SELECT_LARGEST_COMPONENTS is set.
-     * It is produced by labelConnectedComponents() and consumed by
+     * It is produced by findLargestComponents() and consumed by
      * classifyConnectedComponents().
      */
-    ods::BinaryHeap<SizeLabelsPair, pxind>* connectedComponentHeap;
+    pxind *largestComponents;
 
 #endif //SLIC_SELECT_LARGEST_COMPONENTS
 
@@ -560,51 +734,129 @@ protected:
     bool *connectedComponentClassifications;
 
     /*!
-     * \brief An array storing the visited/not yet visited status of pixels
+     * \brief The offsets of the lists of neighbouring connected components
+     * in SLIC::componentAdjacency
      *
-     * Used in the breadth-first search routines in the post-processing
-     * stages of SLIC.
+     * The neighbours of connected component `i` are stored from index
+     * `componentAdjacencyOffsets[i]` up to, but not including, index
+     * `componentAdjacencyOffsets[i + 1]`. Only the connected components flagged
+     * for dissolution have neighbours listed.
+     * \see countComponentAdjacency()
      */
-    bool *visited;
+    pxind *componentAdjacencyOffsets;
     /*!
-     * \brief The queue of pixels to be visited
+     * \brief The neighbouring connected components of connected components
+     * flagged for dissolution
      *
-     * Used in the breadth-first search routines in the post-processing
-     * stages of SLIC.
+     * \see listComponentAdjacency()
      */
-    QLinkedList<pxind> *unvisitedPixels;
+    pxind *componentAdjacency;
     /*!
-     * \brief One greater than the index of the most recently visited pixel
+     * \brief The result of merging connected components
      *
-     * Updated and used by labelConnectedComponents()
+     * Before propagateComponentReassignment() finishes, an array storing the
+     * connected component into which each connected component is merged
+     * (or #SUPERPIXELLATION_NONE_LABEL if not yet determined). Preserved connected
+     * components are merged into themselves.
+     *
+     * Afterwards, an array storing the final cluster label of each connected
+     * component.
+     */
+    pxind *componentReassignments;
+    /*!
+     * \brief The queue of connected components used for breadth-first search
+     * by propagateComponentReassignment()
+     */
+    pxind *componentQueue;
+    /*!
+     * \brief The number of connected components added to SLIC::componentQueue
+     * by reassignConnectedComponents()
      */
-    pxind lastVisitedPixel;
+    pxind componentQueueLength;
     /*!
-     * \brief An array storing the indices of pixels which have been visited
-     * during breadth-first search
+     * \brief The number of superpixels produced
      *
-     * Updated and used by reassignConnectedComponents()
+     * This is at most SLIC::kParam, as clusters which lose all of their pixels
+     * during post-processing are removed.
      */
-    pxind *visitedPx;
+    pxind nSuperpixels;
 
     /*!
      * \brief An auxiliary variable used in counting sort, within sortPixelsIntoSuperpixels()
+     *
+     * After sorting, element `i` is the start of the range of cluster `i`
+     * in SLIC::sortedPixels, and element SLIC::nSuperpixels is the number of pixels.
+     * Ownership is transferred to the output Superpixellation as
+     * Superpixellation::superpixelOffsets.
      */
     pxind *pixelSortingOffsets;
 
+    /*!
+     * \brief The counterpart of SLIC::pixelSortingOffsets for interior pixels,
+     * used within sortPixelsIntoSuperpixels()
+     *
+     * Element `i` is initially the end of the range of cluster `i`
+     * in SLIC::sortedPixels, and is decremented as interior pixels are added.
+     * (SLIC::pixelSortingOffsets is initially the end of the boundary pixels.)
+     */
+    pxind *interiorSortingOffsets;
+
     /*!
      * \brief An array storing pixel indices sorted by their corresponding
      * superpixel identifiers
      *
-     * Produced by sortPixelsIntoSuperpixels() and consumed by createSuperpixels()
+     * Produced by sortPixelsIntoSuperpixels(), which places the boundary pixels
+     * of each superpixel before its interior pixels. Ownership is transferred to the
+     * output Superpixellation as Superpixellation::superpixelPixels.
      */
     pxind *sortedPixels;
 
+    /*!
+     * \brief The statistics of the pixels in each superpixel, from which
+     * the characteristics of the objects in SLIC::superpixels are derived
+     *
+     * Ownership is transferred to the output Superpixellation.
+     */
+    SuperpixelStatistics *superpixelStatistics;
+
     /*!
      * \brief The output of the SLIC algorithm
      */
     Superpixellation::Superpixel **superpixels;
 
+    /*!
+     * \brief The instance of this class performing K-Means iteration on the
+     * next coarser level of the image pyramid
+     *
+     * Only present between the creation of the downsampled image and the
+     * transfer of its K-Means clusters to this object.
+     * \see initializeCoarseLevel()
+     */
+    SLIC *coarseLevel;
+
+    /*!
+     * \brief Whether or not K-Means iteration was started on a coarser level
+     * of the image pyramid
+     */
+    bool isMultiscale;
+
+    /*!
+     * \brief If true, processing ends after K-Means iteration
+     *
+     * This is set for instances of this class that operate on the coarser
+     * levels of an image pyramid, as they do not need to produce superpixels.
+     */
+    bool kmeansOnly;
+
+    /*!
+     * \brief The maximum number of K-Means iterations
+     *
+     * Either #SLIC_MAX_KMEANS_ITERATIONS, or one more than
+     * #SLIC_MULTISCALE_REFINEMENT_ITERATIONS if K-Means iteration was started on
+     * a coarser level of the image pyramid.
+     */
+    pxind maxIterations;
+
     // Processing state variables
     /*!
      * \brief The algorithm's current stage of processing
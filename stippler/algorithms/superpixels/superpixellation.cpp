@@ -14,153 +14,22 @@
 */
 
 #include <math.h>
+#include <algorithm>
 #include "superpixellation.h"
 
 Superpixellation::Superpixel::Superpixel(const pxind &l,
-        pxind *&allPixels,
+        const pxind * const allPixels,
         const pxind nPx,
-        const pxind * const labels,
-        ImageData &img
+        const SuperpixelStatistics::Statistics &s
     ) :
     id(l),
-    center(),
-    centerRGB(0),
+    statistics(&s),
     allPx(allPixels),
-    nInteriorPixels(0),
-    nBoundaryPixels(0),
-    nPixels(nPx),
-    stdDevColor(0.0),
-    stdDevColorChannels()
+    nInteriorPixels(nPx - s.boundaryCount),
+    nBoundaryPixels(s.boundaryCount),
+    nPixels(nPx)
 {
-    allPixels = 0; // Transfer ownership
-
-    // Compute superpixel center and boundary/interior pixel classifications
-    pxind xc = 0, yc = 0, xi = 0, yi = 0;
-    qreal lc = 0.0, ac = 0.0, bc = 0.0;
-    qreal redC = 0, greenC = 0, blueC = 0;
-    const qreal *lChannel = img.lStar();
-    const qreal *aChannel = img.aStar();
-    const qreal *bChannel = img.bStar();
-    const uchar *redChannel = img.red();
-    const uchar *greenChannel = img.green();
-    const uchar *blueChannel = img.blue();
-
-    bool *isBoundary = new bool[nPixels];
-    std::fill(isBoundary, isBoundary + nPixels, false);
-    pxind neighbours[4] = {0};
-    pxind nNeighbours = 0;
-    pxind px = 0;
-    pxind label = SUPERPIXELLATION_NONE_LABEL;
-    for(pxind i = 0; i < nPixels; i += 1) {
-        px = allPx[i];
-        img.kToXY(px, xi, yi);
-        xc += xi;
-        yc += yi;
-        lc += lChannel[px];
-        ac += aChannel[px];
-        bc += bChannel[px];
-        redC += static_cast<qreal>(redChannel[px]);
-        greenC += static_cast<qreal>(greenChannel[px]);
-        blueC += static_cast<qreal>(blueChannel[px]);
-        img.fourNeighbours(neighbours, nNeighbours, px);
-        if( nNeighbours < 4 ) {
-            isBoundary[i] = true;
-            nBoundaryPixels += 1;
-        } else {
-            label = labels[px];
-            for(pxind j = 0; j < 4; j += 1) {
-                if(label != labels[neighbours[j]]) {
-                    isBoundary[i] = true;
-                    nBoundaryPixels += 1;
-                    break;
-                }
-            }
-        }
-    }
-    xc = round(static_cast<qreal>(xc) / static_cast<qreal>(nPixels));
-    if(xc < 0) xc = 0;
-    if(xc >= img.width()) xc = img.width();
-    yc = round(static_cast<qreal>(yc) / static_cast<qreal>(nPixels));
-    if(yc < 0) yc = 0;
-    if(yc >= img.height()) yc = img.height();
-    center.position.setX(xc);
-    center.position.setY(yc);
-    lc /= static_cast<qreal>(nPixels);
-    ac /= static_cast<qreal>(nPixels);
-    bc /= static_cast<qreal>(nPixels);
-    center.color.setX(lc);
-    center.color.setY(ac);
-    center.color.setZ(bc);
-
-    redC /= static_cast<qreal>(nPixels);
-    if(redC > IMAGEDATA_MAX_RGB) {
-        redC = IMAGEDATA_MAX_RGB;
-    } else {
-        redC = floor(redC);
-    }
-    greenC /= static_cast<qreal>(nPixels);
-    if(greenC > IMAGEDATA_MAX_RGB) {
-        greenC = IMAGEDATA_MAX_RGB;
-    } else {
-        greenC = floor(greenC);
-    }
-    blueC /= static_cast<qreal>(nPixels);
-    if(blueC > IMAGEDATA_MAX_RGB) {
-        blueC = IMAGEDATA_MAX_RGB;
-    } else {
-        blueC = floor(blueC);
-    }
-    centerRGB = qRgb(static_cast<int>(redC), static_cast<int>(greenC), static_cast<int>(blueC));
-
-    // Arrange pixels into interior and boundary pixel sub-arrays
-    nInteriorPixels = nPixels - nBoundaryPixels;
-    pxind *orderedPixels = new pxind[nPixels];
-    pxind *boundaryPointer = orderedPixels;
-    pxind *interiorPointer = orderedPixels + nBoundaryPixels;
-    for(pxind i = 0; i < nPixels; i += 1) {
-        if(isBoundary[i]) {
-            *boundaryPointer = allPx[i];
-            boundaryPointer++;
-        } else {
-            *interiorPointer = allPx[i];
-            interiorPointer++;
-        }
-    }
-    delete [] isBoundary;
-    isBoundary = 0;
-    delete [] allPx;
-    allPx = orderedPixels;
-    orderedPixels = 0;
-
-    // Calculate the standard deviation of colour
-    if( nPixels > 1 ) { // Avoid division by zero
-        qreal dli = 0.0, dai = 0.0, dbi = 0.0;
-        qreal dlSum = 0.0, daSum = 0.0, dbSum = 0.0;
-        for(pxind i = 0; i < nPixels; i += 1) {
-            px = allPx[i];
-            dli = lc - lChannel[px];
-            dli *= dli;
-            dlSum += dli;
-            dai = ac - aChannel[px];
-            dai *= dai;
-            daSum += dai;
-            dbi = bc - bChannel[px];
-            dbi *= dbi;
-            dbSum += dbi;
-            stdDevColor += dli + dai + dbi;
-        }
-        stdDevColor = sqrt(stdDevColor / (nPixels - 1));
-        stdDevColorChannels.setX(sqrt(dlSum / (nPixels-1)));
-        stdDevColorChannels.setY(sqrt(daSum / (nPixels-1)));
-        stdDevColorChannels.setZ(sqrt(dbSum / (nPixels-1)));
-    }
-}
-
-Superpixellation::Superpixel::~Superpixel() {
-    if(allPx != 0) {
-        delete [] allPx;
-        allPx = 0;
-    }
+    Q_ASSERT(statistics->count == nPixels);
 }
 
 pxind Superpixellation::Superpixel::label(void) const {
@@ -168,15 +37,34 @@ pxind Superpixellation::Superpixel::label(void) const {
 }
 
 void Superpixellation::Superpixel::centerPosition(QPoint& p) const {
-    p = center.position;
+    p.setX(static_cast<int>(round(
+            static_cast<qreal>(statistics->sumXY[0]) / static_cast<qreal>(statistics->count)
+        )));
+    p.setY(static_cast<int>(round(
+            static_cast<qreal>(statistics->sumXY[1]) / static_cast<qreal>(statistics->count)
+        )));
 }
 
 void Superpixellation::Superpixel::centerColor(QVector3D& c) const {
-    c = center.color;
+    c.setX(statistics->meanLab[0]);
+    c.setY(statistics->meanLab[1]);
+    c.setZ(statistics->meanLab[2]);
+}
+
+void Superpixellation::Superpixel::boundingBox(QRect& r) const {
+    statistics->boundingBox(r);
 }
 
 void Superpixellation::Superpixel::centerColorRGB(QRgb& c) const {
-    c = centerRGB;
+    // Integer division rounds down, as channel sums are non-negative
+    qint64 rgb[3] = {0};
+    for(int j = 0; j < 3; j += 1) {
+        rgb[j] = statistics->sumRGB[j] / statistics->count;
+        if(rgb[j] > IMAGEDATA_MAX_RGB) {
+            rgb[j] = IMAGEDATA_MAX_RGB;
+        }
+    }
+    c = qRgb(static_cast<int>(rgb[0]), static_cast<int>(rgb[1]), static_cast<int>(rgb[2]));
 }
 
 qreal Superpixellation::Superpixel::size(void) const {
@@ -188,11 +76,22 @@ qreal Superpixellation::Superpixel::areaToPerimeterRatio(void) const {
 }
 
 void Superpixellation::Superpixel::standardColorDeviation(qreal &s) const {
-    s = stdDevColor;
+    s = 0.0;
+    if( nPixels > 1 ) { // Avoid division by zero
+        s = sqrt(
+                (statistics->m2Lab[0] + statistics->m2Lab[1] + statistics->m2Lab[2]) /
+                static_cast<qreal>(nPixels - 1)
+            );
+    }
 }
 
 void Superpixellation::Superpixel::standardColorDeviation(QVector3D &s) const {
-    s = stdDevColorChannels;
+    s = QVector3D();
+    if( nPixels > 1 ) { // Avoid division by zero
+        s.setX(sqrt(statistics->m2Lab[0] / static_cast<qreal>(nPixels - 1)));
+        s.setY(sqrt(statistics->m2Lab[1] / static_cast<qreal>(nPixels - 1)));
+        s.setZ(sqrt(statistics->m2Lab[2] / static_cast<qreal>(nPixels - 1)));
+    }
 }
 
 void Superpixellation::Superpixel::interiorPixels(const pxind*& px, pxind& n) const {
@@ -213,20 +112,71 @@ void Superpixellation::Superpixel::allPixels(const pxind*& px, pxind& n) const {
 Superpixellation::Superpixellation(
         ImageData *& i,
         pxind *&sLabels,
+        pxind *&sPixels,
+        pxind *&sOffsets,
+        SuperpixelStatistics *&stats,
         Superpixel **&s,
         const pxind& n,
         const bool sI) :
     superpixels(s),
     img(i),
     superpixelLabels(sLabels),
+    superpixelPixels(sPixels),
+    superpixelOffsets(sOffsets),
+    statistics(stats),
+#if SUPERPIXELLATION_BUILD_ADJACENCY_GRAPH
+    adjacency(new RegionAdjacencyGraph(*i, sLabels, *stats)),
+#else
+    adjacency(0),
+#endif //SUPERPIXELLATION_BUILD_ADJACENCY_GRAPH
+    spatialIndex(new SuperpixelSpatialIndex(i->width(), i->height(), sLabels, *stats)),
     nSuperpixels(n),
     shareImage(sI),
-    shareAll(false)
+    shareAll(false),
+    storage(0)
 {
     if(!shareImage) {
         i = 0;
     }
     sLabels = 0;
+    sPixels = 0;
+    sOffsets = 0;
+    stats = 0;
+    s = 0;
+}
+
+Superpixellation::Superpixellation(
+        ImageData *& i,
+        QFile *& file,
+        const pxind * const sLabels,
+        const pxind * const sPixels,
+        const pxind * const sOffsets,
+        SuperpixelStatistics *&stats,
+        Superpixel **&s,
+        const pxind& n,
+        const bool sI) :
+    superpixels(s),
+    img(i),
+    superpixelLabels(sLabels),
+    superpixelPixels(sPixels),
+    superpixelOffsets(sOffsets),
+    statistics(stats),
+#if SUPERPIXELLATION_BUILD_ADJACENCY_GRAPH
+    adjacency(new RegionAdjacencyGraph(*i, sLabels, *stats)),
+#else
+    adjacency(0),
+#endif //SUPERPIXELLATION_BUILD_ADJACENCY_GRAPH
+    spatialIndex(new SuperpixelSpatialIndex(i->width(), i->height(), sLabels, *stats)),
+    nSuperpixels(n),
+    shareImage(sI),
+    shareAll(false),
+    storage(file)
+{
+    if(!shareImage) {
+        i = 0;
+    }
+    file = 0;
+    stats = 0;
     s = 0;
 }
 
@@ -234,13 +184,34 @@ Superpixellation::Superpixellation(Superpixellation& other) :
     superpixels(other.superpixels),
     img(other.img),
     superpixelLabels(other.superpixelLabels),
+    superpixelPixels(other.superpixelPixels),
+    superpixelOffsets(other.superpixelOffsets),
+    statistics(other.statistics),
+    adjacency(other.adjacency),
+    spatialIndex(other.spatialIndex),
     nSuperpixels(other.nSuperpixels),
     shareImage(other.shareImage),
-    shareAll(other.shareAll)
+    shareAll(other.shareAll),
+    storage(other.storage)
 {
     other.shareAll = true;
 }
 
+Superpixellation::Superpixellation(const Superpixellation * const other) :
+    superpixels(other->superpixels),
+    img(other->img),
+    superpixelLabels(other->superpixelLabels),
+    superpixelPixels(other->superpixelPixels),
+    superpixelOffsets(other->superpixelOffsets),
+    statistics(other->statistics),
+    adjacency(other->adjacency),
+    spatialIndex(other->spatialIndex),
+    nSuperpixels(other->nSuperpixels),
+    shareImage(true),
+    shareAll(true),
+    storage(other->storage)
+{}
+
 Superpixellation::~Superpixellation(void) {
     if(!shareAll) {
         if(superpixels != 0) {
@@ -252,8 +223,30 @@ Superpixellation::~Superpixellation(void) {
         if(!shareImage && img != 0) {
             delete img;
         }
-        if(superpixelLabels != 0) {
-            delete [] superpixelLabels;
+        if(statistics != 0) {
+            delete statistics;
+        }
+        if(adjacency != 0) {
+            delete adjacency;
+        }
+        if(spatialIndex != 0) {
+            delete spatialIndex;
+        }
+        if(storage != 0) {
+            // Closing the file unmaps the arrays
+            storage->close();
+            delete storage;
+            storage = 0;
+        } else {
+            if(superpixelLabels != 0) {
+                delete [] superpixelLabels;
+            }
+            if(superpixelPixels != 0) {
+                delete [] superpixelPixels;
+            }
+            if(superpixelOffsets != 0) {
+                delete [] superpixelOffsets;
+            }
         }
     }
 }
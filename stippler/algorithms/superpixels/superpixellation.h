@@ -17,7 +17,11 @@
 */
 
 #include "imagedata.h"
+#include "superpixelstatistics.h"
+#include "regionadjacencygraph.h"
+#include "superpixelspatialindex.h"
 #include <QVector3D>
+#include <QFile>
 
 /*!
   \brief An invalid cluster or connected component ID, useful for finding
@@ -25,6 +29,17 @@
  */
 #define SUPERPIXELLATION_NONE_LABEL (-1)
 
+/*!
+  \brief Whether or not to build a region adjacency graph for every
+  Superpixellation object
+
+  If false, Superpixellation::adjacency is null. Most consumers of
+  superpixellations do not need the graph, and the few that do
+  (e.g. SuperpixelMergeTree) build a temporary one when it is absent,
+  so it is not built by default.
+ */
+#define SUPERPIXELLATION_BUILD_ADJACENCY_GRAPH 0
+
 /*!
  * \brief A class representing an image in terms of superpixels
  */
@@ -89,36 +104,31 @@ public:
 
     /*!
      * \brief The contents and characteristics of a superpixel
+     *
+     * A superpixel is a view onto a contiguous range of the pixel array
+     * shared by all superpixels in a Superpixellation
+     * (Superpixellation::superpixelPixels). It does not own any pixel data.
      */
     class Superpixel {
     public:
         /*!
-         * \brief Construct an object describing a superpixel
-         * \param [in] id The ID of the superpixel. This does not
-         * need to match the cluster IDs of the pixels in `allPx` in `labels`
-         * \param [in] allPx An array of pixels (or, rather, their 1D coordinates)
-         * belonging to the superpixel. The Superpixel instance takes ownership
-         * of this array and sets the pointer to null.
+         * \brief Construct an object describing a superpixel whose pixels
+         * have already been arranged into boundary and interior pixels
+         * \param [in] id The ID of the superpixel
+         * \param [in] allPx An array of pixels belonging to the superpixel,
+         * with the `statistics.boundaryCount` boundary pixels preceding the
+         * interior pixels. The Superpixel instance does not take ownership
+         * of this array, which must outlive it.
          * \param [in] nPx The number of pixels in `allPx`
-         * \param [in] labels An array with the same number of elements as
-         * `img.pixelCount()` (ImageData::pixelCount()) used to determine which
-         * pixels in `allPx` are located at the boundary of the superpixel
-         * \param [in] img The image corresponding to `allPx` and `labels`,
-         * used for contextual information and to retrieve pixel colours.
-         *
-         * Note: The cluster labels of the pixels in `allPx` in `labels` should
-         * all be the same, but do not actually need to match `id`,
-         * as presently implemented
+         * \param [in] statistics The statistics of the pixels in `allPx`,
+         * which must outlive this object
          */
         Superpixel(const pxind &id,
-                pxind *&allPx,
+                const pxind* const allPx,
                 const pxind nPx,
-                const pxind* const labels,
-                ImageData &img
+                const SuperpixelStatistics::Statistics &statistics
                 );
 
-        ~Superpixel();
-
         /*!
          * \brief Superpixel identifier
          * \return The ID of the superpixel
@@ -129,8 +139,8 @@ public:
          * \brief Average of pixel spatial coordinates in the superpixel
          * \param [out] p The pixel location of the superpixel's center
          *
-         * Note that the superpixel's center is computed by the Superpixel::Superpixel()
-         * constructor, rather than determined externally.
+         * Note that the superpixel's center is computed from the pixels
+         * in the superpixel (see SuperpixelStatistics), rather than determined externally.
          */
         void centerPosition(QPoint& p) const;
 
@@ -138,8 +148,8 @@ public:
          * \brief Average of pixel colours in the superpixel
          * \param [out] c The colour superpixel's center, in the CIE L*a*b* colour space
          *
-         * Note that the superpixel's center is computed by the Superpixel::Superpixel()
-         * constructor, rather than determined externally.
+         * Note that the superpixel's center is computed from the pixels
+         * in the superpixel (see SuperpixelStatistics), rather than determined externally.
          */
         void centerColor(QVector3D& c) const;
 
@@ -147,11 +157,17 @@ public:
          * \brief Average of pixel colours in the superpixel
          * \param [out] c The colour superpixel's center, in the RGB colour space
          *
-         * Note that the superpixel's center is computed by the Superpixel::Superpixel()
-         * constructor, rather than determined externally.
+         * Note that the superpixel's center is computed from the pixels
+         * in the superpixel (see SuperpixelStatistics), rather than determined externally.
          */
         void centerColorRGB(QRgb& c) const;
 
+        /*!
+         * \brief Bounding box of the superpixel
+         * \param [out] r The smallest rectangle containing all pixels in the superpixel
+         */
+        void boundingBox(QRect& r) const;
+
         /*!
          * \brief Size
          * \return The number of pixels in the superpixel
@@ -204,19 +220,19 @@ public:
          */
         pxind id;
         /*!
-         * \brief The center of the superpixel, computed by averaging the positions
-         * and colours of all pixels in the superpixel
+         * \brief The statistics from which the characteristics of the
+         * superpixel are derived
          *
-         * The colour is in the CIE L*a*b* colour space.
+         * This is an element of Superpixellation::statistics, not owned
+         * by this object.
          */
-        Center<QPoint> center;
+        const SuperpixelStatistics::Statistics *statistics;
         /*!
-         * \brief The RGB colour of the superpixel center
-         * \see Superpixel::center
-         */
-        QRgb centerRGB;
-        /*!
-         * \brief A list of all pixels in the superpixel
+         * \brief A list of all pixels in the superpixel, with boundary pixels
+         * followed by interior pixels
+         *
+         * This is a range of Superpixellation::superpixelPixels, not owned
+         * by this object.
          */
         const pxind *allPx;
         /*!
@@ -235,20 +251,15 @@ public:
          * \see Superpixel::allPx
          */
         const pxind nPixels;
-        /*!
-         * \brief The standard deviation of CIE L*a*b*-space colours in the superpixel
-         */
-        qreal stdDevColor;
-        /*!
-         * \brief The standard deviation of CIE L*a*b*-space colours, per-channel, in the superpixel
-         */
-        QVector3D stdDevColorChannels;
     };
 
 public:
     /*!
      * \brief Combine superpixel data into an object
      *
+     * If #SUPERPIXELLATION_BUILD_ADJACENCY_GRAPH is set, a region adjacency graph
+     * is built from `superpixelLabels` and `statistics`.
+     *
      * This object takes ownership of all input arguments, except for `img`,
      * if `shareImage` is `true`, and the constructor sets
      * the caller's pointers to null so that they are not deallocated by the caller.
@@ -256,14 +267,60 @@ public:
      * \param [in] superpixelLabels An array with the same number of elements as
      * `img.pixelCount()` (ImageData::pixelCount()), where the element at index
      * `k` stores the superpixel ID of the pixel at 1D coordinate `k`.
+     * \param [in] superpixelPixels An array with the same number of elements as
+     * `img.pixelCount()` storing the 1D coordinates of pixels grouped by superpixel.
+     * The pixels of the superpixel at index `i` in `superpixels` occupy the range
+     * starting at `superpixelOffsets[i]` and ending before `superpixelOffsets[i + 1]`.
+     * \param [in] superpixelOffsets An array of `nSuperpixels + 1` offsets
+     * into `superpixelPixels`, the last of which is `img.pixelCount()`.
+     * \param [in] statistics The statistics of the superpixels, referenced by
+     * the objects in `superpixels`
      * \param [in] superpixels An array of superpixels corresponding to the data
-     * in `superpixelLabels`.
+     * in `superpixelLabels`. The superpixels are views of the ranges of
+     * `superpixelPixels` delimited by `superpixelOffsets`.
      * \param [in] nSuperpixels The number of superpixels in the `superpixels` array
      * \param [in] shareImage If true, this object will not delete `img` when
      * deconstructed
      */
     Superpixellation(ImageData *& img,
             pxind *& superpixelLabels,
+            pxind *& superpixelPixels,
+            pxind *& superpixelOffsets,
+            SuperpixelStatistics *& statistics,
+            Superpixel **& superpixels,
+            const pxind &nSuperpixels,
+            const bool shareImage = false
+        );
+
+    /*!
+     * \brief Combine superpixel data stored in a memory-mapped file into an object
+     *
+     * The label map, pixel lists and offsets are not copied, and are not
+     * deallocated by this object. Instead, this object takes ownership of
+     * the file to which they belong, and closes (unmapping) the file when destroyed.
+     * Otherwise, this constructor behaves like
+     * Superpixellation(ImageData*&,pxind*&,pxind*&,pxind*&,SuperpixelStatistics*&,Superpixel**&,const pxind&,const bool)
+     * \param [in] img The image corresponding to the superpixellation
+     * \param [in] storage An open file into which the array arguments are mapped
+     * \param [in] superpixelLabels The superpixel ID of each pixel, in `storage`
+     * \param [in] superpixelPixels The 1D coordinates of all pixels in the image,
+     * grouped by superpixel, in `storage`
+     * \param [in] superpixelOffsets The start of the range of each superpixel
+     * in `superpixelPixels`, followed by `img.pixelCount()`, in `storage`
+     * \param [in] statistics The statistics of the superpixels
+     * \param [in] superpixels An array of superpixels corresponding to the data
+     * in `superpixelLabels`
+     * \param [in] nSuperpixels The number of superpixels in the `superpixels` array
+     * \param [in] shareImage If true, this object will not delete `img` when
+     * deconstructed
+     * \see SuperpixellationFile
+     */
+    Superpixellation(ImageData *& img,
+            QFile *& storage,
+            const pxind* const superpixelLabels,
+            const pxind* const superpixelPixels,
+            const pxind* const superpixelOffsets,
+            SuperpixelStatistics *& statistics,
             Superpixel **& superpixels,
             const pxind &nSuperpixels,
             const bool shareImage = false
@@ -283,6 +340,16 @@ public:
      */
     Superpixellation(Superpixellation &other);
 
+    /*!
+     * \brief Create an instance which refers to the data in an existing instance,
+     * without owning any of it
+     *
+     * Unlike Superpixellation(Superpixellation&), the other instance
+     * is not modified, and remains responsible for deleting its members.
+     * \param [in] other The other instance, which must outlive this object
+     */
+    explicit Superpixellation(const Superpixellation * const other);
+
     virtual ~Superpixellation(void);
 
     /*!
@@ -308,6 +375,36 @@ public:
      * An element at index `k` stores the superpixel ID of the pixel at 1D coordinate `k`.
      */
     pxind const* const superpixelLabels;
+    /*!
+     * \brief The 1D coordinates of all pixels in the image, grouped by superpixel
+     *
+     * Within the range of each superpixel, boundary pixels precede interior pixels.
+     * \see Superpixellation::superpixelOffsets
+     */
+    pxind const* const superpixelPixels;
+    /*!
+     * \brief The start of the range of each superpixel in Superpixellation::superpixelPixels
+     *
+     * This array has Superpixellation::nSuperpixels + 1 elements. Element `i + 1`
+     * marks the end of the range of the superpixel with ID `i`.
+     */
+    pxind const* const superpixelOffsets;
+    /*!
+     * \brief The statistics of the pixels in each superpixel, from which
+     * the characteristics of the superpixels are derived
+     */
+    SuperpixelStatistics const* const statistics;
+    /*!
+     * \brief The adjacency relationships between the superpixels
+     *
+     * This member is null unless #SUPERPIXELLATION_BUILD_ADJACENCY_GRAPH is set.
+     */
+    RegionAdjacencyGraph const* const adjacency;
+    /*!
+     * \brief An index of the superpixels by location, for finding the superpixels
+     * in a region of the image without scanning all superpixels
+     */
+    SuperpixelSpatialIndex const* const spatialIndex;
     /*!
      * \brief The number of superpixels in the segmentation
      */
@@ -331,6 +428,11 @@ protected:
      * are `const` pointers).
      */
     bool shareAll;
+    /*!
+     * \brief The memory-mapped file containing the label map, pixel lists and offsets,
+     * or null if these arrays are owned by this object
+     */
+    QFile *storage;
 };
 
 #endif // SUPERPIXELLATION_H
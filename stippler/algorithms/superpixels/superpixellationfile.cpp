@@ -0,0 +1,339 @@
+/*!
+** \file superpixellationfile.cpp
+** \brief Implementation of the SuperpixellationFile class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <QObject>
+#include <QtGlobal>
+#include <QSaveFile>
+#include "superpixellationfile.h"
+
+const char SuperpixellationFile::magic[8] = {'S', 'T', 'P', 'L', 'S', 'P', 'X', '\0'};
+
+bool SuperpixellationFile::save(const QString &filename,
+        const Superpixellation &superpixellation,
+        QString &error,
+        const bool * const selectedSuperpixels,
+        const bool * const selectedPixels
+    ) {
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    Q_UNUSED(filename)
+    Q_UNUSED(superpixellation)
+    Q_UNUSED(selectedSuperpixels)
+    Q_UNUSED(selectedPixels)
+    error = QObject::tr("Superpixellation files cannot be written on big-endian hosts.");
+    qWarning("%s", qPrintable(error));
+    return false;
+#else
+    Q_ASSERT((selectedSuperpixels == 0) == (selectedPixels == 0));
+    Q_ASSERT(superpixellation.statistics != 0);
+
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    header.width = superpixellation.img->width();
+    header.height = superpixellation.img->height();
+    header.nSuperpixels = superpixellation.nSuperpixels;
+    if(selectedSuperpixels != 0) {
+        header.flags |= HAS_SELECTIONS;
+    }
+    layout(header);
+
+    // The statistics are stored contiguously, indexed by superpixel ID
+    const SuperpixelStatistics::Statistics *table = &((*superpixellation.statistics)[0]);
+
+    const char *sections[static_cast<unsigned int>(Section::COUNT)] = {
+        reinterpret_cast<const char*>(superpixellation.superpixelLabels),
+        reinterpret_cast<const char*>(superpixellation.superpixelPixels),
+        reinterpret_cast<const char*>(superpixellation.superpixelOffsets),
+        reinterpret_cast<const char*>(table),
+        reinterpret_cast<const char*>(selectedSuperpixels),
+        reinterpret_cast<const char*>(selectedPixels)
+    };
+
+    // Write to a temporary file, so that an existing file is not left corrupted on failure
+    QSaveFile file(filename);
+    bool success = file.open(QIODevice::WriteOnly);
+    if(success) {
+        success = (file.write(reinterpret_cast<const char*>(&header), sizeof(Header)) ==
+                   static_cast<qint64>(sizeof(Header)));
+    }
+    quint64 position = sizeof(Header);
+    quint64 length = 0;
+    const char padding[SUPERPIXELLATIONFILE_ALIGNMENT] = {0};
+    for(unsigned int i = 0; success && i < static_cast<unsigned int>(Section::COUNT); i += 1) {
+        if(header.sectionOffsets[i] == 0) {
+            continue;
+        }
+        if(header.sectionOffsets[i] > position) {
+            length = header.sectionOffsets[i] - position;
+            success = (file.write(padding, length) == static_cast<qint64>(length));
+            position += length;
+        }
+        length = sectionLength(header, static_cast<Section>(i));
+        if(success) {
+            success = (file.write(sections[i], length) == static_cast<qint64>(length));
+            position += length;
+        }
+    }
+
+    if(success) {
+        success = file.commit();
+    } else {
+        file.cancelWriting();
+    }
+    if(!success) {
+        error = QObject::tr("Failed to write superpixellation file \"%1\": %2")
+                .arg(filename).arg(file.errorString());
+    }
+    return success;
+#endif // Q_BYTE_ORDER == Q_BIG_ENDIAN
+}
+
+bool SuperpixellationFile::load(const QString &filename,
+        ImageData *& img,
+        Superpixellation *& superpixellation,
+        const bool *& selectedSuperpixels,
+        const bool *& selectedPixels,
+        QString &error,
+        const bool shareImage
+    ) {
+    Q_ASSERT(img != 0);
+    Q_ASSERT(superpixellation == 0);
+    selectedSuperpixels = 0;
+    selectedPixels = 0;
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    Q_UNUSED(filename)
+    Q_UNUSED(shareImage)
+    error = QObject::tr("Superpixellation files cannot be read on big-endian hosts.");
+    qWarning("%s", qPrintable(error));
+    return false;
+#else
+    QFile *file = new QFile(filename);
+    if(!file->open(QIODevice::ReadOnly)) {
+        error = QObject::tr("Failed to open superpixellation file \"%1\": %2")
+                .arg(filename).arg(file->errorString());
+        delete file;
+        return false;
+    }
+    qint64 fileSize = file->size();
+    uchar *data = 0;
+    if(fileSize >= static_cast<qint64>(sizeof(Header))) {
+        data = file->map(0, fileSize);
+    }
+    if(data == 0) {
+        error = QObject::tr("Failed to map superpixellation file \"%1\" into memory.").arg(filename);
+        delete file;
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    bool success = validate(header, fileSize, error);
+    if(success && (header.width != img->width() || header.height != img->height())) {
+        error = QObject::tr("The superpixellation is for a %1 x %2 image, but the image is %3 x %4.")
+                .arg(header.width).arg(header.height).arg(img->width()).arg(img->height());
+        success = false;
+    }
+    if(!success) {
+        error = QObject::tr("Invalid superpixellation file \"%1\": %2").arg(filename).arg(error);
+        delete file;
+        return false;
+    }
+
+    const pxind nSuperpixels = header.nSuperpixels;
+    const pxind pixelCount = header.width * header.height;
+    const pxind *labels = reinterpret_cast<const pxind*>(
+                data + header.sectionOffsets[static_cast<unsigned int>(Section::LABELS)]);
+    const pxind *pixels = reinterpret_cast<const pxind*>(
+                data + header.sectionOffsets[static_cast<unsigned int>(Section::PIXELS)]);
+    const pxind *offsets = reinterpret_cast<const pxind*>(
+                data + header.sectionOffsets[static_cast<unsigned int>(Section::OFFSETS)]);
+    const SuperpixelStatistics::Statistics *table =
+            reinterpret_cast<const SuperpixelStatistics::Statistics*>(
+                data + header.sectionOffsets[static_cast<unsigned int>(Section::STATISTICS)]);
+
+    /* Check the superpixel ranges, which will be used to index the pixel lists,
+     * and the pixels in each range, which will be used to index the label map
+     */
+    success = (offsets[0] == 0 && offsets[nSuperpixels] == pixelCount);
+    pxind px = 0;
+    pxind minXY[2] = {0};
+    pxind maxXY[2] = {0};
+    for(pxind i = 0; success && i < nSuperpixels; i += 1) {
+        success = (offsets[i] <= offsets[i + 1]) &&
+                (table[i].count == offsets[i + 1] - offsets[i]) &&
+                (table[i].boundaryCount >= 0) &&
+                (table[i].boundaryCount <= table[i].count);
+        minXY[0] = header.width;
+        minXY[1] = header.height;
+        maxXY[0] = -1;
+        maxXY[1] = -1;
+        for(pxind j = offsets[i]; success && j < offsets[i + 1]; j += 1) {
+            px = pixels[j];
+            success = (px >= 0) && (px < pixelCount) && (labels[px] == i);
+            if(success) {
+                minXY[0] = std::min(minXY[0], px % header.width);
+                minXY[1] = std::min(minXY[1], px / header.width);
+                maxXY[0] = std::max(maxXY[0], px % header.width);
+                maxXY[1] = std::max(maxXY[1], px / header.width);
+            }
+        }
+        /* The bounding boxes are used to index the spatial index of the Superpixellation,
+         * so they must be those of the pixel lists, which lie within the image
+         */
+        if(success && table[i].count > 0) {
+            success = (table[i].minXY[0] == minXY[0]) && (table[i].minXY[1] == minXY[1]) &&
+                    (table[i].maxXY[0] == maxXY[0]) && (table[i].maxXY[1] == maxXY[1]);
+        }
+    }
+    if(!success) {
+        error = QObject::tr("Invalid superpixellation file \"%1\": "
+                            "Superpixel sizes, bounding boxes or pixel lists are inconsistent.").arg(filename);
+        delete file;
+        return false;
+    }
+
+    /* The pixel lists could contain duplicates, leaving some labels unchecked,
+     * so all labels must be checked as well
+     */
+    for(pxind k = 0; success && k < pixelCount; k += 1) {
+        success = (labels[k] >= 0) && (labels[k] < nSuperpixels);
+    }
+    if(!success) {
+        error = QObject::tr("Invalid superpixellation file \"%1\": "
+                            "Superpixel labels are out of range.").arg(filename);
+        delete file;
+        return false;
+    }
+
+    SuperpixelStatistics *statistics = new SuperpixelStatistics(table, nSuperpixels);
+    Superpixellation::Superpixel **superpixels = new Superpixellation::Superpixel*[nSuperpixels];
+    for(pxind i = 0; i < nSuperpixels; i += 1) {
+        superpixels[i] = new Superpixellation::Superpixel(
+                    i,
+                    pixels + offsets[i],
+                    offsets[i + 1] - offsets[i],
+                    table[i]
+                );
+    }
+
+    if((header.flags & HAS_SELECTIONS) != 0) {
+        selectedSuperpixels = reinterpret_cast<const bool*>(
+                    data + header.sectionOffsets[static_cast<unsigned int>(Section::SELECTED_SUPERPIXELS)]);
+        selectedPixels = reinterpret_cast<const bool*>(
+                    data + header.sectionOffsets[static_cast<unsigned int>(Section::SELECTED_PIXELS)]);
+    }
+
+    superpixellation = new Superpixellation(
+                img,
+                file,
+                labels,
+                pixels,
+                offsets,
+                statistics,
+                superpixels,
+                nSuperpixels,
+                shareImage
+            );
+    return true;
+#endif // Q_BYTE_ORDER == Q_BIG_ENDIAN
+}
+
+quint64 SuperpixellationFile::sectionLength(const Header &header, const Section section) {
+    const quint64 pixelCount = static_cast<quint64>(header.width) * static_cast<quint64>(header.height);
+    const quint64 nSuperpixels = static_cast<quint64>(header.nSuperpixels);
+    switch(section) {
+    case Section::LABELS:
+    case Section::PIXELS:
+        return pixelCount * header.indexSize;
+    case Section::OFFSETS:
+        return (nSuperpixels + 1) * header.indexSize;
+    case Section::STATISTICS:
+        return nSuperpixels * header.statisticsSize;
+    case Section::SELECTED_SUPERPIXELS:
+        return nSuperpixels * sizeof(bool);
+    case Section::SELECTED_PIXELS:
+        return pixelCount * sizeof(bool);
+    default:
+        Q_ASSERT(false);
+        return 0;
+    }
+}
+
+quint64 SuperpixellationFile::layout(Header &header) {
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = SUPERPIXELLATIONFILE_VERSION;
+    header.headerSize = sizeof(Header);
+    header.indexSize = sizeof(pxind);
+    header.statisticsSize = sizeof(SuperpixelStatistics::Statistics);
+
+    quint64 position = sizeof(Header);
+    unsigned int nSections = static_cast<unsigned int>(Section::COUNT);
+    if((header.flags & HAS_SELECTIONS) == 0) {
+        nSections = static_cast<unsigned int>(Section::SELECTED_SUPERPIXELS);
+    }
+    for(unsigned int i = 0; i < static_cast<unsigned int>(Section::COUNT); i += 1) {
+        if(i < nSections) {
+            position = ((position + SUPERPIXELLATIONFILE_ALIGNMENT - 1) /
+                        SUPERPIXELLATIONFILE_ALIGNMENT) * SUPERPIXELLATIONFILE_ALIGNMENT;
+            header.sectionOffsets[i] = position;
+            position += sectionLength(header, static_cast<Section>(i));
+        } else {
+            header.sectionOffsets[i] = 0;
+        }
+    }
+    return position;
+}
+
+bool SuperpixellationFile::validate(const Header &header, const qint64 fileSize, QString &error) {
+    if(std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+        error = QObject::tr("Not a superpixellation file.");
+        return false;
+    } else if(header.version != SUPERPIXELLATIONFILE_VERSION) {
+        error = QObject::tr("Unsupported file format version %1 (expected %2).")
+                .arg(header.version).arg(SUPERPIXELLATIONFILE_VERSION);
+        return false;
+    } else if(header.headerSize != sizeof(Header) ||
+              header.indexSize != sizeof(pxind) ||
+              header.statisticsSize != sizeof(SuperpixelStatistics::Statistics)) {
+        error = QObject::tr("The file was written by an incompatible build of this program.");
+        return false;
+    }
+    const qint64 pixelCount = static_cast<qint64>(header.width) * static_cast<qint64>(header.height);
+    if(header.width <= 0 || header.height <= 0 || header.nSuperpixels <= 0 ||
+            pixelCount > std::numeric_limits<pxind>::max() ||
+            static_cast<qint64>(header.nSuperpixels) > pixelCount) {
+        error = QObject::tr("Invalid image dimensions or number of superpixels.");
+        return false;
+    }
+
+    /* Sections must lie within the file, and be aligned so that
+     * they can be accessed in place.
+     */
+    Header expected = header;
+    quint64 expectedSize = layout(expected);
+    for(unsigned int i = 0; i < static_cast<unsigned int>(Section::COUNT); i += 1) {
+        if(header.sectionOffsets[i] != expected.sectionOffsets[i]) {
+            error = QObject::tr("Unexpected section layout.");
+            return false;
+        }
+    }
+    if(static_cast<quint64>(fileSize) < expectedSize) {
+        error = QObject::tr("The file is truncated.");
+        return false;
+    }
+    return true;
+}
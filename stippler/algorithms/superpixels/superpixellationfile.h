@@ -0,0 +1,225 @@
+#ifndef SUPERPIXELLATIONFILE_H
+#define SUPERPIXELLATIONFILE_H
+
+/*!
+** \file superpixellationfile.h
+** \brief Definition of the SuperpixellationFile class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QString>
+#include "superpixellation.h"
+
+/*!
+  \brief The current version of the superpixellation file format
+
+  Files with other versions are rejected when loaded.
+ */
+#define SUPERPIXELLATIONFILE_VERSION 2
+
+/*!
+  \brief The alignment, in bytes, of each section of a superpixellation file
+ */
+#define SUPERPIXELLATIONFILE_ALIGNMENT 8
+
+/*!
+ * \brief Reading and writing superpixellations in a binary file format
+ *
+ * The format is designed so that a file can be memory-mapped and used
+ * directly, without parsing or copying pixel-level data. All values are stored
+ * in little-endian byte order, and files can only be read and written on
+ * little-endian hosts. A file consists of a SuperpixellationFile::Header,
+ * followed by the sections listed in SuperpixellationFile::Section,
+ * each starting at a multiple of #SUPERPIXELLATIONFILE_ALIGNMENT bytes
+ * from the start of the file:
+ * - The label map (Superpixellation::superpixelLabels)
+ * - The pixel lists (Superpixellation::superpixelPixels), with the boundary pixels
+ *   of each superpixel preceding its interior pixels
+ * - The offsets of the pixel lists (Superpixellation::superpixelOffsets)
+ * - The table of superpixel statistics (SuperpixelStatistics::Statistics)
+ * - Optionally, the selection status of each superpixel and of each pixel,
+ *   as stored in a FilteredSuperpixellation, one byte per element
+ *
+ * The image which was segmented is not stored, and must be provided
+ * by the caller when loading a file.
+ */
+class SuperpixellationFile
+{
+public:
+    /*!
+     * \brief Write a superpixellation to a file
+     * \param [in] filename The file to create or overwrite
+     * \param [in] superpixellation The superpixellation to save
+     * \param [out] error A description of the problem encountered, if the
+     * superpixellation could not be saved
+     * \param [in] selectedSuperpixels The selected/rejected status of each superpixel,
+     * if the superpixellation has been filtered (see
+     * FilteredSuperpixellation::selectedSuperpixels), or null otherwise
+     * \param [in] selectedPixels The selected/rejected status of each pixel,
+     * if the superpixellation has been filtered (see
+     * FilteredSuperpixellation::selectedPixels), or null otherwise
+     * \return `true` on success, `false` otherwise
+     */
+    static bool save(const QString &filename,
+            const Superpixellation &superpixellation,
+            QString &error,
+            const bool* const selectedSuperpixels = 0,
+            const bool* const selectedPixels = 0
+        );
+
+    /*!
+     * \brief Map a superpixellation file into memory
+     *
+     * The header, the superpixel offsets and the statistics are validated,
+     * along with the label map and the pixel lists: every pixel index must
+     * be within the image, and must have the label of the superpixel
+     * whose list contains it, and every label must be a valid superpixel ID.
+     * The bounding box of each superpixel in the statistics must be that
+     * of its pixel list, as it is used to index the SuperpixelSpatialIndex.
+     * A corrupt or tampered file is therefore rejected, rather than used to index
+     * out of bounds. Validation touches each pixel of the file once or twice.
+     * \param [in] filename The file to load
+     * \param [in] img The image which was segmented. Its dimensions must match those
+     * recorded in the file. Ownership of the image is transferred to `superpixellation`
+     * unless `shareImage` is `true`, as in
+     * Superpixellation::Superpixellation(ImageData*&,QFile*&,const pxind*,const pxind*,const pxind*,SuperpixelStatistics*&,Superpixel**&,const pxind&,const bool)
+     * \param [out] superpixellation The superpixellation stored in the file, which
+     * owns the mapping of the file. Expected to be passed in as a null pointer.
+     * \param [out] selectedSuperpixels The selected/rejected status of each superpixel,
+     * or null if the file does not contain selection data. The array belongs to the mapping
+     * owned by `superpixellation`.
+     * \param [out] selectedPixels The selected/rejected status of each pixel,
+     * or null if the file does not contain selection data. The array belongs to the mapping
+     * owned by `superpixellation`.
+     * \param [out] error A description of the problem encountered, if the
+     * superpixellation could not be loaded
+     * \param [in] shareImage If true, `superpixellation` will not delete `img`
+     * \return `true` on success, `false` otherwise
+     */
+    static bool load(const QString &filename,
+            ImageData *& img,
+            Superpixellation *& superpixellation,
+            const bool *& selectedSuperpixels,
+            const bool *& selectedPixels,
+            QString &error,
+            const bool shareImage = false
+        );
+
+private:
+    /*!
+     * \brief The sections of a file, in the order in which they are stored
+     */
+    enum class Section : unsigned int {
+        LABELS,
+        PIXELS,
+        OFFSETS,
+        STATISTICS,
+        SELECTED_SUPERPIXELS,
+        SELECTED_PIXELS,
+        COUNT // Not a section - Used to size arrays
+    };
+
+    /*!
+     * \brief The flags stored in SuperpixellationFile::Header::flags
+     */
+    enum Flags : quint32 {
+        /*!
+         * \brief The file contains the selection sections
+         */
+        HAS_SELECTIONS = 0x1
+    };
+
+    /*!
+     * \brief The fixed-size header at the start of a file
+     */
+    struct Header {
+        /*!
+         * \brief Identifies the file format
+         */
+        char magic[8];
+        /*!
+         * \brief The file format version (#SUPERPIXELLATIONFILE_VERSION)
+         */
+        quint32 version;
+        /*!
+         * \brief The size of this structure, in bytes
+         */
+        quint32 headerSize;
+        /*!
+         * \brief The width of the image, in pixels
+         */
+        qint32 width;
+        /*!
+         * \brief The height of the image, in pixels
+         */
+        qint32 height;
+        /*!
+         * \brief The number of superpixels
+         */
+        qint32 nSuperpixels;
+        /*!
+         * \brief A combination of SuperpixellationFile::Flags values
+         */
+        quint32 flags;
+        /*!
+         * \brief The size of a pixel index (`pxind`), in bytes
+         */
+        quint32 indexSize;
+        /*!
+         * \brief The size of a SuperpixelStatistics::Statistics structure, in bytes
+         */
+        quint32 statisticsSize;
+        /*!
+         * \brief The offset of each section from the start of the file,
+         * or zero for sections which are not present
+         */
+        quint64 sectionOffsets[static_cast<unsigned int>(Section::COUNT)];
+    };
+
+    /*!
+     * \brief Compute the number of bytes in a section
+     * \param [in] header The header of the file, describing its contents
+     * \param [in] section The section
+     * \return The length of the section, in bytes
+     */
+    static quint64 sectionLength(const Header &header, const Section section);
+
+    /*!
+     * \brief Fill in the version, sizes and section offsets in a file header
+     *
+     * The image dimensions, number of superpixels and flags
+     * must already be set in `header`.
+     * \param [in,out] header The header to complete
+     * \return The total size of the file, in bytes
+     */
+    static quint64 layout(Header &header);
+
+    /*!
+     * \brief Check a file header for consistency with the file and the host
+     * \param [in] header The header to check
+     * \param [in] fileSize The size of the file, in bytes
+     * \param [out] error A description of the first inconsistency found
+     * \return `true` if the header is valid, `false` otherwise
+     */
+    static bool validate(const Header &header, const qint64 fileSize, QString &error);
+
+    /*!
+     * \brief The byte sequence identifying the file format
+     */
+    static const char magic[8];
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    SuperpixellationFile(void);
+};
+
+#endif // SUPERPIXELLATIONFILE_H
@@ -0,0 +1,249 @@
+/*!
+** \file superpixelmergetree.cpp
+** \brief Implementation of the SuperpixelMergeTree class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** See superpixelmergetree.h
+*/
+
+#include <algorithm>
+#include <iterator>
+#include "superpixelmergetree.h"
+#include "ods/BinaryHeap.h"
+
+SuperpixelMergeTree::SuperpixelMergeTree(const Superpixellation &superpixellation) :
+    nRegions(superpixellation.nSuperpixels),
+    merges(0),
+    nMerges(0)
+{
+    Q_ASSERT(superpixellation.statistics != 0);
+    if(superpixellation.adjacency != 0) {
+        build(*superpixellation.adjacency, *superpixellation.statistics);
+    } else {
+        RegionAdjacencyGraph adjacency(
+                    *superpixellation.img,
+                    superpixellation.superpixelLabels,
+                    *superpixellation.statistics
+                );
+        build(adjacency, *superpixellation.statistics);
+    }
+}
+
+SuperpixelMergeTree::~SuperpixelMergeTree(void) {
+    if(merges != 0) {
+        delete [] merges;
+        merges = 0;
+    }
+}
+
+pxind SuperpixelMergeTree::size(void) const {
+    return nRegions;
+}
+
+pxind SuperpixelMergeTree::mergeCount(void) const {
+    return nMerges;
+}
+
+const SuperpixelMergeTree::Merge& SuperpixelMergeTree::merge(const pxind &i) const {
+    Q_ASSERT(i >= 0 && i < nMerges);
+    return merges[i];
+}
+
+pxind SuperpixelMergeTree::extract(const pxind &targetCount, pxind *mapping) const {
+    pxind nApplied = nRegions - targetCount;
+    if(nApplied < 0) {
+        nApplied = 0;
+    } else if(nApplied > nMerges) {
+        nApplied = nMerges;
+    }
+
+    /* Each merged region points to the region which absorbed it,
+     * forming a union-find forest whose roots are the remaining regions.
+     */
+    for(pxind i = 0; i < nRegions; i += 1) {
+        mapping[i] = i;
+    }
+    for(pxind i = 0; i < nApplied; i += 1) {
+        mapping[merges[i].merged] = merges[i].survivor;
+    }
+
+    // Point all regions directly to their roots, and assign consecutive IDs to the roots
+    pxind *rootLabels = new pxind[nRegions];
+    pxind nOutputRegions = 0;
+    pxind root = 0;
+    pxind next = 0;
+    for(pxind i = 0; i < nRegions; i += 1) {
+        root = i;
+        while(mapping[root] != root) {
+            root = mapping[root];
+        }
+        // Path compression
+        next = i;
+        while(mapping[next] != root) {
+            pxind parent = mapping[next];
+            mapping[next] = root;
+            next = parent;
+        }
+        if(root == i) {
+            rootLabels[i] = nOutputRegions;
+            nOutputRegions += 1;
+        }
+    }
+    // All roots have IDs after the first pass
+    for(pxind i = 0; i < nRegions; i += 1) {
+        mapping[i] = rootLabels[mapping[i]];
+    }
+    delete [] rootLabels;
+    return nOutputRegions;
+}
+
+void SuperpixelMergeTree::build(const RegionAdjacencyGraph &adjacency, const SuperpixelStatistics &statistics) {
+    if(nRegions == 0) {
+        return;
+    }
+    merges = new Merge[nRegions - 1];
+
+    Region *regions = createRegions(adjacency, statistics);
+
+    // Find the best merger for each region
+    ods::BinaryHeap<MergeCandidate, pxind> heap;
+    pxind *handles = new pxind[nRegions];
+    MergeCandidate candidate;
+    for(pxind i = 0; i < nRegions; i += 1) {
+        if(regions[i].neighbours.isEmpty()) {
+            handles[i] = BINARYHEAP_INVALID_INDEX;
+        } else {
+            findBestNeighbour(regions, i, candidate);
+            handles[i] = heap.add(candidate);
+        }
+    }
+
+    pxind survivor = 0;
+    pxind merged = 0;
+    pxind neighbour = 0;
+    pxind combinedCount = 0;
+    QVector<pxind> combinedNeighbours;
+    QVector<pxind>::iterator position;
+    while(heap.size() > 0) {
+        candidate = heap.findMax();
+        survivor = candidate.region;
+        merged = candidate.neighbour;
+        Region &r1 = regions[survivor];
+        Region &r2 = regions[merged];
+
+        merges[nMerges].survivor = survivor;
+        merges[nMerges].merged = merged;
+        merges[nMerges].cost = candidate.cost;
+        nMerges += 1;
+
+        // Combine colour statistics
+        combinedCount = r1.count + r2.count;
+        for(int j = 0; j < 3; j += 1) {
+            r1.meanLab[j] = (r1.meanLab[j] * r1.count + r2.meanLab[j] * r2.count) /
+                    static_cast<qreal>(combinedCount);
+        }
+        r1.count = combinedCount;
+
+        // Combine neighbour lists
+        combinedNeighbours.clear();
+        combinedNeighbours.reserve(r1.neighbours.size() + r2.neighbours.size());
+        std::set_union(
+                    r1.neighbours.constBegin(), r1.neighbours.constEnd(),
+                    r2.neighbours.constBegin(), r2.neighbours.constEnd(),
+                    std::back_inserter(combinedNeighbours)
+                );
+        combinedNeighbours.removeOne(survivor);
+        combinedNeighbours.removeOne(merged);
+        r1.neighbours = combinedNeighbours;
+
+        // Replace the merged region with the surviving region in neighbour lists
+        for(int j = 0; j < r2.neighbours.size(); j += 1) {
+            neighbour = r2.neighbours[j];
+            if(neighbour == survivor) {
+                continue;
+            }
+            QVector<pxind> &list = regions[neighbour].neighbours;
+            list.removeOne(merged);
+            position = std::lower_bound(list.begin(), list.end(), survivor);
+            if(position == list.end() || *position != survivor) {
+                list.insert(position, survivor);
+            }
+        }
+        r2.neighbours.clear();
+        heap.removeAt(handles[merged]);
+        handles[merged] = BINARYHEAP_INVALID_INDEX;
+
+        // Update the best mergers of the surviving region and its neighbours
+        if(r1.neighbours.isEmpty()) {
+            heap.removeAt(handles[survivor]);
+            handles[survivor] = BINARYHEAP_INVALID_INDEX;
+        } else {
+            findBestNeighbour(regions, survivor, heap[handles[survivor]]);
+            heap.update(handles[survivor]);
+        }
+        for(int j = 0; j < r1.neighbours.size(); j += 1) {
+            neighbour = r1.neighbours[j];
+            findBestNeighbour(regions, neighbour, heap[handles[neighbour]]);
+            heap.update(handles[neighbour]);
+        }
+    }
+
+    delete [] handles;
+    delete [] regions;
+}
+
+SuperpixelMergeTree::Region *SuperpixelMergeTree::createRegions(
+        const RegionAdjacencyGraph &adjacency,
+        const SuperpixelStatistics &statistics
+    ) {
+    pxind n = statistics.size();
+    Region *regions = new Region[n];
+    const pxind *neighbours = 0;
+    pxind degree = 0;
+    for(pxind i = 0; i < n; i += 1) {
+        const SuperpixelStatistics::Statistics &s = statistics[i];
+        regions[i].count = s.count;
+        std::copy(s.meanLab, s.meanLab + 3, regions[i].meanLab);
+        adjacency.neighbours(i, neighbours, degree);
+        regions[i].neighbours.reserve(degree);
+        for(pxind j = 0; j < degree; j += 1) {
+            regions[i].neighbours.append(neighbours[j]);
+        }
+    }
+    return regions;
+}
+
+qreal SuperpixelMergeTree::mergeCost(const Region &r1, const Region &r2) {
+    qreal distance = 0.0;
+    qreal channelDifference = 0.0;
+    for(int j = 0; j < 3; j += 1) {
+        channelDifference = r1.meanLab[j] - r2.meanLab[j];
+        distance += channelDifference * channelDifference;
+    }
+    qreal n1 = static_cast<qreal>(r1.count);
+    qreal n2 = static_cast<qreal>(r2.count);
+    return (n1 * n2 / (n1 + n2)) * distance;
+}
+
+void SuperpixelMergeTree::findBestNeighbour(const Region *regions, const pxind &region, MergeCandidate &candidate) {
+    const Region &r = regions[region];
+    Q_ASSERT(!r.neighbours.isEmpty());
+    candidate.region = region;
+    candidate.neighbour = r.neighbours[0];
+    candidate.cost = mergeCost(r, regions[candidate.neighbour]);
+    qreal cost = 0.0;
+    for(int j = 1; j < r.neighbours.size(); j += 1) {
+        cost = mergeCost(r, regions[r.neighbours[j]]);
+        if(cost < candidate.cost) {
+            candidate.cost = cost;
+            candidate.neighbour = r.neighbours[j];
+        }
+    }
+}
@@ -0,0 +1,218 @@
+#ifndef SUPERPIXELMERGETREE_H
+#define SUPERPIXELMERGETREE_H
+
+/*!
+** \file superpixelmergetree.h
+** \brief Definition of the SuperpixelMergeTree class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** - Ward's minimum variance criterion for hierarchical clustering:
+**   https://en.wikipedia.org/wiki/Ward%27s_method
+*/
+
+#include <QVector>
+#include "superpixellation.h"
+
+/*!
+ * \brief A hierarchy of superpixels obtained by repeatedly merging
+ * pairs of adjacent superpixels
+ *
+ * Starting from the superpixels of a Superpixellation, the pair of adjacent
+ * regions whose merger least increases the total colour variance
+ * (Ward's criterion, in the CIE L*a*b* colour space) is merged, until
+ * no adjacent regions remain. Candidate merges are kept in an indexed
+ * max-heap (ods::BinaryHeap) holding the best merge for each region.
+ *
+ * The sequence of merges is recorded, such that a segmentation into any
+ * number of regions can later be extracted in time linear in the number
+ * of superpixels, without revisiting the image's pixels.
+ */
+class SuperpixelMergeTree
+{
+public:
+    /*!
+     * \brief A merger of two regions
+     */
+    struct Merge {
+        /*!
+         * \brief The ID of the region that absorbed the other region
+         *
+         * Region IDs are the IDs of the superpixels in the original
+         * Superpixellation. A merged region keeps the ID of this region.
+         */
+        pxind survivor;
+        /*!
+         * \brief The ID of the region which was absorbed
+         */
+        pxind merged;
+        /*!
+         * \brief The increase in the sum of squared colour deviations
+         * from region means resulting from the merger
+         */
+        qreal cost;
+    };
+
+    /*!
+     * \brief Build the hierarchy for a superpixellation
+     *
+     * If `superpixellation.adjacency` is null, a temporary region adjacency
+     * graph is built.
+     * \param [in] superpixellation The superpixels to merge
+     */
+    SuperpixelMergeTree(const Superpixellation &superpixellation);
+
+    ~SuperpixelMergeTree(void);
+
+    /*!
+     * \brief The number of superpixels in the original superpixellation
+     * \return The number of leaves of the hierarchy
+     */
+    pxind size(void) const;
+
+    /*!
+     * \brief The number of recorded mergers
+     * \return The number of mergers, which is the number of superpixels
+     * minus the number of connected groups of superpixels
+     */
+    pxind mergeCount(void) const;
+
+    /*!
+     * \brief Access a merger
+     * \param [in] i The index of the merger in the sequence of mergers
+     * \return The merger
+     */
+    const Merge& merge(const pxind &i) const;
+
+    /*!
+     * \brief Extract a coarser segmentation
+     *
+     * Applies the first `size() - targetCount` mergers.
+     * \param [in] targetCount The desired number of regions. This is clamped
+     * to the range `[size() - mergeCount(), size()]`.
+     * \param [out] mapping An array of size() elements. Element `i` is set to the
+     * ID, in the range `[0, n)`, of the region containing the superpixel with ID `i`,
+     * where `n` is the return value. Region IDs are ordered by the IDs of the
+     * superpixels which absorbed the other superpixels in the regions.
+     * \return The number of regions in the extracted segmentation
+     */
+    pxind extract(const pxind &targetCount, pxind *mapping) const;
+
+private:
+    /*!
+     * \brief A region during the construction of the hierarchy
+     */
+    struct Region {
+        /*!
+         * \brief The number of pixels in the region
+         */
+        pxind count;
+        /*!
+         * \brief The mean CIE L*a*b* colour of the region
+         */
+        qreal meanLab[3];
+        /*!
+         * \brief The IDs of the regions adjacent to this region, in ascending order
+         */
+        QVector<pxind> neighbours;
+    };
+
+    /*!
+     * \brief The best merger available to a region
+     */
+    struct MergeCandidate {
+        /*!
+         * \brief The cost of the merger
+         * \see SuperpixelMergeTree::Merge::cost
+         */
+        qreal cost;
+        /*!
+         * \brief The region
+         */
+        pxind region;
+        /*!
+         * \brief The neighbour with which merging is cheapest
+         */
+        pxind neighbour;
+
+        /*!
+         * \brief Compare merger costs
+         *
+         * In a max-heap, MergeCandidate objects will be in ascending order
+         * by cost. Ties are broken in favour of smaller region IDs.
+         * \param [in] rhs The other candidate
+         * \return A comparison result to be used for sorting MergeCandidate objects
+         */
+        bool operator<(MergeCandidate const & rhs) const
+        {
+            if(cost > rhs.cost) {
+                return true;
+            } else if(cost < rhs.cost) {
+                return false;
+            } else { // cost == rhs.cost
+                return (region > rhs.region);
+            }
+        }
+    };
+
+    /*!
+     * \brief Create the initial regions, one for each superpixel
+     * \param [in] adjacency The adjacency relationships between the superpixels
+     * \param [in] statistics The statistics of the superpixels
+     * \return An array of `statistics.size()` regions, which the caller must delete
+     */
+    static Region *createRegions(const RegionAdjacencyGraph &adjacency, const SuperpixelStatistics &statistics);
+
+    /*!
+     * \brief Merge regions until no adjacent regions remain
+     * \param [in] adjacency The adjacency relationships between the superpixels
+     * \param [in] statistics The statistics of the superpixels
+     */
+    void build(const RegionAdjacencyGraph &adjacency, const SuperpixelStatistics &statistics);
+
+    /*!
+     * \brief Compute the cost of merging two regions
+     * \param [in] r1 The first region
+     * \param [in] r2 The second region
+     * \return The increase in the sum of squared colour deviations
+     * from region means
+     */
+    static qreal mergeCost(const Region &r1, const Region &r2);
+
+    /*!
+     * \brief Find the cheapest merger for a region
+     * \param [in] regions All regions
+     * \param [in] region The ID of the region, which must have at least one neighbour
+     * \param [out] candidate The cheapest merger involving the region
+     */
+    static void findBestNeighbour(const Region *regions, const pxind &region, MergeCandidate &candidate);
+
+    /*!
+     * \brief The number of superpixels in the original superpixellation
+     */
+    const pxind nRegions;
+
+    /*!
+     * \brief The sequence of mergers, which has at most
+     * SuperpixelMergeTree::nRegions - 1 elements
+     */
+    Merge *merges;
+
+    /*!
+     * \brief The number of elements in SuperpixelMergeTree::merges
+     */
+    pxind nMerges;
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    SuperpixelMergeTree(const SuperpixelMergeTree& other);
+    SuperpixelMergeTree& operator=(const SuperpixelMergeTree& other);
+};
+
+#endif // SUPERPIXELMERGETREE_H
@@ -0,0 +1,162 @@
+/*!
+** \file superpixelspatialindex.cpp
+** \brief Implementation of the SuperpixelSpatialIndex class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <math.h>
+#include <algorithm>
+#include "superpixelspatialindex.h"
+
+SuperpixelSpatialIndex::SuperpixelSpatialIndex(const pxind &w,
+        const pxind &h,
+        const pxind * const l,
+        const SuperpixelStatistics &statistics
+    ) :
+    width(w),
+    height(h),
+    labels(l),
+    boxes(0),
+    nLabels(statistics.size()),
+    cellSize(1),
+    nColumns(0),
+    nRows(0),
+    cellOffsets(0),
+    cellEntries(0)
+{
+    if(nLabels > 0) {
+        cellSize = static_cast<pxind>(ceil(SUPERPIXELSPATIALINDEX_CELL_SCALE * sqrt(
+                static_cast<qreal>(width) * static_cast<qreal>(height) / static_cast<qreal>(nLabels)
+            )));
+        if(cellSize < 1) {
+            cellSize = 1;
+        }
+    }
+    nColumns = (width + cellSize - 1) / cellSize;
+    nRows = (height + cellSize - 1) / cellSize;
+    pxind nCells = nColumns * nRows;
+
+    boxes = new QRect[nLabels];
+    for(pxind i = 0; i < nLabels; i += 1) {
+        statistics[i].boundingBox(boxes[i]);
+    }
+
+    // Count the number of superpixels registered in each cell
+    cellOffsets = new pxind[nCells + 1];
+    std::fill(cellOffsets, cellOffsets + nCells + 1, 0);
+    pxind first[2] = {0};
+    pxind last[2] = {0};
+    for(pxind i = 0; i < nLabels; i += 1) {
+        if(boxes[i].isNull()) {
+            continue;
+        }
+        cellRange(boxes[i], first, last);
+        for(pxind row = first[1]; row <= last[1]; row += 1) {
+            for(pxind column = first[0]; column <= last[0]; column += 1) {
+                cellOffsets[row * nColumns + column + 1] += 1;
+            }
+        }
+    }
+    for(pxind i = 0; i < nCells; i += 1) {
+        cellOffsets[i + 1] += cellOffsets[i];
+    }
+
+    /* Register superpixels in cells. Visiting superpixels in order of ID
+     * leaves the superpixels in each cell in ascending order.
+     */
+    cellEntries = new pxind[cellOffsets[nCells]];
+    pxind *cellEnds = new pxind[nCells];
+    std::copy(cellOffsets, cellOffsets + nCells, cellEnds);
+    pxind cell = 0;
+    for(pxind i = 0; i < nLabels; i += 1) {
+        if(boxes[i].isNull()) {
+            continue;
+        }
+        cellRange(boxes[i], first, last);
+        for(pxind row = first[1]; row <= last[1]; row += 1) {
+            for(pxind column = first[0]; column <= last[0]; column += 1) {
+                cell = row * nColumns + column;
+                cellEntries[cellEnds[cell]] = i;
+                cellEnds[cell] += 1;
+            }
+        }
+    }
+    delete [] cellEnds;
+}
+
+SuperpixelSpatialIndex::~SuperpixelSpatialIndex(void) {
+    if(boxes != 0) {
+        delete [] boxes;
+        boxes = 0;
+    }
+    if(cellOffsets != 0) {
+        delete [] cellOffsets;
+        cellOffsets = 0;
+    }
+    if(cellEntries != 0) {
+        delete [] cellEntries;
+        cellEntries = 0;
+    }
+}
+
+pxind SuperpixelSpatialIndex::at(const QPoint &p) const {
+    if(p.x() < 0 || p.y() < 0 || p.x() >= width || p.y() >= height) {
+        return SUPERPIXELSPATIALINDEX_NONE;
+    }
+    return labels[p.y() * width + p.x()];
+}
+
+void SuperpixelSpatialIndex::intersecting(const QRect &rect, QVector<pxind> &result) const {
+    result.clear();
+    QRect clipped = rect.intersected(QRect(0, 0, width, height));
+    if(clipped.isEmpty()) {
+        return;
+    }
+
+    pxind first[2] = {0};
+    pxind last[2] = {0};
+    cellRange(clipped, first, last);
+    const pxind *entry = 0;
+    const pxind *end = 0;
+    QRect overlap;
+    for(pxind row = first[1]; row <= last[1]; row += 1) {
+        for(pxind column = first[0]; column <= last[0]; column += 1) {
+            entry = cellEntries + cellOffsets[row * nColumns + column];
+            end = cellEntries + cellOffsets[row * nColumns + column + 1];
+            for(; entry != end; ++entry) {
+                overlap = boxes[*entry].intersected(clipped);
+                if(overlap.isEmpty()) {
+                    continue;
+                }
+                /* A superpixel is registered in all cells overlapped by its bounding box.
+                 * Report it only from the cell containing the top-left corner of its
+                 * overlap with the rectangle, to avoid duplicates.
+                 */
+                if((overlap.left() / cellSize) == column && (overlap.top() / cellSize) == row) {
+                    result.append(*entry);
+                }
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+}
+
+QSize SuperpixelSpatialIndex::gridSize(void) const {
+    return QSize(nColumns, nRows);
+}
+
+void SuperpixelSpatialIndex::cellRange(const QRect &rect, pxind (&first)[2], pxind (&last)[2]) const {
+    first[0] = rect.left() / cellSize;
+    first[1] = rect.top() / cellSize;
+    last[0] = rect.right() / cellSize;
+    last[1] = rect.bottom() / cellSize;
+}
@@ -0,0 +1,160 @@
+#ifndef SUPERPIXELSPATIALINDEX_H
+#define SUPERPIXELSPATIALINDEX_H
+
+/*!
+** \file superpixelspatialindex.h
+** \brief Definition of the SuperpixelSpatialIndex class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QPoint>
+#include <QRect>
+#include <QSize>
+#include <QVector>
+#include "superpixelstatistics.h"
+
+/*!
+  \brief The result of a point query outside the image
+
+  This is equal to #SUPERPIXELLATION_NONE_LABEL.
+ */
+#define SUPERPIXELSPATIALINDEX_NONE (-1)
+
+/*!
+  \brief The side length of a grid cell, as a multiple of the side length
+  of a square with the average superpixel area
+
+  Larger cells reduce the number of cells each superpixel is registered in,
+  whereas smaller cells reduce the number of candidates examined per query.
+ */
+#define SUPERPIXELSPATIALINDEX_CELL_SCALE 2.0
+
+/*!
+ * \brief A uniform grid over the bounding boxes of the superpixels of an image,
+ * for retrieving superpixels by location
+ *
+ * Each superpixel is registered in every grid cell overlapped by its bounding box
+ * (SuperpixelStatistics::Statistics::boundingBox()). The superpixels registered in
+ * each cell are stored in compressed sparse row form. Grid cells are sized relative
+ * to the average superpixel size, such that each superpixel overlaps only
+ * a few cells.
+ *
+ * Point queries are answered directly from the superpixel label map.
+ */
+class SuperpixelSpatialIndex
+{
+public:
+    /*!
+     * \brief Build an index
+     * \param [in] width The width of the image
+     * \param [in] height The height of the image
+     * \param [in] labels An array with `width * height` elements, where
+     * the element at index `k` stores the superpixel ID of the pixel
+     * at 1D coordinate `k`. The array must outlive this object.
+     * \param [in] statistics The statistics of the superpixels in `labels`,
+     * providing the bounding boxes of the superpixels
+     */
+    SuperpixelSpatialIndex(const pxind &width,
+            const pxind &height,
+            const pxind* const labels,
+            const SuperpixelStatistics &statistics
+        );
+
+    ~SuperpixelSpatialIndex(void);
+
+    /*!
+     * \brief Find the superpixel containing a pixel
+     * \param [in] p The pixel coordinates
+     * \return The ID of the superpixel containing `p`, or
+     * #SUPERPIXELSPATIALINDEX_NONE if `p` is outside the image
+     */
+    pxind at(const QPoint &p) const;
+
+    /*!
+     * \brief Find the superpixels whose bounding boxes intersect a rectangle
+     *
+     * The result is conservative: A superpixel's bounding box may intersect
+     * the rectangle when none of its pixels are inside the rectangle.
+     * \param [in] rect The rectangle, in pixel coordinates
+     * \param [out] result The IDs of the superpixels, in ascending order.
+     * Existing contents are discarded.
+     */
+    void intersecting(const QRect &rect, QVector<pxind> &result) const;
+
+    /*!
+     * \brief The number of grid cells in the horizontal and vertical directions
+     * \return The grid dimensions
+     */
+    QSize gridSize(void) const;
+
+private:
+    /*!
+     * \brief Compute the range of grid cells overlapped by a rectangle
+     * \param [in] rect A rectangle, which must be within the image
+     * \param [out] first The column and row of the top-left cell
+     * \param [out] last The column and row of the bottom-right cell
+     */
+    void cellRange(const QRect &rect, pxind (&first)[2], pxind (&last)[2]) const;
+
+    /*!
+     * \brief The width of the image
+     */
+    const pxind width;
+    /*!
+     * \brief The height of the image
+     */
+    const pxind height;
+    /*!
+     * \brief The superpixel IDs of the pixels in the image
+     */
+    const pxind* const labels;
+    /*!
+     * \brief The bounding boxes of the superpixels
+     */
+    QRect *boxes;
+    /*!
+     * \brief The number of superpixels
+     */
+    const pxind nLabels;
+    /*!
+     * \brief The side length of a grid cell, in pixels
+     */
+    pxind cellSize;
+    /*!
+     * \brief The number of grid columns
+     */
+    pxind nColumns;
+    /*!
+     * \brief The number of grid rows
+     */
+    pxind nRows;
+    /*!
+     * \brief The start of the range of each cell's superpixels in
+     * SuperpixelSpatialIndex::cellEntries
+     *
+     * This array has `nColumns * nRows + 1` elements, and cells are
+     * stored in raster order.
+     */
+    pxind *cellOffsets;
+    /*!
+     * \brief The IDs of the superpixels registered in each cell, grouped by cell,
+     * in ascending order within each cell
+     */
+    pxind *cellEntries;
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    SuperpixelSpatialIndex(const SuperpixelSpatialIndex& other);
+    SuperpixelSpatialIndex& operator=(const SuperpixelSpatialIndex& other);
+};
+
+#endif // SUPERPIXELSPATIALINDEX_H
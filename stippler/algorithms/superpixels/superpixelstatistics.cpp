@@ -0,0 +1,214 @@
+/*!
+** \file superpixelstatistics.cpp
+** \brief Implementation of the SuperpixelStatistics class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** See superpixelstatistics.h
+*/
+
+#include <algorithm>
+#include <limits>
+#include "superpixelstatistics.h"
+#include "taskscheduler.h"
+
+SuperpixelStatistics::Statistics::Statistics(void) :
+    count(0),
+    boundaryCount(0)
+{
+    std::fill(minXY, minXY + 2, std::numeric_limits<pxind>::max());
+    std::fill(maxXY, maxXY + 2, std::numeric_limits<pxind>::min());
+    std::fill(sumXY, sumXY + 2, 0);
+    std::fill(sumRGB, sumRGB + 3, 0);
+    std::fill(meanLab, meanLab + 3, 0.0);
+    std::fill(m2Lab, m2Lab + 3, 0.0);
+}
+
+void SuperpixelStatistics::Statistics::add(const pxind &x, const pxind &y, const bool isBoundary,
+        const uchar &r, const uchar &g, const uchar &b,
+        const qreal (&lab)[3]) {
+    count += 1;
+    if(isBoundary) {
+        boundaryCount += 1;
+    }
+    minXY[0] = std::min(minXY[0], x);
+    minXY[1] = std::min(minXY[1], y);
+    maxXY[0] = std::max(maxXY[0], x);
+    maxXY[1] = std::max(maxXY[1], y);
+    sumXY[0] += x;
+    sumXY[1] += y;
+    sumRGB[0] += r;
+    sumRGB[1] += g;
+    sumRGB[2] += b;
+
+    // Welford's algorithm
+    qreal delta = 0.0;
+    for(int j = 0; j < 3; j += 1) {
+        delta = lab[j] - meanLab[j];
+        meanLab[j] += delta / static_cast<qreal>(count);
+        m2Lab[j] += delta * (lab[j] - meanLab[j]);
+    }
+}
+
+void SuperpixelStatistics::Statistics::merge(const Statistics &other) {
+    if(other.count == 0) {
+        return;
+    }
+    pxind combinedCount = count + other.count;
+    qreal weight = static_cast<qreal>(count) * static_cast<qreal>(other.count) /
+            static_cast<qreal>(combinedCount);
+    qreal otherFraction = static_cast<qreal>(other.count) / static_cast<qreal>(combinedCount);
+
+    // Chan et al.'s formula
+    qreal delta = 0.0;
+    for(int j = 0; j < 3; j += 1) {
+        delta = other.meanLab[j] - meanLab[j];
+        meanLab[j] += delta * otherFraction;
+        m2Lab[j] += other.m2Lab[j] + delta * delta * weight;
+    }
+
+    count = combinedCount;
+    boundaryCount += other.boundaryCount;
+    for(int j = 0; j < 2; j += 1) {
+        minXY[j] = std::min(minXY[j], other.minXY[j]);
+        maxXY[j] = std::max(maxXY[j], other.maxXY[j]);
+    }
+    sumXY[0] += other.sumXY[0];
+    sumXY[1] += other.sumXY[1];
+    for(int j = 0; j < 3; j += 1) {
+        sumRGB[j] += other.sumRGB[j];
+    }
+}
+
+void SuperpixelStatistics::Statistics::boundingBox(QRect &r) const {
+    if(count == 0) {
+        r = QRect();
+    } else {
+        r = QRect(QPoint(minXY[0], minXY[1]), QPoint(maxXY[0], maxXY[1]));
+    }
+}
+
+SuperpixelStatistics::SuperpixelStatistics(ImageData &img, const pxind * const labels, const pxind &n) :
+    table(0),
+    nLabels(n),
+    shareTable(false)
+{
+    /* Channels are computed lazily by ImageData, which is not thread-safe.
+     * Make sure they exist before starting any threads.
+     */
+    Input input;
+    input.width = img.width();
+    input.height = img.height();
+    input.labels = labels;
+    input.channels[0] = img.red();
+    input.channels[1] = img.green();
+    input.channels[2] = img.blue();
+    input.labChannels[0] = img.lStar();
+    input.labChannels[1] = img.aStar();
+    input.labChannels[2] = img.bStar();
+
+    pxind height = input.height;
+    int nThreads = std::min(
+                TaskScheduler::instance().threadCount(),
+                static_cast<int>(height / SUPERPIXELSTATISTICS_MIN_ROWS_PER_THREAD)
+            );
+    if(nThreads < 1) {
+        nThreads = 1;
+    }
+
+    // The first strip is accumulated directly into the final table
+    Statistics **threadTables = new Statistics*[nThreads];
+    Statistics *combinedTable = new Statistics[nLabels];
+    threadTables[0] = combinedTable;
+    for(int i = 1; i < nThreads; i += 1) {
+        threadTables[i] = new Statistics[nLabels];
+    }
+
+    TaskScheduler::instance().parallelFor(
+                0,
+                nThreads,
+                1,
+                [&](pxind startStrip, pxind endStrip) {
+                    for(pxind i = startStrip; i < endStrip; i += 1) {
+                        accumulateRows(
+                                threadTables[i],
+                                &input,
+                                (height * i) / nThreads,
+                                (height * (i + 1)) / nThreads
+                            );
+                    }
+                }
+            );
+
+    for(int i = 1; i < nThreads; i += 1) {
+        for(pxind label = 0; label < nLabels; label += 1) {
+            combinedTable[label].merge(threadTables[i][label]);
+        }
+        delete [] threadTables[i];
+    }
+    delete [] threadTables;
+    table = combinedTable;
+}
+
+SuperpixelStatistics::SuperpixelStatistics(const Statistics * const t, const pxind &n) :
+    table(t),
+    nLabels(n),
+    shareTable(true)
+{}
+
+SuperpixelStatistics::~SuperpixelStatistics(void) {
+    if(!shareTable && table != 0) {
+        delete [] table;
+        table = 0;
+    }
+}
+
+const SuperpixelStatistics::Statistics& SuperpixelStatistics::operator[](const pxind &label) const {
+    Q_ASSERT(label >= 0 && label < nLabels);
+    return table[label];
+}
+
+pxind SuperpixelStatistics::size(void) const {
+    return nLabels;
+}
+
+void SuperpixelStatistics::accumulateRows(Statistics *table,
+        const Input *input,
+        const pxind startY,
+        const pxind endY
+    ) {
+    pxind width = input->width;
+    pxind height = input->height;
+    const pxind *labels = input->labels;
+    const uchar* const *channels = input->channels;
+    const qreal* const *labChannels = input->labChannels;
+    pxind k = startY * width;
+    pxind label = 0;
+    bool isBoundary = false;
+    qreal lab[3] = {0};
+    for(pxind y = startY; y < endY; y += 1) {
+        if(TaskScheduler::cancellationRequested()) {
+            return;
+        }
+        for(pxind x = 0; x < width; x += 1) {
+            label = labels[k];
+            isBoundary = (x == 0) || (y == 0) || (x == (width - 1)) || (y == (height - 1));
+            if(!isBoundary) {
+                isBoundary = (labels[k - 1] != label) || (labels[k + 1] != label) ||
+                        (labels[k - width] != label) || (labels[k + width] != label);
+            }
+            for(int j = 0; j < 3; j += 1) {
+                lab[j] = labChannels[j][k];
+            }
+            table[label].add(x, y, isBoundary,
+                    channels[0][k], channels[1][k], channels[2][k], lab);
+            k += 1;
+        }
+    }
+}
@@ -0,0 +1,224 @@
+#ifndef SUPERPIXELSTATISTICS_H
+#define SUPERPIXELSTATISTICS_H
+
+/*!
+** \file superpixelstatistics.h
+** \brief Definition of the SuperpixelStatistics class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** - Welford's online algorithm for computing the variance:
+**   https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Welford's_online_algorithm
+** - Chan et al.'s formula for combining variances computed on separate
+**   sets of samples:
+**   https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Parallel_algorithm
+*/
+
+#include <QRect>
+#include "imagedata.h"
+
+/*!
+  \brief The minimum number of image rows processed by a single thread
+  when computing superpixel statistics
+
+  Small images are processed by fewer threads, as the cost of
+  merging per-thread statistics would outweigh the benefits.
+ */
+#define SUPERPIXELSTATISTICS_MIN_ROWS_PER_THREAD 64
+
+/*!
+ * \brief Statistics of the pixels in each superpixel of an image
+ *
+ * All statistics are computed in a single raster-order pass over a superpixel
+ * label map and the corresponding image channels. The image is divided into
+ * horizontal strips of rows, one per TaskScheduler thread, each of which is
+ * processed into its own table of statistics. The per-strip tables are then merged.
+ */
+class SuperpixelStatistics
+{
+public:
+    /*!
+     * \brief Statistics of a single superpixel
+     */
+    struct Statistics {
+        /*!
+         * \brief Construct an instance describing an empty set of pixels
+         */
+        Statistics(void);
+
+        /*!
+         * \brief Add a pixel to the set of pixels described by this object
+         * \param [in] x The horizontal coordinate of the pixel
+         * \param [in] y The vertical coordinate of the pixel
+         * \param [in] isBoundary Whether the pixel is on the boundary of the superpixel
+         * \param [in] r The red channel value of the pixel
+         * \param [in] g The green channel value of the pixel
+         * \param [in] b The blue channel value of the pixel
+         * \param [in] lab The CIE L*a*b* colour of the pixel
+         */
+        void add(const pxind &x, const pxind &y, const bool isBoundary,
+                 const uchar &r, const uchar &g, const uchar &b,
+                 const qreal (&lab)[3]);
+
+        /*!
+         * \brief Combine the statistics of a disjoint set of pixels
+         * with the statistics in this object
+         * \param [in] other Statistics of pixels not described by this object
+         */
+        void merge(const Statistics &other);
+
+        /*!
+         * \brief The bounding box of the pixels
+         * \param [out] r The smallest rectangle containing all of the pixels,
+         * or a null rectangle if there are no pixels
+         */
+        void boundingBox(QRect &r) const;
+
+        /*!
+         * \brief The number of pixels
+         */
+        pxind count;
+        /*!
+         * \brief The number of pixels whose four neighbours include pixels
+         * from other superpixels, or which are on the image border
+         */
+        pxind boundaryCount;
+        /*!
+         * \brief The minimum horizontal and vertical coordinates of the pixels
+         *
+         * For an empty set of pixels, these are larger than the maximum coordinates.
+         */
+        pxind minXY[2];
+        /*!
+         * \brief The maximum horizontal and vertical coordinates of the pixels
+         */
+        pxind maxXY[2];
+        /*!
+         * \brief The sums of the horizontal and vertical coordinates of the pixels
+         */
+        qint64 sumXY[2];
+        /*!
+         * \brief The sums of the red, green, and blue channel values of the pixels
+         */
+        qint64 sumRGB[3];
+        /*!
+         * \brief The mean CIE L*a*b* colour of the pixels
+         */
+        qreal meanLab[3];
+        /*!
+         * \brief The sums of squared differences of the pixels' CIE L*a*b*
+         * colour channels from their means
+         */
+        qreal m2Lab[3];
+    };
+
+    /*!
+     * \brief Compute superpixel statistics
+     * \param [in] img The image which was segmented into superpixels
+     * \param [in] labels An array with the same number of elements as
+     * `img.pixelCount()` (ImageData::pixelCount()), where the element at index
+     * `k` stores the superpixel ID of the pixel at 1D coordinate `k`.
+     * Superpixel IDs must be in the range `[0, nLabels)`.
+     * \param [in] nLabels The number of superpixels
+     */
+    SuperpixelStatistics(ImageData &img, const pxind* const labels, const pxind &nLabels);
+
+    /*!
+     * \brief Create a view of a table of statistics computed previously
+     *
+     * This object does not take ownership of `table`, which must outlive it.
+     * It is used to access statistics stored in a memory-mapped file
+     * (see SuperpixellationFile).
+     * \param [in] table The statistics of each superpixel, indexed by superpixel ID
+     * \param [in] nLabels The number of elements in `table`
+     */
+    SuperpixelStatistics(const Statistics* const table, const pxind &nLabels);
+
+    ~SuperpixelStatistics(void);
+
+    /*!
+     * \brief Access the statistics of a superpixel
+     * \param [in] label The superpixel ID
+     * \return The statistics of the superpixel
+     */
+    const Statistics& operator[](const pxind &label) const;
+
+    /*!
+     * \brief The number of superpixels described by this object
+     * \return The number of superpixels
+     */
+    pxind size(void) const;
+
+private:
+    /*!
+     * \brief The data read by all threads computing statistics
+     */
+    struct Input {
+        /*!
+         * \brief The width of the image
+         */
+        pxind width;
+        /*!
+         * \brief The height of the image
+         */
+        pxind height;
+        /*!
+         * \brief The superpixel IDs of the pixels in the image
+         */
+        const pxind *labels;
+        /*!
+         * \brief The red, green, and blue channels of the image
+         */
+        const uchar *channels[3];
+        /*!
+         * \brief The CIE L*a*b* channels of the image
+         */
+        const qreal *labChannels[3];
+    };
+
+    /*!
+     * \brief Accumulate statistics over a range of image rows
+     *
+     * This function is run concurrently on disjoint ranges of rows.
+     * \param [out] table The table of statistics into which to accumulate
+     * the statistics of the pixels in the rows, which must not be accessed
+     * by other threads
+     * \param [in] input The image data and superpixel labels
+     * \param [in] startY The first row to process
+     * \param [in] endY The row at which to end processing
+     */
+    static void accumulateRows(Statistics *table,
+            const Input *input,
+            const pxind startY,
+            const pxind endY
+        );
+
+    /*!
+     * \brief The statistics of each superpixel, indexed by superpixel ID
+     */
+    const Statistics *table;
+
+    /*!
+     * \brief The number of elements in SuperpixelStatistics::table
+     */
+    const pxind nLabels;
+
+    /*!
+     * \brief Indicates whether or not SuperpixelStatistics::table is owned by this object,
+     * for memory management purposes
+     */
+    const bool shareTable;
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    SuperpixelStatistics(const SuperpixelStatistics& other);
+    SuperpixelStatistics& operator=(const SuperpixelStatistics& other);
+};
+
+#endif // SUPERPIXELSTATISTICS_H
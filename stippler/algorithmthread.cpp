@@ -53,23 +53,23 @@
 ** --------------------------------------
 */
 
+#include <utility>
 #include "algorithmthread.h"
 #include "algorithms/algorithm.h"
 #include "imagedata.h"
+#include "resultcache.h"
+#include "taskscheduler.h"
 
 AlgorithmThread::AlgorithmThread(QObject *parent) : QThread(parent),
-    m_abort(false), alg(0)
+    cancellation(), alg(0), cache(0)
 {
 }
 
 AlgorithmThread::~AlgorithmThread() {
-    mutex.lock();
-    m_abort = true;
-    mutex.unlock();
-
-    cleanupAlgorithm();
-
+    cancellation.cancel();
+    // The algorithm is in use until the thread stops
     wait();
+    cleanupAlgorithm();
 }
 
 void AlgorithmThread::processImages(Algorithm *& algorithm, const QVector<QImage> &images)
@@ -77,12 +77,9 @@ void AlgorithmThread::processImages(Algorithm *& algorithm, const QVector<QImage
     // Expect at least one image
     Q_ASSERT(images.size() > 0 && !images[0].isNull());
 
-    // Locking here is not necessary, but is future-proof
-    mutex.lock();
-    m_abort = false;
-    mutex.unlock();
-
+    cancellation.reset();
     cleanupAlgorithm();
+    progressChannel.clear();
 
     alg = algorithm;
     algorithm = 0;
@@ -90,21 +87,72 @@ void AlgorithmThread::processImages(Algorithm *& algorithm, const QVector<QImage
     start();
 }
 
+void AlgorithmThread::setResultCache(ResultCache *c)
+{
+    cache = c;
+}
+
+const AlgorithmProgress &AlgorithmThread::progress(void) const
+{
+    return progressChannel;
+}
+
 void AlgorithmThread::stopProcess()
 {
-    mutex.lock();
-    m_abort = true;
-    mutex.unlock();
+    cancellation.cancel();
 }
 
 void AlgorithmThread::run() {
+    TaskScheduler::setCancellationToken(&cancellation);
+    process();
+    TaskScheduler::setCancellationToken(0);
+
+    /* Release the algorithm's state and the input images now, rather than
+     * when the next job starts, as an idle thread may be kept for a long time.
+     */
+    cleanupAlgorithm();
+    m_images.clear();
+}
+
+void AlgorithmThread::process() {
     QVector<ImageData*>* input = new QVector<ImageData*>;
 
     foreach(const QImage &img, m_images) {
           input->append(new ImageData(img));
     }
+
+    alg->setProgressChannel(&progressChannel);
+    alg->setCancellationToken(&cancellation);
+
+    QString key;
+    if(cache != 0) {
+        QString signature = alg->parameterSignature();
+        if(!signature.isEmpty()) {
+            QVector<QByteArray> imageHashes;
+            foreach(ImageData *img, *input) {
+                imageHashes.append(ResultCache::imageHash(*img));
+            }
+            key = ResultCache::key(imageHashes, signature);
+            QImage cachedImage;
+            QByteArray cachedSvgOutput;
+            if(cache->lookupOutput(key, cachedImage, cachedSvgOutput)) {
+                foreach(ImageData *img, *input) {
+                    delete img;
+                }
+                delete input;
+                input = 0;
+                emit sendStatus(tr("Retrieved the result from the cache."));
+                AlgorithmResultPair pair(cachedImage, cachedSvgOutput);
+                emit sendOutput(pair);
+                return;
+            }
+        }
+        alg->setResultCache(cache);
+    }
+
+    // The algorithm takes ownership of the input images, even if initialization fails
     if(alg->initialize(input)) {
-        if (m_abort) {
+        if(cancellation.isCancelled()) {
             return;
         }
 
@@ -112,58 +160,49 @@ void AlgorithmThread::run() {
         bool ok = true;
         QString status;
         while(!finished && ok) {
-            ok = alg->increment(finished, status);
-            if (m_abort) {
+            ok = alg->timedIncrement(finished, status);
+            if(cancellation.isCancelled()) {
                 return;
             }
-            if(ok) {
+            if(ok && !status.isEmpty()) {
+                progressChannel.clear();
                 emit sendStatus(status);
             }
         }
         if(ok) {
+            emit sendProfile(alg->profile());
             QImage* outputImage = 0;
             QByteArray* svgOutputPtr = 0;
             ok = alg->output(outputImage, svgOutputPtr);
-            if (m_abort) {
-                if(outputImage != 0) {
-                    delete outputImage;
-                    outputImage = 0;
-                }
-                if(svgOutputPtr != 0) {
-                    delete svgOutputPtr;
-                    svgOutputPtr = 0;
-                }
-                return;
-            }
-            if(ok) {
+            const bool cancelled = cancellation.isCancelled();
+            if(ok && !cancelled) {
                 QByteArray svgOutput;
                 if(svgOutputPtr != 0) {
-                    svgOutput = *svgOutputPtr;
+                    svgOutput = std::move(*svgOutputPtr);
                 }
-                AlgorithmResultPair pair(*outputImage, svgOutput);
-                if(outputImage != 0) {
-                    delete outputImage;
-                    outputImage = 0;
-                }
-                if(svgOutputPtr != 0) {
-                    delete svgOutputPtr;
-                    svgOutputPtr = 0;
+                if(!key.isEmpty()) {
+                    cache->storeOutput(key, *outputImage, svgOutput);
                 }
+                // The queued signal then holds the only reference to the output
+                AlgorithmResultPair pair(std::move(*outputImage), std::move(svgOutput));
                 emit sendOutput(pair);
+            }
+            if(outputImage != 0) {
+                delete outputImage;
+                outputImage = 0;
+            }
+            if(svgOutputPtr != 0) {
+                delete svgOutputPtr;
+                svgOutputPtr = 0;
+            }
+            if(ok || cancelled) {
                 return; // Success - All done
-            } else {
-                if(outputImage != 0) {
-                    delete outputImage;
-                    outputImage = 0;
-                }
-                if(svgOutputPtr != 0) {
-                    delete svgOutputPtr;
-                    svgOutputPtr = 0;
-                }
             }
         }
     }
-    emit sendFail();
+    if(!cancellation.isCancelled()) {
+        emit sendFail();
+    }
 }
 
 void AlgorithmThread::cleanupAlgorithm() {
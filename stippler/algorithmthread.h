@@ -58,12 +58,15 @@
 */
 
 #include <QThread>
-#include <QMutex>
 #include <QImage>
 #include <QVector>
 #include "algorithmresultpair.h"
+#include "algorithms/algorithmprofile.h"
+#include "algorithmprogress.h"
+#include "cancellationtoken.h"
 
 class Algorithm;
+class ResultCache;
 
 /*!
  * \brief A worker thread which will perform image processing operations
@@ -93,9 +96,35 @@ public:
      */
     void processImages(Algorithm *& algorithm, const QVector<QImage> &images);
 
+    /*!
+     * \brief Set the cache used to retrieve and store algorithm results
+     *
+     * If the cache contains the output of an algorithm with the same parameters
+     * (Algorithm::parameterSignature()) for the same input images,
+     * the cached output is sent instead of running the algorithm. Otherwise, the
+     * cache is passed to the algorithm (Algorithm::setResultCache()), and its output
+     * is stored in the cache.
+     * \param [in] cache The cache, which is not owned by this object, and must outlive it.
+     * Passing null disables caching.
+     */
+    void setResultCache(ResultCache *cache);
+
+    /*!
+     * \brief Access the progress of the current image processing operation
+     *
+     * The progress of loops over pixels or superpixels is published to this
+     * channel rather than being sent with sendStatus(), and is meant to be
+     * polled periodically by the GUI thread.
+     * \return The channel to which the algorithm publishes its progress
+     */
+    const AlgorithmProgress &progress(void) const;
+
 signals:
     /*!
      * \brief Provide a status update regarding the current state of processing
+     *
+     * This signal is only emitted for status messages marking the completion
+     * of phases of processing. Progress within phases is available through progress().
      * \param [out] status Status message to display
      */
     void sendStatus(const QString &status);
@@ -113,12 +142,26 @@ signals:
      */
     void sendOutput(const AlgorithmResultPair &pair);
 
+    /*!
+     * \brief Transfer the per-phase measurements of the image processing algorithm
+     *
+     * This signal is emitted just before sendOutput(), unless the output
+     * was retrieved from the cache.
+     * \param [out] profile The algorithm's measurements
+     */
+    void sendProfile(const AlgorithmProfile &profile);
+
 public slots:
     /*!
      * \brief Abort the current image processing algorithm's execution
      *
+     * The algorithm stops at the next processing increment boundary, or at the
+     * next task boundary of a loop run by TaskScheduler, whichever comes first.
+     * The thread then deletes the algorithm and its input images, and finishes
+     * without emitting sendOutput() or sendFail().
+     *
      * processImages() must be called again to restart processing (the current
-     * state of the algorithm is lost).
+     * state of the algorithm is lost). This function is thread-safe.
      */
     void stopProcess();
 
@@ -129,13 +172,22 @@ protected:
     void run() Q_DECL_OVERRIDE;
 
 private:
+    /*!
+     * \brief Run the algorithm and emit its outcome
+     *
+     * Called by run(), which releases the algorithm afterwards, whichever
+     * way this function returns.
+     */
+    void process();
+
     void cleanupAlgorithm();
 
 private:
-    bool m_abort;
+    CancellationToken cancellation;
     Algorithm* alg;
     QVector<QImage> m_images;
-    QMutex mutex;
+    ResultCache* cache;
+    AlgorithmProgress progressChannel;
 };
 
 #endif // ALGORITHMTHREAD_H
@@ -0,0 +1,86 @@
+/*!
+** \file batchpipeline.cpp
+** \brief Implementations of the ImageDecoder and ImageEncoder classes.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QBuffer>
+#include <QFile>
+#include <QImageReader>
+#include "batchpipeline.h"
+
+ImageDecoder::ImageDecoder(const QStringList &f, BoundedQueue<DecodedImage> *o,
+                           QObject *parent) :
+    QThread(parent), files(f), output(o)
+{}
+
+void ImageDecoder::run() {
+    foreach(const QString &file, files) {
+        DecodedImage decoded;
+        decoded.file = file;
+        QImageReader reader(file);
+        decoded.image = reader.read();
+        if(decoded.image.isNull()) {
+            decoded.error = reader.errorString();
+        }
+        if(!output->push(decoded)) {
+            return;
+        }
+        emit imageDecoded();
+    }
+}
+
+ImageEncoder::ImageEncoder(BoundedQueue<EncodeRequest> *i, QObject *parent) :
+    QThread(parent), input(i)
+{}
+
+void ImageEncoder::run() {
+    EncodeRequest request;
+    while(input->pop(request)) {
+        // The image data should not have been duplicated on its way from the algorithm
+        Q_ASSERT(request.pair.hasOriginalImageData());
+        if(request.imagePath.isEmpty()) {
+            encodeAsText(request);
+            continue;
+        }
+        bool succeeded = request.pair.image().save(request.imagePath);
+        const QByteArray svgData = request.pair.svgData();
+        if(succeeded && !svgData.isEmpty()) {
+            QFile svgFile(request.svgPath);
+            succeeded = svgFile.open(QIODevice::WriteOnly) &&
+                    (svgFile.write(svgData) == svgData.size());
+        }
+        const int job = request.job;
+        // Release the output before waiting for the next request
+        request = EncodeRequest();
+        emit imageEncoded(job, succeeded);
+    }
+}
+
+void ImageEncoder::encodeAsText(EncodeRequest &request) {
+    QByteArray png;
+    QBuffer buffer(&png);
+    buffer.open(QIODevice::WriteOnly);
+    const bool succeeded = request.pair.image().save(&buffer, "PNG");
+    buffer.close();
+    QByteArray image;
+    QByteArray svg;
+    if(succeeded) {
+        image = png.toBase64();
+        svg = request.pair.svgData().toBase64();
+    }
+    png.clear();
+    const int job = request.job;
+    // Release the output before waiting for the next request
+    request = EncodeRequest();
+    emit imageEncodedAsText(job, succeeded, image, svg);
+}
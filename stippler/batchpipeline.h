@@ -0,0 +1,163 @@
+#ifndef BATCHPIPELINE_H
+#define BATCHPIPELINE_H
+
+/*!
+** \file batchpipeline.h
+** \brief Definitions of the ImageDecoder and ImageEncoder classes,
+** the input and output stages of batch processing.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include "algorithmresultpair.h"
+#include "boundedqueue.h"
+
+/*!
+ * \brief An input image file, after decoding
+ */
+struct DecodedImage {
+    QString file;
+    /*!
+     * \brief The image, or a null image if the file could not be read
+     */
+    QImage image;
+    /*!
+     * \brief A description of the reason the file could not be read
+     */
+    QString error;
+};
+
+/*!
+ * \brief An algorithm's output, to be encoded and written to disk
+ */
+struct EncodeRequest {
+    /*!
+     * \brief An identifier which is passed back to the receiver of ImageEncoder::imageEncoded()
+     */
+    int job;
+    /*!
+     * \brief The path of the image file, or an empty string to encode the output
+     * in memory, and pass it to the receiver of ImageEncoder::imageEncodedAsText()
+     */
+    QString imagePath;
+    /*!
+     * \brief The path of the vector output file, used only if the output has SVG data
+     */
+    QString svgPath;
+    AlgorithmResultPair pair;
+};
+
+/*!
+ * \brief A thread which reads and decodes a list of image files in order
+ *
+ * Decoded images are appended to a BoundedQueue, so decoding stops
+ * once the consumer falls sufficiently far behind.
+ */
+class ImageDecoder : public QThread
+{
+    Q_OBJECT
+
+public:
+    /*!
+     * \brief Prepare to decode image files
+     * \param [in] files The image files to decode
+     * \param [in] output The queue to which decoded images are appended.
+     * It is not owned by this object, and must outlive the thread.
+     * Closing it stops the thread.
+     * \param [in] parent The parent object which takes ownership of this object
+     */
+    ImageDecoder(const QStringList &files, BoundedQueue<DecodedImage> *output,
+                 QObject *parent = 0);
+
+signals:
+    /*!
+     * \brief Emitted after each image is added to the output queue
+     */
+    void imageDecoded();
+
+protected:
+    void run() Q_DECL_OVERRIDE;
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    ImageDecoder(const ImageDecoder& other);
+    ImageDecoder& operator=(const ImageDecoder& other);
+
+    // Data members
+private:
+    QStringList files;
+    BoundedQueue<DecodedImage> *output;
+};
+
+/*!
+ * \brief A thread which encodes algorithm outputs and writes them to disk
+ *
+ * The thread processes requests from a BoundedQueue until the queue is closed
+ * and empty.
+ */
+class ImageEncoder : public QThread
+{
+    Q_OBJECT
+
+public:
+    /*!
+     * \brief Prepare to encode images
+     * \param [in] input The queue of requests. It is not owned by this object,
+     * and must outlive the thread.
+     * \param [in] parent The parent object which takes ownership of this object
+     */
+    ImageEncoder(BoundedQueue<EncodeRequest> *input, QObject *parent = 0);
+
+signals:
+    /*!
+     * \brief Emitted after each request has been processed
+     * \param [out] job The value of EncodeRequest::job
+     * \param [out] succeeded Whether all output files were written successfully
+     */
+    void imageEncoded(int job, bool succeeded);
+
+    /*!
+     * \brief Emitted, instead of imageEncoded(), after each request with an empty
+     * EncodeRequest::imagePath has been processed
+     * \param [out] job The value of EncodeRequest::job
+     * \param [out] succeeded Whether the image was encoded successfully
+     * \param [out] image The image in PNG format, encoded in Base64
+     * \param [out] svg The SVG data encoded in Base64, or an empty array
+     * if the output has no SVG data
+     */
+    void imageEncodedAsText(int job, bool succeeded, QByteArray image, QByteArray svg);
+
+protected:
+    void run() Q_DECL_OVERRIDE;
+
+private:
+    /*!
+     * \brief Encode an output in memory, and emit imageEncodedAsText()
+     * \param [in,out] request The request, which is cleared
+     */
+    void encodeAsText(EncodeRequest &request);
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    ImageEncoder(const ImageEncoder& other);
+    ImageEncoder& operator=(const ImageEncoder& other);
+
+    // Data members
+private:
+    BoundedQueue<EncodeRequest> *input;
+};
+
+#endif // BATCHPIPELINE_H
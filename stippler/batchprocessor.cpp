@@ -0,0 +1,356 @@
+/*!
+** \file batchprocessor.cpp
+** \brief Implementation of the BatchProcessor class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <algorithm>
+#include <utility>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <stdio.h>
+#include "batchprocessor.h"
+#include "algorithmpool.h"
+#include "algorithmregistry.h"
+#include "resultcache.h"
+#include "algorithms/algorithm.h"
+
+BatchProcessor::BatchProcessor(const QString &a,
+                               const QStringList &i,
+                               const QStringList &e,
+                               const QString &o,
+                               const int n,
+                               const bool c,
+                               QObject *parent) :
+    QObject(parent), algorithmName(a), inputs(i), extraImageFiles(e),
+    outputDirectory(o), nJobs(n), useCache(c), printProfiles(false),
+    profileReportFile(), profileReport(), extraImages(), inputFiles(),
+    jobs(), pool(0), cache(0), decodedImages(0), encodeRequests(0), decoder(0),
+    encoder(0), decodingFinished(false), nPendingWrites(0), batchFinished(false), nSucceeded(0), nFailed(0), nUnreadable(0), totalJobTime(0),
+    timer(), out(stdout), err(stderr)
+{}
+
+BatchProcessor::~BatchProcessor(void) {
+    // Closing the queues stops the decoder, and the encoder once it has written queued outputs
+    if(decodedImages != 0) {
+        decodedImages->close();
+    }
+    if(encodeRequests != 0) {
+        encodeRequests->close();
+    }
+    if(decoder != 0) {
+        decoder->wait();
+        delete decoder;
+        decoder = 0;
+    }
+    if(encoder != 0) {
+        encoder->wait();
+        delete encoder;
+        encoder = 0;
+    }
+    if(decodedImages != 0) {
+        delete decodedImages;
+        decodedImages = 0;
+    }
+    if(encodeRequests != 0) {
+        delete encodeRequests;
+        encodeRequests = 0;
+    }
+    // The threads must stop using the cache before the cache is deleted
+    if(pool != 0) {
+        delete pool;
+        pool = 0;
+    }
+    if(cache != 0) {
+        delete cache;
+        cache = 0;
+    }
+}
+
+void BatchProcessor::setProfiling(const bool printTables, const QString &reportFile) {
+    printProfiles = printTables;
+    profileReportFile = reportFile;
+}
+
+bool BatchProcessor::start(void) {
+    Algorithm *algorithm = AlgorithmRegistry::create(algorithmName);
+    if(algorithm == 0) {
+        err << tr("Unknown algorithm \"%1\". Available algorithms: %2")
+               .arg(algorithmName, AlgorithmRegistry::names().join(", ")) << endl;
+        return false;
+    }
+    QVector<QString> imageDescriptions;
+    algorithm->additionalRequiredImages(imageDescriptions);
+    delete algorithm;
+    if(imageDescriptions.size() != extraImageFiles.size()) {
+        err << tr("The \"%1\" algorithm requires %2 additional image(s), but %3 were given.")
+               .arg(algorithmName)
+               .arg(imageDescriptions.size())
+               .arg(extraImageFiles.size()) << endl;
+        for(int i = 0; i < imageDescriptions.size(); i += 1) {
+            err << "  " << (i + 1) << ": " << imageDescriptions[i] << endl;
+        }
+        return false;
+    }
+    foreach(const QString &file, extraImageFiles) {
+        QImageReader reader(file);
+        QImage image = reader.read();
+        if(image.isNull()) {
+            err << tr("Cannot load %1: %2").arg(file, reader.errorString()) << endl;
+            return false;
+        }
+        extraImages.append(image);
+    }
+
+    if(!expandInputs(inputs, inputFiles, err)) {
+        return false;
+    }
+    if(inputFiles.isEmpty()) {
+        err << tr("No input images were found.") << endl;
+        return false;
+    }
+    if(!checkOutputPaths(inputFiles, outputDirectory, algorithmName, err)) {
+        return false;
+    }
+    if(!outputDirectory.isEmpty() && !QDir().mkpath(outputDirectory)) {
+        err << tr("Cannot create the output directory %1").arg(outputDirectory) << endl;
+        return false;
+    }
+
+    if(useCache) {
+        cache = new ResultCache(ResultCache::defaultDirectory());
+        if(!cache->isValid()) {
+            err << tr("Failed to create the result cache directory. Results will not be cached.") << endl;
+            delete cache;
+            cache = 0;
+        }
+    }
+    if(nJobs <= 0) {
+        nJobs = std::max(QThread::idealThreadCount(), 1);
+    }
+    pool = new AlgorithmPool(this, nJobs);
+    pool->setResultCache(cache);
+    connect(pool, SIGNAL(jobOutput(int,AlgorithmResultPair&)), this, SLOT(receiveOutput(int,AlgorithmResultPair&)));
+    connect(pool, SIGNAL(jobProfile(int,AlgorithmProfile)), this, SLOT(receiveProfile(int,AlgorithmProfile)));
+    connect(pool, SIGNAL(jobFailed(int)), this, SLOT(receiveFail(int)));
+    connect(pool, SIGNAL(jobCancelled(int)), this, SLOT(receiveCancelled(int)));
+
+    const int queueDepth = nJobs * BATCHPROCESSOR_QUEUE_DEPTH_PER_JOB;
+    decodedImages = new BoundedQueue<DecodedImage>(queueDepth);
+    encodeRequests = new BoundedQueue<EncodeRequest>(queueDepth);
+    decoder = new ImageDecoder(inputFiles, decodedImages);
+    encoder = new ImageEncoder(encodeRequests);
+    connect(decoder, SIGNAL(imageDecoded()), this, SLOT(submitJobs()), Qt::QueuedConnection);
+    connect(decoder, SIGNAL(finished()), this, SLOT(receiveDecodingFinished()), Qt::QueuedConnection);
+    connect(encoder, SIGNAL(imageEncoded(int,bool)), this, SLOT(receiveEncoded(int,bool)), Qt::QueuedConnection);
+
+    out << tr("Processing %1 image(s) with \"%2\"").arg(inputFiles.size()).arg(algorithmName) << endl;
+    timer.start();
+    decoder->start();
+    encoder->start();
+    return true;
+}
+
+int BatchProcessor::exitCode(void) const {
+    return (nFailed == 0) ? 0 : 1;
+}
+
+void BatchProcessor::receiveOutput(int job, AlgorithmResultPair &pair) {
+    stopJobTimer(job);
+    const QString inputFile = jobs.value(job).inputFile;
+    EncodeRequest request;
+    request.job = job;
+    request.imagePath = outputPath(inputFile, outputDirectory, algorithmName, "png");
+    request.svgPath = outputPath(inputFile, outputDirectory, algorithmName, "svg");
+    request.pair = std::move(pair);
+    /* Blocks if the encoder has fallen behind by a full queue,
+     * which stops further jobs from being submitted until it catches up.
+     */
+    nPendingWrites += 1;
+    encodeRequests->push(std::move(request));
+    submitJobs();
+}
+
+void BatchProcessor::receiveProfile(int job, const AlgorithmProfile &profile) {
+    QHash<int, JobRecord>::iterator it = jobs.find(job);
+    if(it != jobs.end()) {
+        it.value().profile = profile;
+    }
+}
+
+void BatchProcessor::receiveFail(int job) {
+    stopJobTimer(job);
+    finishJob(job, tr("algorithm failed"), false);
+    submitJobs();
+}
+
+void BatchProcessor::receiveCancelled(int job) {
+    stopJobTimer(job);
+    finishJob(job, tr("cancelled"), false);
+    submitJobs();
+}
+
+void BatchProcessor::receiveEncoded(int job, bool succeeded) {
+    nPendingWrites -= 1;
+    const QString imagePath = outputPath(jobs.value(job).inputFile, outputDirectory, algorithmName, "png");
+    if(succeeded) {
+        finishJob(job, imagePath, true);
+    } else {
+        finishJob(job, tr("failed to save %1").arg(imagePath), false);
+    }
+    finishBatch();
+}
+
+void BatchProcessor::receiveDecodingFinished(void) {
+    decodingFinished = true;
+    finishBatch();
+}
+
+bool BatchProcessor::expandInputs(const QStringList &inputs, QStringList &files, QTextStream &err) {
+    QStringList nameFilters;
+    foreach(const QByteArray &format, QImageReader::supportedImageFormats()) {
+        nameFilters.append("*." + QString::fromLatin1(format));
+    }
+    foreach(const QString &input, inputs) {
+        QFileInfo info(input);
+        if(info.isDir()) {
+            QDir dir(input);
+            QStringList entries = dir.entryList(nameFilters, QDir::Files | QDir::Readable, QDir::Name);
+            foreach(const QString &entry, entries) {
+                files.append(dir.filePath(entry));
+            }
+        } else if(info.exists()) {
+            files.append(input);
+        } else {
+            err << tr("No such file or directory: %1").arg(input) << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void BatchProcessor::submitJobs(void) {
+    DecodedImage decoded;
+    while(pool->jobCount() < nJobs && decodedImages->tryPop(decoded)) {
+        if(decoded.image.isNull()) {
+            err << tr("Cannot load %1: %2").arg(decoded.file, decoded.error) << endl;
+            nFailed += 1;
+            nUnreadable += 1;
+            continue;
+        }
+        QVector<QImage> images;
+        images.append(decoded.image);
+        images += extraImages;
+
+        Algorithm *algorithm = AlgorithmRegistry::create(algorithmName);
+        algorithm->setIncrementBudget(ALGORITHM_RUN_TO_COMPLETION);
+        JobRecord record;
+        record.inputFile = decoded.file;
+        record.startTime = timer.elapsed();
+        record.processingTime = 0;
+        record.profile = AlgorithmProfile();
+        int job = pool->submit(algorithm, images);
+        jobs.insert(job, record);
+    }
+    finishBatch();
+}
+
+void BatchProcessor::stopJobTimer(const int job) {
+    JobRecord &record = jobs[job];
+    record.processingTime = timer.elapsed() - record.startTime;
+}
+
+void BatchProcessor::finishJob(const int job, const QString &outcome, const bool succeeded) {
+    JobRecord record = jobs.take(job);
+    totalJobTime += record.processingTime;
+    if(succeeded) {
+        nSucceeded += 1;
+    } else {
+        nFailed += 1;
+    }
+    out << QString("%1 ms\t%2\t%3").arg(record.processingTime, 8).arg(record.inputFile, outcome) << endl;
+    if(record.profile.isEmpty()) {
+        return;
+    }
+    if(printProfiles) {
+        out << record.profile.toTable() << endl;
+    }
+    if(!profileReportFile.isEmpty()) {
+        QJsonObject entry;
+        entry.insert("input", record.inputFile);
+        entry.insert("processingMs", static_cast<double>(record.processingTime));
+        entry.insert("profile", record.profile.toJson());
+        profileReport.append(entry);
+    }
+}
+
+void BatchProcessor::finishBatch(void) {
+    if(batchFinished || !decodingFinished || decodedImages->size() > 0 ||
+            pool->jobCount() > 0 || nPendingWrites > 0) {
+        return;
+    }
+    batchFinished = true;
+    qint64 wallTime = timer.elapsed();
+    int nJobsRun = nSucceeded + nFailed - nUnreadable;
+    out << tr("%1 succeeded, %2 failed, in %3 ms").arg(nSucceeded).arg(nFailed).arg(wallTime) << endl;
+    if(nJobsRun > 0) {
+        out << tr("Mean time per image: %1 ms of processing, %2 ms of wall-clock time")
+               .arg(static_cast<qreal>(totalJobTime) / nJobsRun, 0, 'f', 1)
+               .arg(static_cast<qreal>(wallTime) / nJobsRun, 0, 'f', 1) << endl;
+    }
+    if(!profileReportFile.isEmpty()) {
+        QJsonObject report;
+        report.insert("algorithm", algorithmName);
+        report.insert("images", profileReport);
+        QFile file(profileReportFile);
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+                file.write(QJsonDocument(report).toJson()) < 0) {
+            err << tr("Cannot write %1: %2").arg(profileReportFile, file.errorString()) << endl;
+        }
+    }
+    emit finished();
+}
+
+QString BatchProcessor::outputPath(const QString &inputFile, const QString &outputDirectory,
+                                   const QString &algorithmName, const QString &suffix) {
+    QFileInfo info(inputFile);
+    QString name = info.completeBaseName();
+    if(!info.suffix().isEmpty()) {
+        name += QString("_%1").arg(info.suffix());
+    }
+    name += QString("_%1.%2").arg(algorithmName, suffix);
+    if(outputDirectory.isEmpty()) {
+        return info.dir().filePath(name);
+    }
+    return QDir(outputDirectory).filePath(name);
+}
+
+bool BatchProcessor::checkOutputPaths(const QStringList &inputFiles, const QString &outputDirectory,
+                                      const QString &algorithmName, QTextStream &err) {
+    QHash<QString, QString> inputForOutput;
+    QString output;
+    foreach(const QString &file, inputFiles) {
+        output = QFileInfo(outputPath(file, outputDirectory, algorithmName, "png")).absoluteFilePath();
+        if(inputForOutput.contains(output)) {
+            err << tr("%1 and %2 would both be saved as %3.")
+                   .arg(inputForOutput.value(output), file, output) << endl;
+            return false;
+        }
+        inputForOutput.insert(output, file);
+    }
+    return true;
+}
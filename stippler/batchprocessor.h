@@ -0,0 +1,294 @@
+#ifndef BATCHPROCESSOR_H
+#define BATCHPROCESSOR_H
+
+/*!
+** \file batchprocessor.h
+** \brief Definition of the BatchProcessor class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QImage>
+#include <QJsonArray>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include "algorithmresultpair.h"
+#include "algorithms/algorithmprofile.h"
+#include "batchpipeline.h"
+
+class AlgorithmPool;
+class ResultCache;
+
+/*!
+  \brief The capacity of the queues between the stages of the batch pipeline,
+  as a multiple of the number of concurrent jobs
+ */
+#define BATCHPROCESSOR_QUEUE_DEPTH_PER_JOB 1
+
+/*!
+ * \brief Headless processing of many images with a single algorithm
+ *
+ * Each input image is processed by a new instance of an algorithm from
+ * the AlgorithmRegistry, run to completion (#ALGORITHM_RUN_TO_COMPLETION)
+ * by an AlgorithmPool.
+ *
+ * Processing is a three-stage pipeline: an ImageDecoder reads the next input
+ * images, the pool processes the current images, and an ImageEncoder writes
+ * the previous outputs. Disk access and image compression therefore overlap
+ * with processing. The stages are connected by BoundedQueue objects
+ * of #BATCHPROCESSOR_QUEUE_DEPTH_PER_JOB images per job, which limits the number
+ * of images held in memory regardless of the size of the batch.
+ *
+ * Outputs are written to `<output directory>/<input base name>_<algorithm name>.png`,
+ * along with a `.svg` file if the algorithm produces vector output.
+ * A line of timing information is printed as each job finishes,
+ * followed by a summary once all jobs have finished. Optionally, the per-phase
+ * measurements of each algorithm (Algorithm::profile()) are printed as tables,
+ * and exported to a JSON file (see setProfiling()).
+ */
+class BatchProcessor : public QObject
+{
+    Q_OBJECT
+
+public:
+    /*!
+     * \brief Create a batch processing job
+     * \param [in] algorithmName The name of the algorithm in the AlgorithmRegistry
+     * \param [in] inputs Input image files, or directories, all readable image
+     * files in which are used as inputs (non-recursively)
+     * \param [in] extraImages Files containing the additional images required
+     * by the algorithm (Algorithm::additionalRequiredImages()), which are
+     * passed to the algorithm along with every input image
+     * \param [in] outputDirectory The directory in which to save output images.
+     * If empty, outputs are saved alongside the corresponding input images.
+     * \param [in] nJobs The number of images to process concurrently. If not positive,
+     * QThread::idealThreadCount() is used.
+     * \param [in] useCache Whether to retrieve and store results in the
+     * default ResultCache
+     * \param [in] parent The parent object which takes ownership of this object
+     */
+    BatchProcessor(const QString &algorithmName,
+                   const QStringList &inputs,
+                   const QStringList &extraImages,
+                   const QString &outputDirectory,
+                   const int nJobs,
+                   const bool useCache,
+                   QObject *parent = 0);
+
+    virtual ~BatchProcessor(void);
+
+    /*!
+     * \brief Report the per-phase measurements of the algorithm run on each image
+     *
+     * This function must be called before start(). No measurements are
+     * available for images whose outputs are retrieved from the cache.
+     * \param [in] printTables Whether to print a table of measurements
+     * after the line of timing information of each image
+     * \param [in] reportFile If not empty, the file to which the measurements
+     * of all images are written as JSON, once all jobs have finished.
+     * The file contains an object with the keys "algorithm" and "images",
+     * the latter being an array of objects with the keys "input",
+     * "processingMs" and "profile" (AlgorithmProfile::toJson()).
+     */
+    void setProfiling(const bool printTables, const QString &reportFile);
+
+    /*!
+     * \brief Validate the arguments and start processing
+     *
+     * Errors are printed to the standard error stream.
+     * \return `false` if processing could not be started, in which case
+     * finished() will not be emitted
+     */
+    bool start(void);
+
+    /*!
+     * \brief The process exit code summarizing the outcome of the batch
+     * \return Zero if all images were processed successfully, or one otherwise
+     */
+    int exitCode(void) const;
+
+    /*!
+     * \brief Expand directories into lists of image files
+     * \param [in] inputs Image files, or directories, all readable image
+     * files in which are included (non-recursively)
+     * \param [out] files The image files, to which the expanded inputs are appended
+     * \param [in] err The stream on which to report inputs which do not exist
+     * \return `false` if an input does not exist
+     */
+    static bool expandInputs(const QStringList &inputs, QStringList &files, QTextStream &err);
+
+    /*!
+     * \brief Determine the path of the output file for an input file
+     *
+     * The name of the output file is `<input base name>_<input suffix>_<algorithm name>.<suffix>`,
+     * so that inputs differing only in their file extensions have distinct outputs.
+     * Inputs without file extensions have outputs named
+     * `<input base name>_<algorithm name>.<suffix>`.
+     * \param [in] inputFile The input image file
+     * \param [in] outputDirectory The directory in which to save the output file.
+     * If empty, the output file is placed alongside the input file.
+     * \param [in] algorithmName The name of the algorithm in the AlgorithmRegistry
+     * \param [in] suffix The file extension of the output file
+     * \return The output file path
+     */
+    static QString outputPath(const QString &inputFile, const QString &outputDirectory,
+                              const QString &algorithmName, const QString &suffix);
+
+    /*!
+     * \brief Check that no two input files share an output file
+     *
+     * Outputs can collide when inputs with the same name are taken from
+     * several directories and saved in a single output directory.
+     * \param [in] inputFiles The input image files
+     * \param [in] outputDirectory The directory in which to save output files,
+     * as passed to outputPath()
+     * \param [in] algorithmName The name of the algorithm in the AlgorithmRegistry
+     * \param [in] err The stream on which to report the colliding inputs
+     * \return `false` if two input files share an output file
+     */
+    static bool checkOutputPaths(const QStringList &inputFiles, const QString &outputDirectory,
+                                 const QString &algorithmName, QTextStream &err);
+
+signals:
+    /*!
+     * \brief Emitted once all images have been processed
+     */
+    void finished();
+
+private slots:
+    void receiveOutput(int job, AlgorithmResultPair &pair);
+    void receiveProfile(int job, const AlgorithmProfile &profile);
+    void receiveFail(int job);
+    void receiveCancelled(int job);
+    void receiveEncoded(int job, bool succeeded);
+    void receiveDecodingFinished(void);
+
+    /*!
+     * \brief Submit decoded images as jobs until BatchProcessor::nJobs
+     * jobs are queued or running, or until no more decoded images are available
+     */
+    void submitJobs(void);
+
+private:
+    /*!
+     * \brief Record the time taken by a job to process its image
+     * \param [in] job The identifier of the job
+     */
+    void stopJobTimer(const int job);
+
+    /*!
+     * \brief Print the timing of a job whose outcome is known
+     * \param [in] job The identifier of the job
+     * \param [in] outcome A description of the outcome of the job
+     * \param [in] succeeded Whether the job succeeded
+     */
+    void finishJob(const int job, const QString &outcome, const bool succeeded);
+
+    /*!
+     * \brief Print a summary of the batch and emit finished(),
+     * if all stages of the pipeline are empty
+     */
+    void finishBatch(void);
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    BatchProcessor(const BatchProcessor& other);
+    BatchProcessor& operator=(const BatchProcessor& other);
+
+    // Data members
+private:
+    /*!
+     * \brief The timing of a job, and the file it is processing
+     */
+    struct JobRecord {
+        QString inputFile;
+        /*!
+         * \brief Time at which the job was submitted to the AlgorithmPool,
+         * relative to the start of the batch
+         *
+         * As no more jobs are submitted than the pool can run at once, jobs start
+         * as soon as they are submitted.
+         */
+        qint64 startTime;
+        /*!
+         * \brief The time taken to process the image, excluding decoding and encoding
+         */
+        qint64 processingTime;
+        AlgorithmProfile profile;
+    };
+
+    QString algorithmName;
+    QStringList inputs;
+    QStringList extraImageFiles;
+    QString outputDirectory;
+    int nJobs;
+    bool useCache;
+    bool printProfiles;
+    QString profileReportFile;
+    /*!
+     * \brief The measurements of finished jobs, to be written to
+     * BatchProcessor::profileReportFile
+     */
+    QJsonArray profileReport;
+
+    /*!
+     * \brief The additional images loaded from BatchProcessor::extraImageFiles
+     */
+    QVector<QImage> extraImages;
+    /*!
+     * \brief Input image files, after expansion of directories
+     */
+    QStringList inputFiles;
+    QHash<int, JobRecord> jobs;
+    AlgorithmPool *pool;
+    ResultCache *cache;
+
+    BoundedQueue<DecodedImage> *decodedImages;
+    BoundedQueue<EncodeRequest> *encodeRequests;
+    ImageDecoder *decoder;
+    ImageEncoder *encoder;
+    /*!
+     * \brief Whether BatchProcessor::decoder has finished adding images
+     * to BatchProcessor::decodedImages
+     */
+    bool decodingFinished;
+    /*!
+     * \brief The number of outputs submitted to BatchProcessor::encoder
+     * which have not yet been written
+     */
+    int nPendingWrites;
+    bool batchFinished;
+
+    int nSucceeded;
+    int nFailed;
+    /*!
+     * \brief The number of input files which could not be loaded,
+     * which are included in BatchProcessor::nFailed
+     */
+    int nUnreadable;
+    /*!
+     * \brief The sum of the processing times of all jobs, in milliseconds
+     */
+    qint64 totalJobTime;
+    /*!
+     * \brief Measures the wall-clock time of the batch
+     */
+    QElapsedTimer timer;
+    QTextStream out;
+    QTextStream err;
+};
+
+#endif // BATCHPROCESSOR_H
@@ -0,0 +1,168 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+/*!
+** \file boundedqueue.h
+** \brief Definition of the BoundedQueue class template.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <utility>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QWaitCondition>
+
+/*!
+ * \brief A thread-safe first-in, first-out queue with a maximum size
+ *
+ * Producers block while the queue is full, and consumers can block while
+ * it is empty, so that a fast stage of a pipeline cannot run arbitrarily
+ * far ahead of a slow stage.
+ *
+ * Once closed, the queue accepts no further elements, and all blocked
+ * threads are woken. Elements already in the queue can still be removed.
+ */
+template<typename T> class BoundedQueue
+{
+public:
+    /*!
+     * \brief Create an empty queue
+     * \param [in] capacity The maximum number of elements. Values less than one
+     * are treated as one.
+     */
+    BoundedQueue(const int capacity);
+
+    /*!
+     * \brief Append an element, waiting until there is space for it
+     * \param [in] value The element to append
+     * \return `false` if the queue was closed, in which case `value` was not appended
+     */
+    bool push(const T &value);
+
+    /*!
+     * \brief Append an element, waiting until there is space for it
+     * \param [in] value The element to move into the queue
+     * \return `false` if the queue was closed, in which case `value` was not appended
+     */
+    bool push(T &&value);
+
+    /*!
+     * \brief Remove the oldest element, waiting until one is available
+     * \param [out] value The element removed
+     * \return `false` if the queue is closed and empty, in which case
+     * `value` is not modified
+     */
+    bool pop(T &value);
+
+    /*!
+     * \brief Remove the oldest element, if there is one, without waiting
+     * \param [out] value The element removed
+     * \return `false` if the queue is empty, in which case `value` is not modified
+     */
+    bool tryPop(T &value);
+
+    /*!
+     * \brief Stop accepting elements, and wake all waiting threads
+     */
+    void close(void);
+
+    /*!
+     * \brief Determine the number of elements in the queue
+     * \return The number of elements
+     */
+    int size(void) const;
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    BoundedQueue(const BoundedQueue& other);
+    BoundedQueue& operator=(const BoundedQueue& other);
+
+    // Data members
+private:
+    int capacity;
+    bool closed;
+    QQueue<T> elements;
+    mutable QMutex mutex;
+    QWaitCondition notFull;
+    QWaitCondition notEmpty;
+};
+
+template<typename T> BoundedQueue<T>::BoundedQueue(const int c) :
+    capacity((c < 1) ? 1 : c), closed(false), elements(), mutex(), notFull(), notEmpty()
+{}
+
+template<typename T> bool BoundedQueue<T>::push(const T &value) {
+    QMutexLocker locker(&mutex);
+    while(!closed && elements.size() >= capacity) {
+        notFull.wait(&mutex);
+    }
+    if(closed) {
+        return false;
+    }
+    elements.enqueue(value);
+    notEmpty.wakeOne();
+    return true;
+}
+
+template<typename T> bool BoundedQueue<T>::push(T &&value) {
+    QMutexLocker locker(&mutex);
+    while(!closed && elements.size() >= capacity) {
+        notFull.wait(&mutex);
+    }
+    if(closed) {
+        return false;
+    }
+    elements.enqueue(T());
+    elements.last() = std::move(value);
+    notEmpty.wakeOne();
+    return true;
+}
+
+template<typename T> bool BoundedQueue<T>::pop(T &value) {
+    QMutexLocker locker(&mutex);
+    while(!closed && elements.isEmpty()) {
+        notEmpty.wait(&mutex);
+    }
+    if(elements.isEmpty()) {
+        return false;
+    }
+    value = std::move(elements.head());
+    elements.dequeue();
+    notFull.wakeOne();
+    return true;
+}
+
+template<typename T> bool BoundedQueue<T>::tryPop(T &value) {
+    QMutexLocker locker(&mutex);
+    if(elements.isEmpty()) {
+        return false;
+    }
+    value = std::move(elements.head());
+    elements.dequeue();
+    notFull.wakeOne();
+    return true;
+}
+
+template<typename T> void BoundedQueue<T>::close(void) {
+    QMutexLocker locker(&mutex);
+    closed = true;
+    notFull.wakeAll();
+    notEmpty.wakeAll();
+}
+
+template<typename T> int BoundedQueue<T>::size(void) const {
+    QMutexLocker locker(&mutex);
+    return elements.size();
+}
+
+#endif // BOUNDEDQUEUE_H
@@ -0,0 +1,32 @@
+/*!
+** \file cancellationtoken.cpp
+** \brief Implementation of the CancellationToken class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include "cancellationtoken.h"
+
+CancellationToken::CancellationToken(void) :
+    cancelled(0)
+{}
+
+void CancellationToken::cancel(void) {
+    cancelled.storeRelease(1);
+}
+
+void CancellationToken::reset(void) {
+    cancelled.storeRelease(0);
+}
+
+bool CancellationToken::isCancelled(void) const {
+    return cancelled.loadAcquire() != 0;
+}
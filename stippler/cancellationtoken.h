@@ -0,0 +1,69 @@
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+/*!
+** \file cancellationtoken.h
+** \brief Definition of the CancellationToken class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QAtomicInt>
+
+/*!
+ * \brief A flag through which one thread asks another to stop processing
+ *
+ * The flag is atomic, so it can be set by any thread and polled by
+ * the worker thread, and by the threads helping it, without locking.
+ * Polling consists of a single atomic load, and is therefore cheap enough
+ * to be done at the boundaries of small chunks of work.
+ *
+ * Cancellation is cooperative: a worker which observes the flag stops at the
+ * next point where it can abandon its work, leaving its intermediate results
+ * incomplete. The owner of the work is then responsible for discarding them.
+ */
+class CancellationToken
+{
+public:
+    /*!
+     * \brief Create a token which has not been cancelled
+     */
+    CancellationToken(void);
+
+    /*!
+     * \brief Request cancellation
+     */
+    void cancel(void);
+
+    /*!
+     * \brief Withdraw any request for cancellation, in preparation for new work
+     *
+     * This function should only be called when no threads are polling the token.
+     */
+    void reset(void);
+
+    /*!
+     * \brief Determine whether cancellation has been requested
+     * \return `true` if cancel() has been called since the last call to reset()
+     */
+    bool isCancelled(void) const;
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    CancellationToken(const CancellationToken& other);
+    CancellationToken& operator=(const CancellationToken& other);
+
+    // Data members
+private:
+    QAtomicInt cancelled;
+};
+
+#endif // CANCELLATIONTOKEN_H
@@ -28,6 +28,13 @@
 
 #include <algorithm>
 #include "imagedata.h"
+#include "taskscheduler.h"
+
+/*!
+ * \brief The minimum number of pixels converted between colour spaces
+ * by each task run by the TaskScheduler
+ */
+#define IMAGEDATA_MIN_PIXELS_PER_TASK 16384
 
 ImageData::ImageData(const QImage &image) :
     r(0), g(0), bl(0), l(0), a(0), bs(0),
@@ -411,6 +418,45 @@ void ImageData::sobelLabAt(const pxind &k, QVector2D &g) {
     g.setY(gl.y() + ga.y() + gb.y());
 }
 
+ImageData* ImageData::downsampleLab(const pxind &factor) {
+    const qreal* channels[] = { lStar(), aStar(), bStar() };
+    pxind outW = (w + factor - 1) / factor;
+    pxind outH = (h + factor - 1) / factor;
+    pxind outN = outW * outH;
+    qreal* outChannels[] = { new qreal[outN], new qreal[outN], new qreal[outN] };
+    pxind* blockSizes = new pxind[outN];
+    for(int j = 0; j < 3; j += 1) {
+        std::fill(outChannels[j], outChannels[j] + outN, 0.0);
+    }
+    std::fill(blockSizes, blockSizes + outN, 0);
+
+    // Sum the pixels in each block
+    pxind k = 0;
+    pxind outRow = 0;
+    pxind outK = 0;
+    for(pxind y = 0; y < h; y += 1) {
+        outRow = (y / factor) * outW;
+        for(pxind x = 0; x < w; x += 1) {
+            outK = outRow + (x / factor);
+            for(int j = 0; j < 3; j += 1) {
+                outChannels[j][outK] += channels[j][k];
+            }
+            blockSizes[outK] += 1;
+            k += 1;
+        }
+    }
+
+    // Normalize
+    for(outK = 0; outK < outN; outK += 1) {
+        for(int j = 0; j < 3; j += 1) {
+            outChannels[j][outK] /= static_cast<qreal>(blockSizes[outK]);
+        }
+    }
+    delete [] blockSizes;
+
+    return new ImageData(outChannels[0], outChannels[1], outChannels[2], outW, outH);
+}
+
 bool ImageData::checkXY(const pxind &x, const pxind &y) const {
     return (x >= 0 && x < w && y >= 0 && y < h );
 }
@@ -431,8 +477,16 @@ void ImageData::rgb2lab() {
     a = new qreal[nPixels];
     bs = new qreal[nPixels];
 
-    rgb2xyz();
-    xyz2lab();
+    // The conversion is independent for each pixel
+    TaskScheduler::instance().parallelFor(
+                0,
+                nPixels,
+                IMAGEDATA_MIN_PIXELS_PER_TASK,
+                [this](pxind start, pxind end) {
+                    rgb2xyz(start, end);
+                    xyz2lab(start, end);
+                }
+            );
 }
 
 void ImageData::lab2rgb() {
@@ -453,16 +507,23 @@ void ImageData::lab2rgb() {
      */
     qreal* xyz = new qreal[nPixels*3];
 
-    lab2xyz(xyz);
-    xyz2rgb(xyz);
+    TaskScheduler::instance().parallelFor(
+                0,
+                nPixels,
+                IMAGEDATA_MIN_PIXELS_PER_TASK,
+                [this, xyz](pxind start, pxind end) {
+                    lab2xyz(xyz, start, end);
+                    xyz2rgb(xyz, start, end);
+                }
+            );
 
     delete [] xyz;
 }
 
-void ImageData::rgb2xyz() {
+void ImageData::rgb2xyz(const pxind start, const pxind end) {
     qreal pxRGB[3] = {0};
     qreal pxXYZ[3] = {0};
-    for(pxind i = 0; i < nPixels; i += 1) {
+    for(pxind i = start; i < end; i += 1) {
         // RGB values
         pxRGB[0] = r[i];
         pxRGB[1] = g[i];
@@ -474,11 +535,11 @@ void ImageData::rgb2xyz() {
     }
 }
 
-void ImageData::xyz2lab() {
-    // Convert every pixel
+void ImageData::xyz2lab(const pxind start, const pxind end) {
+    // Convert every pixel in the range
     qreal pxXYZ[3] = {0};
     qreal pxLAB[3] = {0};
-    for(pxind i = 0; i < nPixels; i +=1){
+    for(pxind i = start; i < end; i +=1){
         pxXYZ[0] = l[i];
         pxXYZ[1] = a[i];
         pxXYZ[2] = bs[i];
@@ -489,12 +550,12 @@ void ImageData::xyz2lab() {
     }
 }
 
-void ImageData::lab2xyz(qreal *&xyz) {
-    // Convert every pixel
+void ImageData::lab2xyz(qreal * const xyz, const pxind start, const pxind end) {
+    // Convert every pixel in the range
     qreal pxXYZ[3] = {0};
     qreal pxLAB[3] = {0};
     pxind i3 = 0;
-    for(pxind i = 0; i < nPixels; i +=1){
+    for(pxind i = start; i < end; i +=1){
         pxLAB[0] = l[i];
         pxLAB[1] = a[i];
         pxLAB[2] = bs[i];
@@ -506,13 +567,13 @@ void ImageData::lab2xyz(qreal *&xyz) {
     }
 }
 
-void ImageData::xyz2rgb(qreal *&xyz) {
+void ImageData::xyz2rgb(const qreal * const xyz, const pxind start, const pxind end) {
     qreal pxXYZ[3] = {0};
     qreal pxRGBReal[3] = {0};
     uchar pxRGBInt[3] = {0};
     pxind i3 = 0;
-    // Convert every pixel
-    for(pxind i = 0; i < nPixels; i +=1){
+    // Convert every pixel in the range
+    for(pxind i = start; i < end; i +=1){
         i3 = i * 3;
         pxXYZ[0] = xyz[i3];
         pxXYZ[1] = xyz[i3 + 1];
@@ -322,6 +322,23 @@ public:
      */
     void sobelLabAt(const pxind &k, QVector2D &g);
 
+    /*!
+     * \brief Create a reduced-size copy of the image in the CIE L*a*b* colour space
+     *
+     * Each pixel of the output image is the mean of a `factor` by `factor`
+     * block of pixels in this image. Blocks along the right and bottom borders
+     * of the image may be smaller, if the image dimensions are not multiples
+     * of `factor`.
+     *
+     * The pixel at position `(x, y)` in this image therefore corresponds to
+     * the pixel at position `(x / factor, y / factor)` in the output image.
+     * \param [in] factor The factor by which to reduce the image width and height
+     * \return A new image of width `ceil(width() / factor)` and height
+     * `ceil(height() / factor)`, containing only CIE L*a*b* colour channels.
+     * The caller is expected to take ownership of this object.
+     */
+    ImageData* downsampleLab(const pxind &factor);
+
     // Colour space conversion functions
 public:
     /*!
@@ -357,11 +374,15 @@ private:
 
     /*!
      * \brief Produces XYZ colour values in the range [0, 1]
+     *
+     * This function and the other colour space conversion helpers
+     * operate on a range of pixels, from `start` to `end`, exclusive,
+     * so that they can be run concurrently by the TaskScheduler.
      */
-    void rgb2xyz();
-    void xyz2lab();
-    void lab2xyz(qreal*& xyz);
-    void xyz2rgb(qreal*& xyz);
+    void rgb2xyz(const pxind start, const pxind end);
+    void xyz2lab(const pxind start, const pxind end);
+    void lab2xyz(qreal * const xyz, const pxind start, const pxind end);
+    void xyz2rgb(const qreal * const xyz, const pxind start, const pxind end);
 
     // Data members
 private:
@@ -0,0 +1,158 @@
+/*!
+** \file jobclient.cpp
+** \brief Implementation of the JobClient class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QTimer>
+#include <stdio.h>
+#include "jobclient.h"
+#include "batchprocessor.h"
+
+JobClient::JobClient(const QString &s,
+                     const QString &a,
+                     const QStringList &i,
+                     const QStringList &e,
+                     const QString &o,
+                     QObject *parent) :
+    QObject(parent), socketName(s), algorithmName(a), inputs(i), extraImageFiles(e),
+    outputDirectory(o), inputFiles(), extraImages(), socket(0), nextInput(0), retryInputs(),
+    retryScheduled(false), nInFlight(0), nOutstanding(0), nSucceeded(0),
+    nFailed(0), out(stdout), err(stderr)
+{}
+
+bool JobClient::start(void) {
+    if(!BatchProcessor::expandInputs(inputs, inputFiles, err)) {
+        return false;
+    }
+    if(inputFiles.isEmpty()) {
+        err << tr("No input images were found.") << endl;
+        return false;
+    }
+    if(!BatchProcessor::checkOutputPaths(inputFiles, outputDirectory, algorithmName, err)) {
+        return false;
+    }
+    if(!outputDirectory.isEmpty() && !QDir().mkpath(outputDirectory)) {
+        err << tr("Cannot create the output directory %1").arg(outputDirectory) << endl;
+        return false;
+    }
+
+    socket = new QLocalSocket(this);
+    socket->connectToServer(socketName);
+    if(!socket->waitForConnected(JOBCLIENT_CONNECT_TIMEOUT)) {
+        err << tr("Cannot connect to %1: %2").arg(socketName, socket->errorString()) << endl;
+        return false;
+    }
+    connect(socket, SIGNAL(readyRead()), this, SLOT(receiveReplies()));
+    connect(socket, SIGNAL(disconnected()), this, SLOT(receiveDisconnection()));
+
+    // The server may not share the client's working directory
+    foreach(const QString &file, extraImageFiles) {
+        extraImages.append(QFileInfo(file).absoluteFilePath());
+    }
+    nOutstanding = inputFiles.size();
+    sendRequests();
+    return true;
+}
+
+void JobClient::sendRequests(void) {
+    retryScheduled = false;
+    if(socket == 0 || socket->state() != QLocalSocket::ConnectedState) {
+        return;
+    }
+    int i = 0;
+    while(nInFlight < JOBCLIENT_WINDOW_SIZE) {
+        if(!retryInputs.isEmpty()) {
+            i = retryInputs.takeFirst();
+        } else if(nextInput < inputFiles.size()) {
+            i = nextInput;
+            nextInput += 1;
+        } else {
+            break;
+        }
+        const QString &file = inputFiles[i];
+        QJsonObject request;
+        request.insert("id", i);
+        request.insert("algorithm", algorithmName);
+        request.insert("input", QFileInfo(file).absoluteFilePath());
+        request.insert("extra", extraImages);
+        request.insert("output", QFileInfo(
+            BatchProcessor::outputPath(file, outputDirectory, algorithmName, "png")
+        ).absoluteFilePath());
+        socket->write(QJsonDocument(request).toJson(QJsonDocument::Compact));
+        socket->write("\n");
+        nInFlight += 1;
+    }
+}
+
+int JobClient::exitCode(void) const {
+    return (nFailed == 0 && nOutstanding == 0) ? 0 : 1;
+}
+
+void JobClient::receiveReplies(void) {
+    while(socket->canReadLine()) {
+        QJsonObject reply = QJsonDocument::fromJson(socket->readLine()).object();
+        const QString event = reply.value("event").toString();
+        const int i = reply.value("id").toInt(-1);
+        const QString file = (i >= 0 && i < inputFiles.size()) ? inputFiles[i] : QString();
+        if(event == "progress") {
+            err << file << ": " << reply.value("status").toString() << endl;
+        } else if(event == "result") {
+            out << file << "\t" << reply.value("output").toString() << endl;
+            nSucceeded += 1;
+            nOutstanding -= 1;
+            nInFlight -= 1;
+        } else if(event == "error" && !file.isEmpty() && reply.value("busy").toBool()) {
+            // The server's queue is full, so submit the image again later
+            retryInputs.append(i);
+            nInFlight -= 1;
+            if(!retryScheduled) {
+                retryScheduled = true;
+                QTimer::singleShot(JOBCLIENT_RETRY_INTERVAL, this, SLOT(sendRequests()));
+            }
+        } else if(event == "error") {
+            err << file << ": " << reply.value("message").toString() << endl;
+            // Errors which do not concern a job are not counted against the batch
+            if(!file.isEmpty()) {
+                nFailed += 1;
+                nOutstanding -= 1;
+                nInFlight -= 1;
+            }
+        } else if(event == "cancelled") {
+            err << file << ": " << tr("cancelled") << endl;
+            nFailed += 1;
+            nOutstanding -= 1;
+            nInFlight -= 1;
+        }
+    }
+    if(!retryScheduled) {
+        sendRequests();
+    }
+    if(nOutstanding == 0) {
+        out << tr("%1 succeeded, %2 failed").arg(nSucceeded).arg(nFailed) << endl;
+        disconnect(socket, 0, this, 0);
+        socket->disconnectFromServer();
+        emit finished();
+    }
+}
+
+void JobClient::receiveDisconnection(void) {
+    err << tr("The connection to the server was lost, with %1 image(s) outstanding.")
+           .arg(nOutstanding) << endl;
+    emit finished();
+}
@@ -0,0 +1,166 @@
+#ifndef JOBCLIENT_H
+#define JOBCLIENT_H
+
+/*!
+** \file jobclient.h
+** \brief Definition of the JobClient class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QJsonArray>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+class QLocalSocket;
+
+/*!
+  \brief The time, in milliseconds, to wait for a connection to a JobServer
+ */
+#define JOBCLIENT_CONNECT_TIMEOUT 5000
+
+/*!
+  \brief The maximum number of images submitted to the server for which
+  no final reply has been received
+
+  This is below #JOBSERVER_PENDING_QUEUE_DEPTH, so that a single client
+  does not fill the server's queue.
+ */
+#define JOBCLIENT_WINDOW_SIZE 16
+
+/*!
+  \brief The time, in milliseconds, to wait before resubmitting images
+  which the server rejected because it was busy
+ */
+#define JOBCLIENT_RETRY_INTERVAL 1000
+
+/*!
+ * \brief Submits a batch of images to a JobServer, for scripting
+ *
+ * The command line interface mirrors that of BatchProcessor: each input image
+ * is processed with a single algorithm, and the outputs are saved to the
+ * paths chosen by BatchProcessor::outputPath(). Progress messages are printed
+ * to the standard error stream, and the paths of outputs to the standard output stream.
+ *
+ * Images are submitted a few at a time (#JOBCLIENT_WINDOW_SIZE), with the next
+ * image submitted when the server finishes with an earlier one, so that batches of
+ * any size can be processed. Images which the server rejects because its queue
+ * is full are resubmitted later, rather than counted as failures.
+ */
+class JobClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    /*!
+     * \brief Prepare to submit a batch of images
+     * \param [in] socketName The name of the local socket on which the server listens
+     * \param [in] algorithmName The name of the algorithm in the AlgorithmRegistry
+     * \param [in] inputs Input image files, or directories of image files
+     * \param [in] extraImages Files containing the additional images required by the algorithm
+     * \param [in] outputDirectory The directory in which to save output images.
+     * If empty, outputs are saved alongside the corresponding input images.
+     * \param [in] parent The parent object which takes ownership of this object
+     */
+    JobClient(const QString &socketName,
+              const QString &algorithmName,
+              const QStringList &inputs,
+              const QStringList &extraImages,
+              const QString &outputDirectory,
+              QObject *parent = 0);
+
+    /*!
+     * \brief Connect to the server and submit the first images
+     *
+     * Errors are printed to the standard error stream.
+     * \return `false` if the images could not be submitted, in which case
+     * finished() will not be emitted
+     */
+    bool start(void);
+
+    /*!
+     * \brief The process exit code summarizing the outcome of the batch
+     * \return Zero if all images were processed successfully, or one otherwise
+     */
+    int exitCode(void) const;
+
+signals:
+    /*!
+     * \brief Emitted once the server has replied about all images,
+     * or the connection was lost
+     */
+    void finished();
+
+private slots:
+    void receiveReplies(void);
+    void receiveDisconnection(void);
+    /*!
+     * \brief Submit images, until #JOBCLIENT_WINDOW_SIZE images are outstanding
+     * at the server, or there are no more images to submit
+     *
+     * Images rejected by the server as busy are submitted first.
+     */
+    void sendRequests(void);
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    JobClient(const JobClient& other);
+    JobClient& operator=(const JobClient& other);
+
+    // Data members
+private:
+    QString socketName;
+    QString algorithmName;
+    QStringList inputs;
+    QStringList extraImageFiles;
+    QString outputDirectory;
+
+    /*!
+     * \brief Input image files, indexed by the identifiers of their jobs
+     */
+    QStringList inputFiles;
+    /*!
+     * \brief The absolute paths of the additional images, sent with every request
+     */
+    QJsonArray extraImages;
+    QLocalSocket *socket;
+    /*!
+     * \brief The index in JobClient::inputFiles of the next image to submit
+     * for the first time
+     */
+    int nextInput;
+    /*!
+     * \brief The indices of images to submit again, after the server was busy
+     */
+    QList<int> retryInputs;
+    /*!
+     * \brief Whether a retry of JobClient::retryInputs is scheduled
+     */
+    bool retryScheduled;
+    /*!
+     * \brief The number of submitted images for which no final reply has been received
+     */
+    int nInFlight;
+    /*!
+     * \brief The number of images for which no final reply has been received,
+     * including those not yet submitted
+     */
+    int nOutstanding;
+    int nSucceeded;
+    int nFailed;
+    QTextStream out;
+    QTextStream err;
+};
+
+#endif // JOBCLIENT_H
@@ -0,0 +1,409 @@
+/*!
+** \file jobserver.cpp
+** \brief Implementation of the JobServer class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <stdio.h>
+#include <utility>
+#include "jobserver.h"
+#include "algorithmpool.h"
+#include "algorithmprogress.h"
+#include "algorithmregistry.h"
+#include "resultcache.h"
+#include "algorithms/algorithm.h"
+
+JobServer::JobServer(const QString &s, const int n, const bool c, QObject *parent) :
+    QObject(parent), socketName(s), nJobs(n), useCache(c), server(0), pool(0),
+    cache(0), encodeRequests(0), encoder(0), progressTimer(0), jobs(),
+    pendingRequests()
+{
+    if(nJobs <= 0) {
+        nJobs = QThread::idealThreadCount();
+    }
+}
+
+JobServer::~JobServer(void) {
+    // The threads must stop using the cache before the cache is deleted
+    if(pool != 0) {
+        delete pool;
+        pool = 0;
+    }
+    if(encodeRequests != 0) {
+        encodeRequests->close();
+    }
+    if(encoder != 0) {
+        encoder->wait();
+        delete encoder;
+        encoder = 0;
+    }
+    if(encodeRequests != 0) {
+        delete encodeRequests;
+        encodeRequests = 0;
+    }
+    if(cache != 0) {
+        delete cache;
+        cache = 0;
+    }
+}
+
+bool JobServer::listen(void) {
+    QTextStream err(stderr);
+    server = new QLocalServer(this);
+    // Jobs read and write files with the server's permissions
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    if(!server->listen(socketName)) {
+        // Only remove the socket if it was left behind by a server which is no longer running
+        QLocalSocket probe;
+        probe.connectToServer(socketName);
+        if(probe.waitForConnected(JOBSERVER_PROBE_TIMEOUT)) {
+            probe.disconnectFromServer();
+            err << tr("Another server is already listening on %1").arg(socketName) << endl;
+            return false;
+        }
+        QLocalServer::removeServer(socketName);
+    }
+    if(!server->isListening() && !server->listen(socketName)) {
+        err << tr("Cannot listen on %1: %2").arg(socketName, server->errorString()) << endl;
+        return false;
+    }
+    connect(server, SIGNAL(newConnection()), this, SLOT(receiveConnection()));
+
+    if(useCache) {
+        cache = new ResultCache(ResultCache::defaultDirectory());
+        if(!cache->isValid()) {
+            err << tr("Failed to create the result cache directory. Results will not be cached.") << endl;
+            delete cache;
+            cache = 0;
+        }
+    }
+    pool = new AlgorithmPool(this, nJobs);
+    pool->setResultCache(cache);
+    connect(pool, SIGNAL(jobStatus(int,QString)), this, SLOT(receiveStatus(int,QString)));
+    connect(pool, SIGNAL(jobOutput(int,AlgorithmResultPair&)), this, SLOT(receiveOutput(int,AlgorithmResultPair&)));
+    connect(pool, SIGNAL(jobFailed(int)), this, SLOT(receiveFail(int)));
+    connect(pool, SIGNAL(jobCancelled(int)), this, SLOT(receiveCancelled(int)));
+
+    encodeRequests = new BoundedQueue<EncodeRequest>(JOBSERVER_ENCODE_QUEUE_DEPTH);
+    encoder = new ImageEncoder(encodeRequests);
+    connect(encoder, SIGNAL(imageEncoded(int,bool)), this, SLOT(receiveEncoded(int,bool)), Qt::QueuedConnection);
+    connect(encoder, SIGNAL(imageEncodedAsText(int,bool,QByteArray,QByteArray)),
+            this, SLOT(receiveEncodedAsText(int,bool,QByteArray,QByteArray)), Qt::QueuedConnection);
+    encoder->start();
+
+    progressTimer = new QTimer(this);
+    progressTimer->setInterval(JOBSERVER_PROGRESS_INTERVAL);
+    connect(progressTimer, SIGNAL(timeout()), this, SLOT(pollProgress()));
+    progressTimer->start();
+
+    QTextStream(stdout) << tr("Listening on %1").arg(server->fullServerName()) << endl;
+    return true;
+}
+
+void JobServer::receiveConnection(void) {
+    QLocalSocket *client = server->nextPendingConnection();
+    while(client != 0) {
+        connect(client, SIGNAL(readyRead()), this, SLOT(receiveRequests()));
+        connect(client, SIGNAL(disconnected()), this, SLOT(receiveDisconnection()));
+        client = server->nextPendingConnection();
+    }
+}
+
+void JobServer::receiveRequests(void) {
+    QLocalSocket *client = qobject_cast<QLocalSocket*>(sender());
+    if(client == 0) {
+        return;
+    }
+    while(client->canReadLine()) {
+        QByteArray line = client->readLine().trimmed();
+        if(line.isEmpty()) {
+            continue;
+        }
+        QJsonParseError parseError;
+        QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+        if(!document.isObject()) {
+            QJsonObject reply;
+            reply.insert("event", QString("error"));
+            reply.insert("message", tr("Malformed request: %1").arg(parseError.errorString()));
+            send(client, reply);
+            continue;
+        }
+        handleRequest(client, document.object());
+    }
+}
+
+void JobServer::receiveDisconnection(void) {
+    QLocalSocket *client = qobject_cast<QLocalSocket*>(sender());
+    if(client == 0) {
+        return;
+    }
+    QList<int> clientJobs;
+    for(QHash<int, ServerJob>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+        if(it.value().client == client) {
+            it.value().client = 0;
+            clientJobs.append(it.key());
+        }
+    }
+    foreach(int job, clientJobs) {
+        pool->cancel(job);
+    }
+    QList<PendingRequest>::iterator pending = pendingRequests.begin();
+    while(pending != pendingRequests.end()) {
+        if(pending->client == client) {
+            pending = pendingRequests.erase(pending);
+        } else {
+            ++pending;
+        }
+    }
+    client->deleteLater();
+}
+
+void JobServer::receiveStatus(int job, const QString &status) {
+    if(status.isEmpty() || !jobs.contains(job)) {
+        return;
+    }
+    QJsonObject reply;
+    reply.insert("status", status);
+    replyToJob(job, "progress", reply, false);
+}
+
+void JobServer::receiveOutput(int job, AlgorithmResultPair &pair) {
+    const QString outputPath = jobs.value(job).outputPath;
+    EncodeRequest request;
+    request.job = job;
+    // Inline results are encoded in memory, also on the encoder thread
+    if(!outputPath.isEmpty()) {
+        QFileInfo info(outputPath);
+        request.imagePath = outputPath;
+        request.svgPath = info.dir().filePath(info.completeBaseName() + ".svg");
+    }
+    request.pair = std::move(pair);
+    encodeRequests->push(std::move(request));
+}
+
+void JobServer::receiveFail(int job) {
+    QJsonObject reply;
+    reply.insert("message", tr("The algorithm failed."));
+    replyToJob(job, "error", reply, true);
+}
+
+void JobServer::receiveCancelled(int job) {
+    replyToJob(job, "cancelled", QJsonObject(), true);
+}
+
+void JobServer::receiveEncoded(int job, bool succeeded) {
+    QJsonObject reply;
+    const QString outputPath = jobs.value(job).outputPath;
+    if(succeeded) {
+        reply.insert("output", outputPath);
+        replyToJob(job, "result", reply, true);
+    } else {
+        reply.insert("message", tr("Failed to save %1").arg(outputPath));
+        replyToJob(job, "error", reply, true);
+    }
+}
+
+void JobServer::receiveEncodedAsText(int job, bool succeeded, const QByteArray &image,
+                                     const QByteArray &svg) {
+    QJsonObject reply;
+    if(succeeded) {
+        reply.insert("image", QString::fromLatin1(image));
+        if(!svg.isEmpty()) {
+            reply.insert("svg", QString::fromLatin1(svg));
+        }
+        replyToJob(job, "result", reply, true);
+    } else {
+        reply.insert("message", tr("Failed to encode the output image."));
+        replyToJob(job, "error", reply, true);
+    }
+}
+
+void JobServer::pollProgress(void) {
+    foreach(int job, pool->runningJobs()) {
+        QHash<int, ServerJob>::iterator it = jobs.find(job);
+        if(it == jobs.end()) {
+            continue;
+        }
+        QString text = pool->progress(job)->text();
+        if(!text.isEmpty() && text != it.value().lastProgress) {
+            it.value().lastProgress = text;
+            QJsonObject reply;
+            reply.insert("status", text);
+            replyToJob(job, "progress", reply, false);
+        }
+    }
+}
+
+void JobServer::handleRequest(QLocalSocket *client, const QJsonObject &request) {
+    const QString command = request.value("command").toString("run");
+    if(command == "run") {
+        queueJob(client, request);
+    } else if(command == "cancel") {
+        const QJsonValue tag = request.value("id");
+        QList<int> matchingJobs;
+        for(QHash<int, ServerJob>::const_iterator it = jobs.constBegin(); it != jobs.constEnd(); ++it) {
+            if(it.value().client == client && it.value().tag == tag) {
+                matchingJobs.append(it.key());
+            }
+        }
+        foreach(int job, matchingJobs) {
+            pool->cancel(job);
+        }
+        QList<PendingRequest>::iterator pending = pendingRequests.begin();
+        while(pending != pendingRequests.end()) {
+            if(pending->client == client && pending->request.value("id") == tag) {
+                QJsonObject reply;
+                reply.insert("id", tag);
+                reply.insert("event", QString("cancelled"));
+                send(client, reply);
+                pending = pendingRequests.erase(pending);
+            } else {
+                ++pending;
+            }
+        }
+    } else if(command == "list") {
+        QJsonArray algorithms;
+        foreach(const AlgorithmRegistry::Entry &entry, AlgorithmRegistry::entries()) {
+            QJsonObject algorithm;
+            algorithm.insert("name", entry.name);
+            algorithm.insert("description", entry.description);
+            algorithms.append(algorithm);
+        }
+        QJsonObject reply;
+        reply.insert("event", QString("algorithms"));
+        reply.insert("algorithms", algorithms);
+        send(client, reply);
+    } else if(command == "shutdown") {
+        server->close();
+        emit finished();
+    } else {
+        QJsonObject reply;
+        reply.insert("event", QString("error"));
+        reply.insert("message", tr("Unknown command \"%1\"").arg(command));
+        send(client, reply);
+    }
+}
+
+void JobServer::queueJob(QLocalSocket *client, const QJsonObject &request) {
+    QJsonObject reply;
+    reply.insert("id", request.value("id"));
+    if(pendingRequests.size() >= JOBSERVER_PENDING_QUEUE_DEPTH) {
+        reply.insert("event", QString("error"));
+        reply.insert("message", tr("The server is busy. Too many requests are waiting."));
+        reply.insert("busy", true);
+        send(client, reply);
+        return;
+    }
+    PendingRequest pending;
+    pending.client = client;
+    pending.request = request;
+    pendingRequests.append(pending);
+    reply.insert("event", QString("accepted"));
+    send(client, reply);
+    startPendingJobs();
+}
+
+void JobServer::startPendingJobs(void) {
+    while(!pendingRequests.isEmpty() && jobs.size() < nJobs) {
+        const PendingRequest pending = pendingRequests.takeFirst();
+        runJob(pending.client, pending.request);
+    }
+}
+
+void JobServer::runJob(QLocalSocket *client, const QJsonObject &request) {
+    QJsonObject reply;
+    reply.insert("id", request.value("id"));
+    reply.insert("event", QString("error"));
+
+    const QString algorithmName = request.value("algorithm").toString();
+    Algorithm *algorithm = AlgorithmRegistry::create(algorithmName);
+    if(algorithm == 0) {
+        reply.insert("message", tr("Unknown algorithm \"%1\"").arg(algorithmName));
+        send(client, reply);
+        return;
+    }
+
+    QVector<QImage> images;
+    QImage input;
+    if(request.contains("data")) {
+        input = QImage::fromData(QByteArray::fromBase64(request.value("data").toString().toLatin1()));
+    } else {
+        input = QImageReader(request.value("input").toString()).read();
+    }
+    images.append(input);
+    foreach(const QJsonValue &file, request.value("extra").toArray()) {
+        images.append(QImageReader(file.toString()).read());
+    }
+    QVector<QString> imageDescriptions;
+    algorithm->additionalRequiredImages(imageDescriptions);
+    QString message;
+    if(imageDescriptions.size() != (images.size() - 1)) {
+        message = tr("The \"%1\" algorithm requires %2 additional image(s), but %3 were given.")
+                .arg(algorithmName)
+                .arg(imageDescriptions.size())
+                .arg(images.size() - 1);
+    } else {
+        for(int i = 0; i < images.size(); i += 1) {
+            if(images[i].isNull()) {
+                message = tr("Cannot load input image %1").arg(i);
+                break;
+            }
+        }
+    }
+    if(!message.isEmpty()) {
+        delete algorithm;
+        reply.insert("message", message);
+        send(client, reply);
+        return;
+    }
+
+    algorithm->setIncrementBudget(ALGORITHM_RUN_TO_COMPLETION);
+    ServerJob serverJob;
+    serverJob.client = client;
+    serverJob.tag = request.value("id");
+    serverJob.outputPath = request.value("output").toString();
+    int job = pool->submit(algorithm, images);
+    jobs.insert(job, serverJob);
+}
+
+void JobServer::replyToJob(const int job, const QString &event, QJsonObject reply, const bool final) {
+    QHash<int, ServerJob>::iterator it = jobs.find(job);
+    if(it == jobs.end()) {
+        return;
+    }
+    reply.insert("id", it.value().tag);
+    reply.insert("event", event);
+    send(it.value().client, reply);
+    if(final) {
+        jobs.erase(it);
+        startPendingJobs();
+    }
+}
+
+void JobServer::send(QLocalSocket *client, const QJsonObject &reply) {
+    if(client == 0) {
+        return;
+    }
+    client->write(QJsonDocument(reply).toJson(QJsonDocument::Compact));
+    client->write("\n");
+}
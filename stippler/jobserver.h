@@ -0,0 +1,258 @@
+#ifndef JOBSERVER_H
+#define JOBSERVER_H
+
+/*!
+** \file jobserver.h
+** \brief Definition of the JobServer class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QObject>
+#include <QHash>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QList>
+#include <QString>
+#include "algorithmresultpair.h"
+#include "batchpipeline.h"
+
+class AlgorithmPool;
+class ResultCache;
+class QLocalServer;
+class QLocalSocket;
+class QTimer;
+
+/*!
+  \brief The default name of the local socket on which a JobServer listens
+ */
+#define JOBSERVER_DEFAULT_SOCKET "stippler"
+
+/*!
+  \brief The interval, in milliseconds, at which progress is sent to clients
+ */
+#define JOBSERVER_PROGRESS_INTERVAL 250
+
+/*!
+  \brief The time, in milliseconds, to wait when checking whether another
+  server is listening on the socket
+ */
+#define JOBSERVER_PROBE_TIMEOUT 1000
+
+/*!
+  \brief The capacity of the queue of outputs waiting to be written to disk
+ */
+#define JOBSERVER_ENCODE_QUEUE_DEPTH 8
+
+/*!
+  \brief The maximum number of `run` requests waiting for a job to finish
+  before their images are loaded
+ */
+#define JOBSERVER_PENDING_QUEUE_DEPTH 64
+
+/*!
+ * \brief A long-running process which runs image processing jobs for local clients
+ *
+ * Starting a process for each image costs thread creation, plugin loading
+ * and the opening of the ResultCache. A server pays these costs once, keeping
+ * its AlgorithmPool threads, the TaskScheduler, and the ResultCache
+ * alive between jobs.
+ *
+ * Clients connect to a local socket (a Unix domain socket, on Unix platforms),
+ * which only the user running the server can access,
+ * and exchange JSON objects, one per line. Requests have the following fields:
+ * - `command`: One of `run` (the default), `cancel`, `list` or `shutdown`
+ * - `id`: For `run` and `cancel`, a value chosen by the client, which is
+ *   copied into all replies concerning the job
+ * - `algorithm`: For `run`, the name of the algorithm in the AlgorithmRegistry
+ * - `input`: For `run`, the path of the input image file, or alternatively,
+ * - `data`: The contents of an input image file, encoded in Base64
+ * - `extra`: An array of paths to the additional images required by the algorithm
+ * - `output`: The path at which to save the raster output. The vector output, if
+ *   any, is saved alongside it with the extension `.svg`. If this field is absent,
+ *   the outputs are returned in the `result` reply.
+ *
+ * Each reply has an `event` field, and, if it concerns a job, an `id` field:
+ * - `accepted`: The job was queued
+ * - `progress`: The job's `status` changed
+ * - `result`: The job succeeded. The reply contains the `output` path, or
+ *   the `image` as a Base64-encoded PNG file, and the `svg` data, if any,
+ *   encoded in Base64.
+ * - `error`: The request or job failed, as described by `message`
+ * - `cancelled`: The job was cancelled
+ * - `algorithms`: The reply to `list`, containing an array of objects
+ *   with `name` and `description` fields
+ *
+ * Input images are only loaded once fewer than `nJobs` jobs are in progress,
+ * so that the memory used by the server does not grow with the number of
+ * requests. Up to #JOBSERVER_PENDING_QUEUE_DEPTH further `run` requests wait
+ * in a queue, and requests beyond that are rejected with an `error` reply
+ * in which the `busy` field is `true`. Clients can submit them again later.
+ *
+ * Jobs belonging to a client which disconnects are cancelled.
+ */
+class JobServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /*!
+     * \brief Create a server, which is not yet listening
+     * \param [in] socketName The name of the local socket
+     * \param [in] nJobs The number of jobs to run concurrently. If not positive,
+     * QThread::idealThreadCount() is used.
+     * \param [in] useCache Whether to retrieve and store results in the
+     * default ResultCache
+     * \param [in] parent The parent object which takes ownership of this object
+     */
+    JobServer(const QString &socketName, const int nJobs, const bool useCache,
+              QObject *parent = 0);
+
+    /*!
+     * \brief Cancels all jobs, and waits for queued outputs to be written
+     */
+    virtual ~JobServer(void);
+
+    /*!
+     * \brief Start listening for clients
+     *
+     * A stale socket left by a server which did not shut down cleanly is removed,
+     * but a socket on which another server accepts connections is left alone.
+     * Errors are printed to the standard error stream.
+     * \return `false` if the socket could not be created, or another server
+     * is already listening on it
+     */
+    bool listen(void);
+
+signals:
+    /*!
+     * \brief Emitted when a client requests that the server shut down
+     */
+    void finished();
+
+private slots:
+    void receiveConnection(void);
+    void receiveRequests(void);
+    void receiveDisconnection(void);
+    void receiveStatus(int job, const QString &status);
+    void receiveOutput(int job, AlgorithmResultPair &pair);
+    void receiveFail(int job);
+    void receiveCancelled(int job);
+    void receiveEncoded(int job, bool succeeded);
+    void receiveEncodedAsText(int job, bool succeeded, const QByteArray &image,
+                              const QByteArray &svg);
+    void pollProgress(void);
+
+private:
+    /*!
+     * \brief A job, and the client which requested it
+     */
+    struct ServerJob {
+        /*!
+         * \brief The client, or null if the client has disconnected
+         */
+        QLocalSocket *client;
+        /*!
+         * \brief The value of the `id` field of the request
+         */
+        QJsonValue tag;
+        /*!
+         * \brief The path at which to save the raster output, or empty
+         * if the output is to be returned to the client
+         */
+        QString outputPath;
+        /*!
+         * \brief The most recent progress text sent to the client
+         */
+        QString lastProgress;
+    };
+
+    /*!
+     * \brief Respond to a single request
+     * \param [in] client The client which sent the request
+     * \param [in] request The request
+     */
+    void handleRequest(QLocalSocket *client, const QJsonObject &request);
+
+    /*!
+     * \brief A `run` request waiting for a job to finish
+     */
+    struct PendingRequest {
+        QLocalSocket *client;
+        QJsonObject request;
+    };
+
+    /*!
+     * \brief Queue a `run` request, or reject it if the queue is full
+     * \param [in] client The client which sent the request
+     * \param [in] request The request
+     */
+    void queueJob(QLocalSocket *client, const QJsonObject &request);
+
+    /*!
+     * \brief Start queued requests, while fewer than JobServer::nJobs jobs
+     * are in progress
+     */
+    void startPendingJobs(void);
+
+    /*!
+     * \brief Load the images of a `run` request, and submit the job to the AlgorithmPool
+     * \param [in] client The client which sent the request
+     * \param [in] request The request
+     */
+    void runJob(QLocalSocket *client, const QJsonObject &request);
+
+    /*!
+     * \brief Send a reply concerning a job, and, if the reply is final, forget the job
+     * \param [in] job The identifier of the job
+     * \param [in] event The value of the reply's `event` field
+     * \param [in] reply The other fields of the reply
+     * \param [in] final Whether this is the last reply concerning the job
+     */
+    void replyToJob(const int job, const QString &event, QJsonObject reply, const bool final);
+
+    /*!
+     * \brief Send a reply to a client
+     * \param [in] client The client. If null, the reply is discarded.
+     * \param [in] reply The reply
+     */
+    void send(QLocalSocket *client, const QJsonObject &reply);
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    JobServer(const JobServer& other);
+    JobServer& operator=(const JobServer& other);
+
+    // Data members
+private:
+    QString socketName;
+    int nJobs;
+    bool useCache;
+
+    QLocalServer *server;
+    AlgorithmPool *pool;
+    ResultCache *cache;
+    BoundedQueue<EncodeRequest> *encodeRequests;
+    ImageEncoder *encoder;
+    QTimer *progressTimer;
+
+    /*!
+     * \brief Jobs which are running, queued in the AlgorithmPool,
+     * or waiting for their output to be saved
+     */
+    QHash<int, ServerJob> jobs;
+    /*!
+     * \brief `run` requests whose images have not been loaded yet, in order of arrival
+     */
+    QList<PendingRequest> pendingRequests;
+};
+
+#endif // JOBSERVER_H
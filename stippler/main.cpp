@@ -53,8 +53,170 @@
 
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QTextStream>
+#include <string.h>
 #include "imageviewer.h"
 #include "algorithmresultpair.h"
+#include "algorithms/algorithmprofile.h"
+#include "algorithmregistry.h"
+#include "batchprocessor.h"
+#include "jobclient.h"
+#include "jobserver.h"
+#include "taskscheduler.h"
+
+/*!
+ * \brief Determine whether the application should run without a GUI
+ * \param [in] argc Number of command line arguments
+ * \param [in] argv Array of command line arguments
+ * \return `true` if a command line option selecting headless operation is present,
+ * with or without an attached value
+ */
+static bool isHeadless(int argc, char *argv[]) {
+    static const char * const headlessOptions[] = {
+        "--batch", "--list-algorithms", "--serve", "--connect"
+    };
+    for(int i = 1; i < argc; i += 1) {
+        // Values may be attached to options, as in `--batch=<algorithm>`
+        const char *equals = strchr(argv[i], '=');
+        const size_t nameLength = (equals == 0) ? strlen(argv[i]) : static_cast<size_t>(equals - argv[i]);
+        for(const char *option : headlessOptions) {
+            if(strlen(option) == nameLength && strncmp(argv[i], option, nameLength) == 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*!
+ * \brief Headless entrypoint, for processing batches of images from the command line,
+ * either directly or by way of a server, and for running a server
+ * \param [in] argc Number of command line arguments
+ * \param [in] argv Array of command line arguments
+ * \return Application exit code
+ * \see BatchProcessor, JobClient, JobServer
+ */
+static int runHeadless(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    qRegisterMetaType<AlgorithmResultPair>();
+    qRegisterMetaType<AlgorithmProfile>();
+    QCommandLineParser commandLineParser;
+    commandLineParser.setApplicationDescription(
+                QCoreApplication::translate("main", "Process images without a user interface."));
+    commandLineParser.addHelpOption();
+    QCommandLineOption batchOption("batch",
+                QCoreApplication::translate("main", "Run <algorithm> on each input image."),
+                QCoreApplication::translate("main", "algorithm"));
+    QCommandLineOption listOption("list-algorithms",
+                QCoreApplication::translate("main", "List the available algorithms."));
+    QCommandLineOption outputOption(QStringList() << "o" << "output-dir",
+                QCoreApplication::translate("main", "Save output images in <directory>, instead of alongside the input images."),
+                QCoreApplication::translate("main", "directory"));
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs",
+                QCoreApplication::translate("main", "Process <n> images concurrently."),
+                QCoreApplication::translate("main", "n"));
+    QCommandLineOption threadsOption("threads",
+                QCoreApplication::translate("main", "Use <n> threads within each algorithm."),
+                QCoreApplication::translate("main", "n"));
+    QCommandLineOption pinOption("pin-threads",
+                QCoreApplication::translate("main", "Bind algorithm threads to CPUs."));
+    QCommandLineOption extraOption("extra",
+                QCoreApplication::translate("main", "Additional input <file> required by the algorithm, passed with every image. May be repeated."),
+                QCoreApplication::translate("main", "file"));
+    QCommandLineOption profileOption("profile",
+                QCoreApplication::translate("main", "Print the time and work of each phase of the algorithm, for each image."));
+    QCommandLineOption profileJsonOption("profile-json",
+                QCoreApplication::translate("main", "Write the time and work of each phase of the algorithm, for each image, to <file> as JSON."),
+                QCoreApplication::translate("main", "file"));
+    QCommandLineOption noCacheOption("no-cache",
+                QCoreApplication::translate("main", "Do not read or write the result cache."));
+    QCommandLineOption serveOption("serve",
+                QCoreApplication::translate("main", "Run a server which processes images for clients, until a client requests that it shut down."));
+    QCommandLineOption connectOption("connect",
+                QCoreApplication::translate("main", "Send the images of a batch to a server, instead of processing them in this process."));
+    QCommandLineOption socketOption("socket",
+                QCoreApplication::translate("main", "Use the local socket <name> for --serve or --connect."),
+                QCoreApplication::translate("main", "name"), JOBSERVER_DEFAULT_SOCKET);
+    commandLineParser.addOption(batchOption);
+    commandLineParser.addOption(listOption);
+    commandLineParser.addOption(outputOption);
+    commandLineParser.addOption(jobsOption);
+    commandLineParser.addOption(threadsOption);
+    commandLineParser.addOption(pinOption);
+    commandLineParser.addOption(extraOption);
+    commandLineParser.addOption(profileOption);
+    commandLineParser.addOption(profileJsonOption);
+    commandLineParser.addOption(noCacheOption);
+    commandLineParser.addOption(serveOption);
+    commandLineParser.addOption(connectOption);
+    commandLineParser.addOption(socketOption);
+    commandLineParser.addPositionalArgument(
+                QCoreApplication::translate("main", "inputs"),
+                QCoreApplication::translate("main", "Input image files, or directories of images."),
+                QCoreApplication::translate("main", "inputs..."));
+    commandLineParser.process(app);
+
+    if(commandLineParser.isSet(listOption)) {
+        QTextStream out(stdout);
+        foreach(const AlgorithmRegistry::Entry &entry, AlgorithmRegistry::entries()) {
+            out << entry.name << "\t" << entry.description << endl;
+        }
+        return 0;
+    }
+
+    if(commandLineParser.isSet(connectOption)) {
+        JobClient client(
+                    commandLineParser.value(socketOption),
+                    commandLineParser.value(batchOption),
+                    commandLineParser.positionalArguments(),
+                    commandLineParser.values(extraOption),
+                    commandLineParser.value(outputOption)
+                );
+        QObject::connect(&client, SIGNAL(finished()), &app, SLOT(quit()), Qt::QueuedConnection);
+        if(!client.start()) {
+            return 2;
+        }
+        app.exec();
+        return client.exitCode();
+    }
+
+    TaskScheduler::configure(
+                commandLineParser.value(threadsOption).toInt(),
+                commandLineParser.isSet(pinOption)
+            );
+    if(commandLineParser.isSet(serveOption)) {
+        JobServer server(
+                    commandLineParser.value(socketOption),
+                    commandLineParser.value(jobsOption).toInt(),
+                    !commandLineParser.isSet(noCacheOption)
+                );
+        QObject::connect(&server, SIGNAL(finished()), &app, SLOT(quit()), Qt::QueuedConnection);
+        if(!server.listen()) {
+            return 2;
+        }
+        return app.exec();
+    }
+
+    BatchProcessor batch(
+                commandLineParser.value(batchOption),
+                commandLineParser.positionalArguments(),
+                commandLineParser.values(extraOption),
+                commandLineParser.value(outputOption),
+                commandLineParser.value(jobsOption).toInt(),
+                !commandLineParser.isSet(noCacheOption)
+            );
+    batch.setProfiling(
+                commandLineParser.isSet(profileOption),
+                commandLineParser.value(profileJsonOption)
+            );
+    // Queued, as the batch may finish before the event loop starts
+    QObject::connect(&batch, SIGNAL(finished()), &app, SLOT(quit()), Qt::QueuedConnection);
+    if(!batch.start()) {
+        return 2;
+    }
+    app.exec();
+    return batch.exitCode();
+}
 
 /*!
  * \brief Application entrypoint
@@ -64,11 +226,17 @@
  */
 int main(int argc, char *argv[])
 {
+    if(isHeadless(argc, argv)) {
+        return runHeadless(argc, argv);
+    }
     QApplication app(argc, argv);
     qRegisterMetaType<AlgorithmResultPair>();
+    qRegisterMetaType<AlgorithmProfile>();
     QGuiApplication::setApplicationDisplayName(ImageViewer::tr("COMP4905A Project"));
     QCommandLineParser commandLineParser;
     commandLineParser.addHelpOption();
+    commandLineParser.setApplicationDescription(
+                ImageViewer::tr("Run with --batch <algorithm> to process images without a user interface."));
     commandLineParser.addPositionalArgument(ImageViewer::tr("[file]"), ImageViewer::tr("Input image file to open."));
     commandLineParser.process(QCoreApplication::arguments());
     ImageViewer imageViewer;
@@ -20,6 +20,9 @@
 ** - Some non-essential functions have been removed, such as the static sort
 **   function for sorting arrays using a heap sort algorithm.
 ** - I converted the heap from a min-heap to a max-heap.
+** - I added functions to remove arbitrary elements from the heap,
+**   and to update the heap after an element's priority has changed
+**   in an unknown direction.
 **
 ** [Open Data Structures](http://opendatastructures.org/) is an open textbook
 ** and associated code library started by Pat Morin, distributed under
@@ -198,6 +201,39 @@ public:
      * \param [in] i The handle of the heap element, returned by add()
      */
     void decrease(index_t i);
+    /*!
+     * \brief Update the heap following a change in the priority of an element
+     *
+     * Use this function when it is not known whether the priority of the
+     * element increased or decreased.
+     * \param [in] i The handle of the heap element, returned by add()
+     */
+    void update(index_t i);
+    /*!
+     * \brief Extract an arbitrary element of the heap
+     *
+     * After this function has been called, the item is no longer in the heap,
+     * and attempting to refer to it later, using its handle, will
+     * trigger an assertion error.
+     * \param [in] i The handle of the heap element, returned by add()
+     * \return A copy of the element, which is now no longer in the heap.
+     */
+    T removeAt(index_t i);
+    /*!
+     * \brief Determine if an element is in the heap
+     * \param [in] i A handle returned by add()
+     * \return `true` if the element has not been removed from the heap
+     */
+    bool contains(index_t i);
+    /*!
+     * \brief Verify the invariants of the heap
+     *
+     * Checks that no element has a higher priority than its parent,
+     * and that the mappings between handles and heap positions agree.
+     * This function takes linear time, and is intended for debugging.
+     * \return `true` if the heap is consistent
+     */
+    bool isValid();
 };
 
 
@@ -218,7 +254,8 @@ void BinaryHeap<T, index_t>::resize(bool grow) {
 
 template<class T, typename index_t>
 index_t BinaryHeap<T, index_t>::add(T x) {
-	if (n + 1 > a.length) resize();
+    // The handle mapping outgrows the heap if elements have been removed
+    if (n + 1 > a.length || nIndex + 1 > indexToA.length) resize();
     a[n++] = x;
     indexToA[nIndex] = n - 1;
     aToIndex[n - 1] = nIndex;
@@ -306,6 +343,50 @@ void BinaryHeap<T, index_t>::decrease(index_t i) {
     trickleDown(heapIndex);
 }
 
+template<class T, typename index_t>
+void BinaryHeap<T, index_t>::update(index_t i) {
+    index_t heapIndex = indexToA[i];
+    assert(heapIndex != BINARYHEAP_INVALID_INDEX);
+    bubbleUp(heapIndex);
+    trickleDown(indexToA[i]);
+}
+
+template<class T, typename index_t>
+T BinaryHeap<T, index_t>::removeAt(index_t i) {
+    index_t heapIndex = indexToA[i];
+    assert(heapIndex != BINARYHEAP_INVALID_INDEX);
+    T x = a[heapIndex];
+    n -= 1;
+    indexToA[i] = BINARYHEAP_INVALID_INDEX; // No longer in heap
+    if(heapIndex != n) {
+        // Fill the gap with the last element, and restore the heap property
+        a[heapIndex] = a[n];
+        aToIndex[heapIndex] = aToIndex[n];
+        indexToA[aToIndex[heapIndex]] = heapIndex;
+        aToIndex[n] = BINARYHEAP_INVALID_INDEX;
+        update(aToIndex[heapIndex]);
+    } else {
+        aToIndex[n] = BINARYHEAP_INVALID_INDEX;
+    }
+    if (3*n < a.length) resize(false);
+    return x;
+}
+
+template<class T, typename index_t>
+bool BinaryHeap<T, index_t>::contains(index_t i) {
+    return (i >= 0 && i < nIndex && indexToA[i] != BINARYHEAP_INVALID_INDEX);
+}
+
+template<class T, typename index_t>
+bool BinaryHeap<T, index_t>::isValid() {
+    for (index_t i = 0; i < n; i++) {
+        if (i > 0 && compare(a[i], a[parent(i)]) > 0) return false;
+        if (aToIndex[i] < 0 || aToIndex[i] >= nIndex) return false;
+        if (indexToA[aToIndex[i]] != i) return false;
+    }
+    return true;
+}
+
 template<class T, typename index_t>
 BinaryHeap<T, index_t>::BinaryHeap() : a(1), indexToA(1), aToIndex(1) {
 	n = 0;
@@ -0,0 +1,186 @@
+/*!
+** \file resultcache.cpp
+** \brief Implementation of the ResultCache class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include "resultcache.h"
+#include "imagedata.h"
+#include "algorithms/superpixels/superpixellationfile.h"
+
+ResultCache::ResultCache(const QString &d, const qint64 m) :
+    directory(d),
+    maxBytes(m)
+{
+    if(!directory.exists()) {
+        directory.mkpath(".");
+    }
+}
+
+QString ResultCache::defaultDirectory(void) {
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/results";
+}
+
+bool ResultCache::isValid(void) const {
+    return directory.exists();
+}
+
+QByteArray ResultCache::imageHash(ImageData &image) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    qint32 dimensions[2] = {image.width(), image.height()};
+    hash.addData(reinterpret_cast<const char*>(dimensions), sizeof(dimensions));
+    int length = static_cast<int>(image.pixelCount());
+    hash.addData(reinterpret_cast<const char*>(image.red()), length);
+    hash.addData(reinterpret_cast<const char*>(image.green()), length);
+    hash.addData(reinterpret_cast<const char*>(image.blue()), length);
+    return hash.result().toHex();
+}
+
+QString ResultCache::key(const QVector<QByteArray> &imageHashes, const QString &signature) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(RESULTCACHE_KEY_VERSION));
+    foreach(const QByteArray &imageHash, imageHashes) {
+        hash.addData(imageHash);
+        hash.addData("\n", 1);
+    }
+    hash.addData(signature.toUtf8());
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+bool ResultCache::lookupOutput(const QString &key, QImage &image, QByteArray &svgData) {
+    QMutexLocker locker(&mutex);
+    QString path = entryPath(key, RESULTCACHE_OUTPUT_EXTENSION);
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream >> image >> svgData;
+    file.close();
+    if(stream.status() != QDataStream::Ok || image.isNull()) {
+        // Discard corrupt entries
+        QFile::remove(path);
+        return false;
+    }
+    touch(path);
+    return true;
+}
+
+bool ResultCache::storeOutput(const QString &key, const QImage &image, const QByteArray &svgData) {
+    QMutexLocker locker(&mutex);
+    QSaveFile file(entryPath(key, RESULTCACHE_OUTPUT_EXTENSION));
+    if(!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << image << svgData;
+    if(stream.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+    bool success = file.commit();
+    if(success) {
+        evict();
+    }
+    return success;
+}
+
+bool ResultCache::lookupSuperpixellation(const QString &key,
+        ImageData *& img,
+        Superpixellation *& superpixellation,
+        const bool *& selectedSuperpixels,
+        const bool *& selectedPixels
+    ) {
+    QMutexLocker locker(&mutex);
+    QString path = entryPath(key, RESULTCACHE_SUPERPIXELLATION_EXTENSION);
+    if(!QFile::exists(path)) {
+        return false;
+    }
+    QString error;
+    bool success = SuperpixellationFile::load(
+                path, img, superpixellation,
+                selectedSuperpixels, selectedPixels,
+                error
+            );
+    if(success) {
+        touch(path);
+    } else {
+        qWarning("%s", qPrintable(error));
+        QFile::remove(path);
+    }
+    return success;
+}
+
+bool ResultCache::storeSuperpixellation(const QString &key,
+        const Superpixellation &superpixellation,
+        const bool * const selectedSuperpixels,
+        const bool * const selectedPixels
+    ) {
+    QMutexLocker locker(&mutex);
+    QString error;
+    bool success = SuperpixellationFile::save(
+                entryPath(key, RESULTCACHE_SUPERPIXELLATION_EXTENSION),
+                superpixellation, error,
+                selectedSuperpixels, selectedPixels
+            );
+    if(success) {
+        evict();
+    } else {
+        qWarning("%s", qPrintable(error));
+    }
+    return success;
+}
+
+void ResultCache::clear(void) {
+    QMutexLocker locker(&mutex);
+    foreach(const QFileInfo &info, directory.entryInfoList(QDir::Files)) {
+        QFile::remove(info.absoluteFilePath());
+    }
+}
+
+QString ResultCache::entryPath(const QString &key, const char *extension) const {
+    return directory.absoluteFilePath(key + '.' + extension);
+}
+
+void ResultCache::touch(const QString &path) {
+    QFile file(path);
+    if(file.open(QIODevice::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+}
+
+void ResultCache::evict(void) {
+    // Oldest entries first
+    QFileInfoList entries = directory.entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 totalBytes = 0;
+    foreach(const QFileInfo &info, entries) {
+        totalBytes += info.size();
+    }
+    for(int i = 0; i < entries.size() && totalBytes > maxBytes; i += 1) {
+        /* Removal may fail on platforms which do not allow memory-mapped
+         * files to be deleted, in which case the entry is skipped.
+         */
+        if(QFile::remove(entries[i].absoluteFilePath())) {
+            totalBytes -= entries[i].size();
+        }
+    }
+}
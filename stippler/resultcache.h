@@ -0,0 +1,211 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+/*!
+** \file resultcache.h
+** \brief Definition of the ResultCache class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+*/
+
+#include <QByteArray>
+#include <QDir>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+class ImageData;
+class Superpixellation;
+
+/*!
+  \brief The default upper bound on the total size of the files in a cache, in bytes
+ */
+#define RESULTCACHE_DEFAULT_MAX_BYTES (Q_INT64_C(1) << 30)
+
+/*!
+  \brief A version number which is mixed into all keys
+
+  Increment this value when changes to the algorithms alter their outputs
+  without altering their parameter signatures, to invalidate existing cache entries.
+ */
+#define RESULTCACHE_KEY_VERSION 1
+
+/*!
+  \brief The file extension of cache entries containing the output of an algorithm
+ */
+#define RESULTCACHE_OUTPUT_EXTENSION "out"
+
+/*!
+  \brief The file extension of cache entries containing superpixellations
+ */
+#define RESULTCACHE_SUPERPIXELLATION_EXTENSION "spx"
+
+/*!
+ * \brief A persistent, content-addressed store of algorithm results
+ *
+ * Each entry is a file in a cache directory, named by a key which is a hash of
+ * the input images and the signature of the algorithm which produced the entry
+ * (Algorithm::parameterSignature()). Two kinds of entries are stored:
+ * - The raster and vector output of an algorithm
+ * - Superpixellations, optionally with superpixel selections, in the format
+ *   of SuperpixellationFile, so that they can be memory-mapped when retrieved
+ *
+ * The total size of the entries is bounded. When it is exceeded, the least
+ * recently used entries are deleted. An entry's modification time is updated
+ * whenever it is retrieved, to record its use.
+ *
+ * Entries are written atomically, and the public functions of this class
+ * are thread-safe.
+ */
+class ResultCache
+{
+public:
+    /*!
+     * \brief Open a cache directory, creating it if necessary
+     * \param [in] directory The directory in which to store entries
+     * \param [in] maxBytes The upper bound on the total size of the entries
+     */
+    ResultCache(const QString &directory, const qint64 maxBytes = RESULTCACHE_DEFAULT_MAX_BYTES);
+
+    /*!
+     * \brief The directory used for the application's cache when none is specified
+     * \return A directory in the platform's standard cache location
+     */
+    static QString defaultDirectory(void);
+
+    /*!
+     * \brief Indicates whether the cache directory is usable
+     * \return `true` if the cache directory exists
+     */
+    bool isValid(void) const;
+
+    /*!
+     * \brief Compute a hash of the contents of an image
+     *
+     * The hash covers the image dimensions and its red, green and blue channels.
+     * \param [in] image The image
+     * \return The hash, as a hexadecimal string
+     */
+    static QByteArray imageHash(ImageData &image);
+
+    /*!
+     * \brief Compute a cache key
+     * \param [in] imageHashes The hashes of the input images (see imageHash()),
+     * in the order in which they are passed to the algorithm
+     * \param [in] signature The signature of the algorithm (Algorithm::parameterSignature())
+     * \return The key, which is suitable for use as a file name
+     */
+    static QString key(const QVector<QByteArray> &imageHashes, const QString &signature);
+
+    /*!
+     * \brief Retrieve the output of an algorithm
+     * \param [in] key The key of the entry
+     * \param [out] image The raster output of the algorithm
+     * \param [out] svgData The vector output of the algorithm, which is empty
+     * if the algorithm did not produce vector output
+     * \return `true` if the entry was found and read successfully
+     */
+    bool lookupOutput(const QString &key, QImage &image, QByteArray &svgData);
+
+    /*!
+     * \brief Store the output of an algorithm
+     * \param [in] key The key of the entry
+     * \param [in] image The raster output of the algorithm
+     * \param [in] svgData The vector output of the algorithm, which may be empty
+     * \return `true` on success
+     */
+    bool storeOutput(const QString &key, const QImage &image, const QByteArray &svgData);
+
+    /*!
+     * \brief Retrieve a superpixellation
+     *
+     * The entry is memory-mapped, as described in SuperpixellationFile::load().
+     * \param [in] key The key of the entry
+     * \param [in] img The image which was segmented. Ownership is transferred
+     * to `superpixellation` on success.
+     * \param [out] superpixellation The superpixellation. A null pointer
+     * is expected to be passed in.
+     * \param [out] selectedSuperpixels The stored selection status of each superpixel,
+     * or null if the entry does not contain selections
+     * \param [out] selectedPixels The stored selection status of each pixel,
+     * or null if the entry does not contain selections
+     * \return `true` if the entry was found and loaded successfully
+     */
+    bool lookupSuperpixellation(const QString &key,
+            ImageData *& img,
+            Superpixellation *& superpixellation,
+            const bool *& selectedSuperpixels,
+            const bool *& selectedPixels
+        );
+
+    /*!
+     * \brief Store a superpixellation, and optionally, a selection of its superpixels
+     * \param [in] key The key of the entry
+     * \param [in] superpixellation The superpixellation
+     * \param [in] selectedSuperpixels The selection status of each superpixel, or null
+     * \param [in] selectedPixels The selection status of each pixel, or null
+     * \return `true` on success
+     */
+    bool storeSuperpixellation(const QString &key,
+            const Superpixellation &superpixellation,
+            const bool* const selectedSuperpixels = 0,
+            const bool* const selectedPixels = 0
+        );
+
+    /*!
+     * \brief Delete all entries
+     */
+    void clear(void);
+
+private:
+    /*!
+     * \brief Compute the path of an entry
+     * \param [in] key The key of the entry
+     * \param [in] extension The file extension of the entry
+     * \return The absolute path of the entry's file
+     */
+    QString entryPath(const QString &key, const char *extension) const;
+
+    /*!
+     * \brief Mark an entry as recently used
+     * \param [in] path The path of the entry's file
+     */
+    static void touch(const QString &path);
+
+    /*!
+     * \brief Delete the least recently used entries until the total size of
+     * the entries is within ResultCache::maxBytes
+     *
+     * The caller must hold ResultCache::mutex.
+     */
+    void evict(void);
+
+    /*!
+     * \brief The directory containing the entries
+     */
+    QDir directory;
+    /*!
+     * \brief The upper bound on the total size of the entries, in bytes
+     */
+    const qint64 maxBytes;
+    /*!
+     * \brief Serializes modifications to the cache directory
+     */
+    QMutex mutex;
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    ResultCache(const ResultCache& other);
+    ResultCache& operator=(const ResultCache& other);
+};
+
+#endif // RESULTCACHE_H
@@ -9,7 +9,9 @@
 #
 #-------------------------------------------------
 
-QT       += core gui widgets svg
+QT       += core gui widgets svg network
+
+CONFIG   += c++11
 
 TARGET = stippler
 TEMPLATE = app
@@ -18,13 +20,29 @@ SOURCES += main.cpp\
     imageviewer.cpp \
     imagemanager.cpp \
     algorithms/algorithm.cpp \
+    algorithms/algorithmprofile.cpp \
     imagedata.cpp \
     algorithmmanager.cpp \
     algorithmthread.cpp \
+    algorithmprogress.cpp \
+    algorithmpool.cpp \
+    taskscheduler.cpp \
+    cancellationtoken.cpp \
+    algorithmregistry.cpp \
+    batchprocessor.cpp \
+    batchpipeline.cpp \
+    jobserver.cpp \
+    jobclient.cpp \
     algorithms/rgb2labgreyalgorithm.cpp \
     algorithmresultpair.cpp \
+    resultcache.cpp \
     algorithms/superpixels/slic.cpp \
     algorithms/superpixels/superpixellation.cpp \
+    algorithms/superpixels/superpixelstatistics.cpp \
+    algorithms/superpixels/regionadjacencygraph.cpp \
+    algorithms/superpixels/superpixelmergetree.cpp \
+    algorithms/superpixels/superpixellationfile.cpp \
+    algorithms/superpixels/superpixelspatialindex.cpp \
     algorithms/higher_order/filter/superpixelfilter.cpp \
     algorithms/higher_order/filter/localdatafilter.cpp \
     algorithms/higher_order/filter/filteredsuperpixellation.cpp \
@@ -36,14 +54,31 @@ SOURCES += main.cpp\
 HEADERS  += imageviewer.h \
     imagemanager.h \
     algorithms/algorithm.h \
+    algorithms/algorithmprofile.h \
     imagedata.h \
     algorithmmanager.h \
     algorithmthread.h \
+    algorithmprogress.h \
+    algorithmpool.h \
+    taskscheduler.h \
+    cancellationtoken.h \
+    algorithmregistry.h \
+    batchprocessor.h \
+    batchpipeline.h \
+    boundedqueue.h \
+    jobserver.h \
+    jobclient.h \
     algorithms/rgb2labgreyalgorithm.h \
     algorithmresultpair.h \
+    resultcache.h \
     algorithms/superpixels/slic.h \
     algorithms/superpixels/isuperpixelgenerator.h \
     algorithms/superpixels/superpixellation.h \
+    algorithms/superpixels/superpixelstatistics.h \
+    algorithms/superpixels/regionadjacencygraph.h \
+    algorithms/superpixels/superpixelmergetree.h \
+    algorithms/superpixels/superpixellationfile.h \
+    algorithms/superpixels/superpixelspatialindex.h \
     algorithms/higher_order/filter/superpixelfilter.h \
     algorithms/higher_order/filter/localdatafilter.h \
     algorithms/higher_order/filter/filteredsuperpixellation.h \
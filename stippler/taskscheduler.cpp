@@ -0,0 +1,361 @@
+/*!
+** \file taskscheduler.cpp
+** \brief Implementation of the TaskScheduler class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** Lazy binary splitting of loop ranges, with one task queue per thread,
+** from which idle threads steal the largest pending ranges.
+*/
+
+#include <QMutexLocker>
+#include <QThread>
+#include "taskscheduler.h"
+#include "cancellationtoken.h"
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/*!
+ * \brief The index of the calling thread's task queue,
+ * or -1 if the calling thread is not a worker thread
+ */
+static thread_local int workerQueue = -1;
+
+/*!
+ * \brief The cancellation token of the calling thread, which is inherited
+ * by the threads executing tasks on its behalf
+ */
+static thread_local const CancellationToken *currentToken = 0;
+
+/*!
+ * \brief The CPU time, in nanoseconds, which other threads spent processing
+ * the loops started by the calling thread
+ */
+static thread_local QAtomicInteger<qint64> helperCpuTime(0);
+
+/*!
+ * \brief The account to which the calling thread's CPU time is charged,
+ * which is inherited by the threads executing tasks on its behalf, or null
+ * if the calling thread is working for itself
+ */
+static thread_local QAtomicInteger<qint64> *currentCpuAccount = 0;
+
+/*!
+ * \brief The CPU time, in nanoseconds, which the calling thread spent processing
+ * the loops of other threads, and which was charged to their accounts
+ */
+static thread_local qint64 lentCpuTime = 0;
+
+/*!
+ * \brief The account to which the calling thread's CPU time is currently charged
+ */
+static QAtomicInteger<qint64> *cpuAccount(void) {
+    if(currentCpuAccount != 0) {
+        return currentCpuAccount;
+    }
+    return &helperCpuTime;
+}
+
+/*!
+ * \brief The CPU time consumed by the calling thread
+ * \return CPU time, in nanoseconds, or zero if it cannot be measured
+ */
+static qint64 threadCpuTime(void) {
+#ifdef Q_OS_WIN
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if(!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        return 0;
+    }
+    ULARGE_INTEGER kernel, user;
+    kernel.LowPart = kernelTime.dwLowDateTime;
+    kernel.HighPart = kernelTime.dwHighDateTime;
+    user.LowPart = userTime.dwLowDateTime;
+    user.HighPart = userTime.dwHighDateTime;
+    // Windows measures CPU time in units of 100 nanoseconds
+    return static_cast<qint64>(kernel.QuadPart + user.QuadPart) * 100;
+#else
+    struct timespec t;
+    if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t) != 0) {
+        return 0;
+    }
+    return static_cast<qint64>(t.tv_sec) * 1000000000 + t.tv_nsec;
+#endif
+}
+
+/*!
+ * \brief A thread which processes tasks for a TaskScheduler
+ */
+class TaskScheduler::Worker : public QThread
+{
+public:
+    Worker(TaskScheduler *s, const int q, const bool p) :
+        QThread(0), scheduler(s), queue(q), pin(p)
+    {}
+
+protected:
+    void run() Q_DECL_OVERRIDE {
+#ifdef Q_OS_LINUX
+        if(pin) {
+            int nCpus = QThread::idealThreadCount();
+            if(nCpus > 0) {
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                CPU_SET(queue % nCpus, &cpus);
+                pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+            }
+        }
+#endif
+        workerQueue = queue;
+        scheduler->work(queue);
+    }
+
+private:
+    TaskScheduler *scheduler;
+    int queue;
+    bool pin;
+};
+
+int TaskScheduler::configuredThreads = 0;
+bool TaskScheduler::configuredPinning = false;
+bool TaskScheduler::created = false;
+
+TaskScheduler &TaskScheduler::instance(void) {
+    static TaskScheduler scheduler(configuredThreads, configuredPinning);
+    return scheduler;
+}
+
+bool TaskScheduler::configure(const int nThreads, const bool pinThreads) {
+    if(created) {
+        return false;
+    }
+    configuredThreads = nThreads;
+    configuredPinning = pinThreads;
+    return true;
+}
+
+TaskScheduler::TaskScheduler(const int t, const bool pinThreads) :
+    workers(), queues(), pendingTasks(0), stopping(false)
+{
+    created = true;
+    int nThreads = t;
+    if(nThreads <= 0) {
+        nThreads = QThread::idealThreadCount();
+    }
+    if(nThreads < 1) {
+        nThreads = 1;
+    }
+    for(int i = 0; i < nThreads; i += 1) {
+        TaskQueue *queue = new TaskQueue;
+        queue->front = 0;
+        queues.append(queue);
+    }
+    for(int i = 0; i < (nThreads - 1); i += 1) {
+        Worker *worker = new Worker(this, i, pinThreads);
+        workers.append(worker);
+        worker->start();
+    }
+}
+
+TaskScheduler::~TaskScheduler(void) {
+    sleepMutex.lock();
+    stopping = true;
+    workAvailable.wakeAll();
+    sleepMutex.unlock();
+    foreach(Worker *worker, workers) {
+        worker->wait();
+        delete worker;
+    }
+    workers.clear();
+    foreach(TaskQueue *queue, queues) {
+        delete queue;
+    }
+    queues.clear();
+}
+
+void TaskScheduler::setCancellationToken(const CancellationToken *token) {
+    currentToken = token;
+}
+
+bool TaskScheduler::cancellationRequested(void) {
+    return currentToken != 0 && currentToken->isCancelled();
+}
+
+qint64 TaskScheduler::cpuTime(void) {
+    return threadCpuTime() - lentCpuTime + helperCpuTime.load();
+}
+
+int TaskScheduler::threadCount(void) const {
+    return workers.size() + 1;
+}
+
+void TaskScheduler::parallelFor(const pxind &begin, const pxind &end, const pxind &g,
+                                const RangeFunction &body) {
+    if(end <= begin) {
+        return;
+    }
+    if(cancellationRequested()) {
+        return;
+    }
+    pxind grain = std::max(g, static_cast<pxind>(1));
+    if(workers.isEmpty() || (end - begin) <= grain) {
+        body(begin, end);
+        return;
+    }
+
+    Loop loop;
+    loop.body = &body;
+    loop.grain = grain;
+    loop.token = currentToken;
+    loop.cpuAccount = cpuAccount();
+    loop.remaining.store(end - begin);
+    Task task;
+    task.loop = &loop;
+    task.begin = begin;
+    task.end = end;
+    const int queue = currentQueue();
+    execute(task, queue);
+
+    // Help with other tasks until all subranges of this loop have been processed
+    while(loop.remaining.loadAcquire() > 0) {
+        if(findTask(task, queue)) {
+            execute(task, queue);
+        } else {
+            QMutexLocker locker(&finishMutex);
+            if(loop.remaining.loadAcquire() > 0) {
+                loopFinished.wait(&finishMutex, TASKSCHEDULER_HELP_INTERVAL);
+            }
+        }
+    }
+}
+
+int TaskScheduler::currentQueue(void) const {
+    if(workerQueue >= 0) {
+        return workerQueue;
+    }
+    return queues.size() - 1;
+}
+
+void TaskScheduler::execute(Task task, const int queue) {
+    Loop *loop = task.loop;
+    if(loop->token == 0 || !loop->token->isCancelled()) {
+        Task upperHalf;
+        upperHalf.loop = loop;
+        while((task.end - task.begin) > loop->grain) {
+            upperHalf.begin = task.begin + (task.end - task.begin) / 2;
+            upperHalf.end = task.end;
+            push(upperHalf, queue);
+            task.end = upperHalf.begin;
+        }
+        // Nested loops started by the body inherit the token
+        const CancellationToken *previousToken = currentToken;
+        currentToken = loop->token;
+        if(loop->cpuAccount == cpuAccount()) {
+            (*(loop->body))(task.begin, task.end);
+        } else {
+            /* Charge the task to the thread which started the loop, less any time
+             * charged to other threads by loops processed within the task
+             */
+            QAtomicInteger<qint64> *previousAccount = currentCpuAccount;
+            const qint64 previousLent = lentCpuTime;
+            const qint64 start = threadCpuTime();
+            currentCpuAccount = loop->cpuAccount;
+            (*(loop->body))(task.begin, task.end);
+            currentCpuAccount = previousAccount;
+            const qint64 elapsed = threadCpuTime() - start;
+            loop->cpuAccount->fetchAndAddRelaxed(elapsed - (lentCpuTime - previousLent));
+            lentCpuTime = previousLent + elapsed;
+        }
+        currentToken = previousToken;
+    }
+
+    /* Cancelled subranges are accounted for without being processed.
+     * The loop object belongs to the thread which called parallelFor(), and may
+     * be destroyed as soon as the last subrange is accounted for.
+     */
+    const pxind size = task.end - task.begin;
+    if(loop->remaining.fetchAndAddOrdered(-size) == size) {
+        QMutexLocker locker(&finishMutex);
+        loopFinished.wakeAll();
+    }
+}
+
+void TaskScheduler::push(const Task &task, const int queue) {
+    TaskQueue *q = queues[queue];
+    q->mutex.lock();
+    q->tasks.append(task);
+    q->mutex.unlock();
+    pendingTasks.ref();
+
+    QMutexLocker locker(&sleepMutex);
+    workAvailable.wakeOne();
+}
+
+bool TaskScheduler::findTask(Task &task, const int queue) {
+    const int nQueues = queues.size();
+    // Take the most recently pushed (smallest) task from the thread's own queue
+    TaskQueue *q = queues[queue];
+    q->mutex.lock();
+    if(q->tasks.size() > q->front) {
+        task = q->tasks.last();
+        q->tasks.removeLast();
+        if(q->tasks.size() == q->front) {
+            q->tasks.clear();
+            q->front = 0;
+        }
+        q->mutex.unlock();
+        pendingTasks.deref();
+        return true;
+    }
+    q->mutex.unlock();
+
+    // Steal the oldest (largest) task from another queue
+    for(int i = 1; i < nQueues; i += 1) {
+        q = queues[(queue + i) % nQueues];
+        q->mutex.lock();
+        if(q->tasks.size() > q->front) {
+            task = q->tasks[q->front];
+            q->front += 1;
+            if(q->tasks.size() == q->front) {
+                q->tasks.clear();
+                q->front = 0;
+            }
+            q->mutex.unlock();
+            pendingTasks.deref();
+            return true;
+        }
+        q->mutex.unlock();
+    }
+    return false;
+}
+
+void TaskScheduler::work(const int queue) {
+    Task task;
+    while(true) {
+        if(findTask(task, queue)) {
+            execute(task, queue);
+            continue;
+        }
+        QMutexLocker locker(&sleepMutex);
+        if(stopping) {
+            return;
+        }
+        if(pendingTasks.load() <= 0) {
+            workAvailable.wait(&sleepMutex);
+        }
+    }
+}
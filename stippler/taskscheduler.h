@@ -0,0 +1,327 @@
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+/*!
+** \file taskscheduler.h
+** \brief Definition of the TaskScheduler class.
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** Lazy binary splitting of loop ranges, with one task queue per thread,
+** from which idle threads steal the largest pending ranges.
+*/
+
+#include <algorithm>
+#include <functional>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QVector>
+#include <QWaitCondition>
+#include "imagedata.h"
+
+class CancellationToken;
+
+/*!
+  \brief The number of partial results computed per thread by TaskScheduler::parallelReduce()
+
+  Producing more partial results than threads lets idle threads
+  steal work from busy ones.
+ */
+#define TASKSCHEDULER_REDUCE_CHUNKS_PER_THREAD 4
+
+/*!
+  \brief The maximum time, in milliseconds, for which a thread waiting for a loop
+  to finish sleeps before looking for tasks to help with again
+ */
+#define TASKSCHEDULER_HELP_INTERVAL 1
+
+/*!
+ * \brief A work-stealing scheduler for data-parallel loops, shared by all algorithms
+ *
+ * Loops over ranges of pixels, rows, or superpixels are run with parallelFor()
+ * or parallelReduce(). A loop's range is split in half repeatedly, down to a
+ * caller-specified grain size. The upper halves are pushed onto the
+ * task queue of the splitting thread, and the lower half is processed
+ * immediately. Threads with empty queues steal from the front of other threads'
+ * queues, where the largest ranges are found.
+ *
+ * The thread calling parallelFor() participates in the loop, and only
+ * returns once the whole range has been processed. Loops can therefore
+ * be nested, and can be started by several threads (such as the threads
+ * of an AlgorithmPool) at once.
+ *
+ * Loops can be cancelled at the boundaries of tasks. A thread which sets a
+ * CancellationToken with setCancellationToken() attaches it to the loops
+ * it starts, including loops nested within them. Once the token is cancelled,
+ * the remaining subranges of those loops are discarded without calling their
+ * bodies, so parallelFor() and parallelReduce() return promptly, with incomplete
+ * results. Long-running loop bodies can poll cancellationRequested() to stop early.
+ *
+ * CPU time spent on a loop is charged to the thread which started it in the
+ * same way: a thread processing a task of another thread's loop measures the
+ * task's CPU time and adds it to that thread's account, which cpuTime() reports.
+ * Nested loops are charged to the thread which started the outermost loop.
+ *
+ * There is a single, lazily-created instance, obtained with instance().
+ */
+class TaskScheduler
+{
+public:
+    /*!
+     * \brief The type of loop bodies
+     *
+     * The arguments are the start (inclusive) and end (exclusive) of
+     * the subrange to process.
+     */
+    typedef std::function<void(pxind, pxind)> RangeFunction;
+
+public:
+    /*!
+     * \brief Obtain the shared scheduler, creating it if necessary
+     * \return The scheduler
+     */
+    static TaskScheduler &instance(void);
+
+    /*!
+     * \brief Choose the configuration of the shared scheduler
+     *
+     * This function must be called before the first call to instance()
+     * to have any effect.
+     * \param [in] nThreads The number of threads which process loops,
+     * including the calling thread. If not positive, QThread::idealThreadCount()
+     * is used.
+     * \param [in] pinThreads Whether to bind each worker thread to a single CPU.
+     * This is only supported on Linux, and is ignored on other platforms.
+     * \return `false` if the shared scheduler has already been created,
+     * in which case the configuration is ignored, or `true` otherwise.
+     */
+    static bool configure(const int nThreads, const bool pinThreads = false);
+
+    /*!
+     * \brief Choose the token which cancels loops started by the calling thread
+     * \param [in] token The token, which is not owned by the scheduler, and must
+     * outlive all loops started while it is set. Passing null makes subsequent
+     * loops uncancellable.
+     */
+    static void setCancellationToken(const CancellationToken *token);
+
+    /*!
+     * \brief Determine whether the loop being processed by the calling thread
+     * has been cancelled
+     *
+     * Loop bodies which process large subranges can call this function periodically,
+     * and return early if it returns `true`.
+     * \return `true` if the calling thread's cancellation token has been cancelled
+     */
+    static bool cancellationRequested(void);
+
+    /*!
+     * \brief The CPU time consumed on behalf of the calling thread
+     *
+     * This is the CPU time of the calling thread, plus the time other threads
+     * spent processing the loops it started, minus the time the calling thread
+     * spent processing the loops of other threads.
+     * \return CPU time, in nanoseconds, relative to an arbitrary reference,
+     * or zero if it cannot be measured
+     */
+    static qint64 cpuTime(void);
+
+    /*!
+     * \brief Stops and waits for all worker threads
+     */
+    ~TaskScheduler(void);
+
+    /*!
+     * \brief The number of threads which can process a loop at once
+     * \return The number of worker threads, plus one for the calling thread
+     */
+    int threadCount(void) const;
+
+    /*!
+     * \brief Process a range of indices in parallel
+     *
+     * If the calling thread's cancellation token is cancelled before the loop
+     * finishes, some subranges may not be processed.
+     * \param [in] begin The first index of the range
+     * \param [in] end One past the last index of the range
+     * \param [in] grain The size of range below which a range is not split further.
+     * Ranges processed by single calls to `body` are no larger than this value.
+     * It should be large enough to amortize the cost of scheduling a task.
+     * \param [in] body The function to call on each subrange. It must be safe
+     * to call concurrently on disjoint subranges.
+     */
+    void parallelFor(const pxind &begin, const pxind &end, const pxind &grain,
+                     const RangeFunction &body);
+
+    /*!
+     * \brief Compute a value over a range of indices in parallel
+     *
+     * The range is divided into a fixed number of chunks (at most
+     * #TASKSCHEDULER_REDUCE_CHUNKS_PER_THREAD times threadCount(), and no smaller
+     * than `grain`). A partial result is computed for each chunk, and the partial
+     * results are combined in order of increasing index on the calling thread.
+     * The result is therefore deterministic for a given thread count.
+     * \param [in] begin The first index of the range
+     * \param [in] end One past the last index of the range
+     * \param [in] grain The minimum size of a chunk
+     * \param [in] identity The initial value of each partial result, and of the result
+     * \param [in] body A function with the signature `void(pxind start, pxind end, T &partial)`
+     * which accumulates the values of a chunk into `partial`. It must be safe
+     * to call concurrently on disjoint chunks.
+     * \param [in] combine A function with the signature
+     * `void(T &result, const T &partial)` which merges a partial result into the result
+     * \return The combined result, or `identity` if the range is empty
+     */
+    template<typename T, typename Body, typename Combine>
+    T parallelReduce(const pxind &begin, const pxind &end, const pxind &grain,
+                     const T &identity, Body body, Combine combine);
+
+private:
+    /*!
+     * \brief The shared state of a single call to parallelFor()
+     */
+    struct Loop {
+        const RangeFunction *body;
+        pxind grain;
+        /*!
+         * \brief The cancellation token of the thread which started the loop, or null
+         */
+        const CancellationToken *token;
+        /*!
+         * \brief The account of the thread which started the loop,
+         * to which helper threads add the CPU time of its tasks
+         */
+        QAtomicInteger<qint64> *cpuAccount;
+        /*!
+         * \brief The number of indices which have not yet been processed
+         */
+        QAtomicInt remaining;
+    };
+
+    /*!
+     * \brief A subrange of a loop
+     */
+    struct Task {
+        Loop *loop;
+        pxind begin;
+        pxind end;
+    };
+
+    /*!
+     * \brief A double-ended queue of tasks
+     *
+     * The owner pushes and pops at the back, whereas thieves take from the front.
+     */
+    struct TaskQueue {
+        QMutex mutex;
+        QVector<Task> tasks;
+        int front;
+    };
+
+    class Worker;
+
+    /*!
+     * \brief Create worker threads
+     * \param [in] nThreads The number of threads, including the calling thread
+     * \param [in] pinThreads Whether to bind worker threads to CPUs
+     */
+    TaskScheduler(const int nThreads, const bool pinThreads);
+
+    /*!
+     * \brief The index of the task queue used by the calling thread
+     *
+     * Worker threads have their own queues. All other threads share the last queue.
+     */
+    int currentQueue(void) const;
+
+    /*!
+     * \brief Split a task down to its loop's grain size, queueing the upper
+     * halves, and then process the remaining subrange
+     */
+    void execute(Task task, const int queue);
+
+    void push(const Task &task, const int queue);
+
+    /*!
+     * \brief Take a task from the given queue, or steal one from another queue
+     * \return `true` if a task was found
+     */
+    bool findTask(Task &task, const int queue);
+
+    /*!
+     * \brief The main loop of a worker thread
+     */
+    void work(const int queue);
+
+    // Currently not implemented - will cause linker errors if called
+private:
+    TaskScheduler(const TaskScheduler& other);
+    TaskScheduler& operator=(const TaskScheduler& other);
+
+    // Data members
+private:
+    static int configuredThreads;
+    static bool configuredPinning;
+    static bool created;
+
+    QVector<Worker*> workers;
+    /*!
+     * \brief One queue per worker, plus a queue shared by all other threads
+     */
+    QVector<TaskQueue*> queues;
+    /*!
+     * \brief The number of tasks in all queues
+     */
+    QAtomicInt pendingTasks;
+    bool stopping;
+    /*!
+     * \brief Protects TaskScheduler::stopping, and is used with
+     * TaskScheduler::workAvailable to put idle workers to sleep
+     */
+    QMutex sleepMutex;
+    QWaitCondition workAvailable;
+    /*!
+     * \brief Used with TaskScheduler::loopFinished to wake threads
+     * waiting for their loops to finish
+     */
+    QMutex finishMutex;
+    QWaitCondition loopFinished;
+};
+
+template<typename T, typename Body, typename Combine>
+T TaskScheduler::parallelReduce(const pxind &begin, const pxind &end, const pxind &grain,
+                                const T &identity, Body body, Combine combine) {
+    T result = identity;
+    if(end <= begin) {
+        return result;
+    }
+    const pxind n = end - begin;
+    const pxind chunkSize = std::max(grain, static_cast<pxind>(1));
+    const pxind nChunks = std::min(
+                (n + chunkSize - 1) / chunkSize,
+                static_cast<pxind>(threadCount() * TASKSCHEDULER_REDUCE_CHUNKS_PER_THREAD)
+            );
+    QVector<T> partials(nChunks, identity);
+    T *partialData = partials.data();
+    parallelFor(0, nChunks, 1, [&](pxind first, pxind last) {
+        for(pxind c = first; c < last; c += 1) {
+            body(
+                begin + static_cast<pxind>((static_cast<qint64>(n) * c) / nChunks),
+                begin + static_cast<pxind>((static_cast<qint64>(n) * (c + 1)) / nChunks),
+                partialData[c]
+            );
+        }
+    });
+    for(pxind c = 0; c < nChunks; c += 1) {
+        combine(result, partialData[c]);
+    }
+    return result;
+}
+
+#endif // TASKSCHEDULER_H
@@ -0,0 +1,388 @@
+/*!
+** \file main.cpp
+** \brief Checks of SuperpixelMergeTree and ods::BinaryHeap
+**
+** ### About
+** Created for: COMP4905A Honours Project\n
+** Fall 2016\n
+** Bernard Llanos\n
+** Supervised by Dr. David Mould\n
+** School of Computer Science, Carleton University
+**
+** ## Primary basis
+** None
+**
+** ## Usage
+** `mergetreecheck [image...]`
+**
+** Each image is segmented into a grid of irregular superpixels, and a
+** SuperpixelMergeTree is built and checked for it. Without arguments,
+** a synthetic image is used. The exit code is zero if all checks pass.
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <QCoreApplication>
+#include <QImage>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include "algorithms/superpixels/superpixellation.h"
+#include "algorithms/superpixels/superpixelmergetree.h"
+#include "ods/BinaryHeap.h"
+
+/*!
+  \brief The number of elements inserted into the heap by checkHeap()
+ */
+#define MERGETREECHECK_HEAP_SIZE 500
+
+/*!
+  \brief The approximate width and height, in pixels, of the superpixels
+  created by createSuperpixellation()
+ */
+#define MERGETREECHECK_CELL_SIZE 9
+
+/*!
+ * \brief A heap element ordered in the same way as the merge candidates
+ * of SuperpixelMergeTree: the lowest cost has the highest priority,
+ * and ties are broken in favour of smaller IDs
+ */
+struct HeapElement {
+    qreal cost;
+    pxind id;
+
+    bool operator<(HeapElement const & rhs) const
+    {
+        if(cost > rhs.cost) {
+            return true;
+        } else if(cost < rhs.cost) {
+            return false;
+        } else { // cost == rhs.cost
+            return (id > rhs.id);
+        }
+    }
+};
+
+/*!
+ * \brief Exercise ods::BinaryHeap
+ *
+ * The heap is filled, its elements' priorities are changed in both directions
+ * with ods::BinaryHeap::update(), some elements are removed from within the heap
+ * with ods::BinaryHeap::removeAt(), and it is then emptied. The invariants of the
+ * heap and the order in which elements are removed are checked throughout.
+ * \param [out] error A description of the first failed check
+ * \return `true` if all checks passed
+ */
+static bool checkHeap(QString &error) {
+    ods::BinaryHeap<HeapElement, pxind> heap;
+    QVector<pxind> handles;
+    HeapElement element;
+    std::srand(1);
+    for(pxind i = 0; i < MERGETREECHECK_HEAP_SIZE; i += 1) {
+        // Few distinct costs, so that ties are exercised
+        element.cost = static_cast<qreal>(std::rand() % 100);
+        element.id = i;
+        handles.append(heap.add(element));
+        if(!heap.isValid()) {
+            error = QString("The heap is inconsistent after %1 insertions.").arg(i + 1);
+            return false;
+        }
+    }
+
+    for(int j = 0; j < handles.size(); j += 1) {
+        if((j % 3) == 0) {
+            heap.removeAt(handles[j]);
+        } else {
+            heap[handles[j]].cost *= ((j % 3) == 1) ? 0.5 : 2.0;
+            heap.update(handles[j]);
+        }
+        if(!heap.isValid() || (((j % 3) == 0) == heap.contains(handles[j]))) {
+            error = QString("The heap is inconsistent after modifying element %1.").arg(j);
+            return false;
+        }
+    }
+
+    pxind expectedSize = handles.size() - (handles.size() + 2) / 3;
+    if(heap.size() != expectedSize) {
+        error = QString("The heap has %1 elements, instead of %2.").arg(heap.size()).arg(expectedSize);
+        return false;
+    }
+
+    HeapElement previous;
+    bool isFirst = true;
+    while(heap.size() > 0) {
+        element = heap.remove();
+        if(!isFirst && previous < element) {
+            error = QString("Elements were removed from the heap out of order.");
+            return false;
+        } else if(!heap.isValid()) {
+            error = QString("The heap is inconsistent after removing its maximum.");
+            return false;
+        }
+        previous = element;
+        isFirst = false;
+    }
+    return true;
+}
+
+/*!
+ * \brief Segment an image into a grid of superpixels with jagged borders
+ *
+ * An additional superpixel, with no pixels, is created, so that the
+ * superpixellation has a superpixel which is not adjacent to any other.
+ * \param [in] image The image
+ * \return A new superpixellation, which the caller must delete
+ */
+static Superpixellation *createSuperpixellation(const QImage &image) {
+    ImageData *img = new ImageData(image);
+    const pxind width = img->width();
+    const pxind height = img->height();
+    const pxind pixelCount = img->pixelCount();
+    const pxind nColumns = (width + MERGETREECHECK_CELL_SIZE - 1) / MERGETREECHECK_CELL_SIZE;
+    const pxind nRows = (height + MERGETREECHECK_CELL_SIZE - 1) / MERGETREECHECK_CELL_SIZE;
+    const pxind nSuperpixels = nColumns * nRows + 1;
+
+    pxind *labels = new pxind[pixelCount];
+    pxind column = 0, row = 0;
+    for(pxind y = 0; y < height; y += 1) {
+        for(pxind x = 0; x < width; x += 1) {
+            column = std::min((x + (y % 5)) / MERGETREECHECK_CELL_SIZE, nColumns - 1);
+            row = std::min((y + (x % 3)) / MERGETREECHECK_CELL_SIZE, nRows - 1);
+            labels[y * width + x] = row * nColumns + column;
+        }
+    }
+
+    SuperpixelStatistics *statistics = new SuperpixelStatistics(*img, labels, nSuperpixels);
+
+    // Arrange pixels by superpixel, with boundary pixels first
+    pxind *offsets = new pxind[nSuperpixels + 1];
+    std::fill(offsets, offsets + nSuperpixels + 1, 0);
+    for(pxind k = 0; k < pixelCount; k += 1) {
+        offsets[labels[k] + 1] += 1;
+    }
+    for(pxind i = 0; i < nSuperpixels; i += 1) {
+        offsets[i + 1] += offsets[i];
+    }
+    pxind *boundaryEnds = new pxind[nSuperpixels];
+    pxind *interiorEnds = new pxind[nSuperpixels];
+    for(pxind i = 0; i < nSuperpixels; i += 1) {
+        boundaryEnds[i] = offsets[i];
+        interiorEnds[i] = offsets[i] + (*statistics)[i].boundaryCount;
+    }
+    pxind *pixels = new pxind[pixelCount];
+    pxind label = 0;
+    bool isBoundary = false;
+    for(pxind y = 0, k = 0; y < height; y += 1) {
+        for(pxind x = 0; x < width; x += 1, k += 1) {
+            label = labels[k];
+            isBoundary = (x == 0) || (y == 0) || (x == (width - 1)) || (y == (height - 1)) ||
+                    (labels[k - 1] != label) || (labels[k + 1] != label) ||
+                    (labels[k - width] != label) || (labels[k + width] != label);
+            if(isBoundary) {
+                pixels[boundaryEnds[label]] = k;
+                boundaryEnds[label] += 1;
+            } else {
+                pixels[interiorEnds[label]] = k;
+                interiorEnds[label] += 1;
+            }
+        }
+    }
+    delete [] boundaryEnds;
+    delete [] interiorEnds;
+
+    Superpixellation::Superpixel **superpixels = new Superpixellation::Superpixel*[nSuperpixels];
+    for(pxind i = 0; i < nSuperpixels; i += 1) {
+        superpixels[i] = new Superpixellation::Superpixel(
+                    i,
+                    pixels + offsets[i],
+                    offsets[i + 1] - offsets[i],
+                    (*statistics)[i]
+                );
+    }
+
+    return new Superpixellation(
+                img,
+                labels,
+                pixels,
+                offsets,
+                statistics,
+                superpixels,
+                nSuperpixels
+            );
+}
+
+/*!
+ * \brief Count the groups of connected superpixels, which are never merged
+ * with each other
+ * \param [in] adjacency The adjacency relationships between the superpixels
+ * \return The number of groups
+ */
+static pxind countGroups(const RegionAdjacencyGraph &adjacency) {
+    const pxind n = adjacency.size();
+    QVector<pxind> groupRoots(n);
+    for(pxind i = 0; i < n; i += 1) {
+        groupRoots[i] = i;
+    }
+    const pxind *neighbours = 0;
+    pxind degree = 0;
+    pxind root1 = 0, root2 = 0;
+    for(pxind i = 0; i < n; i += 1) {
+        adjacency.neighbours(i, neighbours, degree);
+        for(pxind j = 0; j < degree; j += 1) {
+            root1 = i;
+            while(groupRoots[root1] != root1) {
+                root1 = groupRoots[root1];
+            }
+            root2 = neighbours[j];
+            while(groupRoots[root2] != root2) {
+                root2 = groupRoots[root2];
+            }
+            groupRoots[std::max(root1, root2)] = std::min(root1, root2);
+        }
+    }
+    pxind nGroups = 0;
+    for(pxind i = 0; i < n; i += 1) {
+        if(groupRoots[i] == i) {
+            nGroups += 1;
+        }
+    }
+    return nGroups;
+}
+
+/*!
+ * \brief Build a SuperpixelMergeTree and check the mergers it records,
+ * and the segmentations extracted from it at several region counts,
+ * including out-of-range counts
+ * \param [in] superpixellation The superpixels to merge
+ * \param [out] error A description of the first failed check
+ * \return `true` if all checks passed
+ */
+static bool checkTree(const Superpixellation &superpixellation, QString &error) {
+    const pxind n = superpixellation.nSuperpixels;
+    RegionAdjacencyGraph adjacency(
+                *superpixellation.img,
+                superpixellation.superpixelLabels,
+                *superpixellation.statistics
+            );
+    const pxind nGroups = countGroups(adjacency);
+
+    SuperpixelMergeTree tree(superpixellation);
+    if(tree.size() != n || tree.mergeCount() != (n - nGroups)) {
+        error = QString("The hierarchy of %1 superpixels in %2 groups has %3 leaves and %4 mergers.")
+                .arg(n).arg(nGroups).arg(tree.size()).arg(tree.mergeCount());
+        return false;
+    }
+
+    // Each region is absorbed at most once, and never absorbs regions afterwards
+    QVector<bool> isMerged(n, false);
+    for(pxind i = 0; i < tree.mergeCount(); i += 1) {
+        const SuperpixelMergeTree::Merge &m = tree.merge(i);
+        if(m.survivor == m.merged || isMerged[m.survivor] || isMerged[m.merged] || m.cost < 0.0) {
+            error = QString("Merger %1 (%2 absorbing %3) is invalid.").arg(i).arg(m.survivor).arg(m.merged);
+            return false;
+        }
+        isMerged[m.merged] = true;
+    }
+
+    QVector<pxind> mapping(std::max(n, 1));
+    const pxind targets[] = {n + 1, n, (3 * n) / 4, n / 2, n / 4, nGroups, 1, 0};
+    const pxind nTargets = static_cast<pxind>(sizeof(targets) / sizeof(targets[0]));
+    pxind expected = 0;
+    pxind nOutputRegions = 0;
+    for(pxind t = 0; t < nTargets; t += 1) {
+        expected = std::min(std::max(targets[t], nGroups), n);
+        nOutputRegions = tree.extract(targets[t], mapping.data());
+        if(nOutputRegions != expected) {
+            error = QString("Extracting %1 regions produced %2 regions, instead of %3.")
+                    .arg(targets[t]).arg(nOutputRegions).arg(expected);
+            return false;
+        }
+        QVector<bool> isUsed(nOutputRegions, false);
+        for(pxind i = 0; i < n; i += 1) {
+            if(mapping[i] < 0 || mapping[i] >= nOutputRegions) {
+                error = QString("Extracting %1 regions mapped superpixel %2 to region %3.")
+                        .arg(targets[t]).arg(i).arg(mapping[i]);
+                return false;
+            }
+            isUsed[mapping[i]] = true;
+        }
+        if(isUsed.contains(false)) {
+            error = QString("Extracting %1 regions left some regions empty.").arg(targets[t]);
+            return false;
+        }
+        for(pxind i = 0; i < (n - expected); i += 1) {
+            const SuperpixelMergeTree::Merge &m = tree.merge(i);
+            if(mapping[m.survivor] != mapping[m.merged]) {
+                error = QString("Extracting %1 regions did not apply merger %2.").arg(targets[t]).arg(i);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Create an image with smooth gradients and noise, for use when no
+ * images are given on the command line
+ * \return The image
+ */
+static QImage syntheticImage(void) {
+    QImage image(97, 61, QImage::Format_RGB32);
+    std::srand(2);
+    for(int y = 0; y < image.height(); y += 1) {
+        for(int x = 0; x < image.width(); x += 1) {
+            image.setPixel(x, y, qRgb(
+                    (x * 255) / image.width(),
+                    (y * 255) / image.height(),
+                    std::rand() % 256
+                ));
+        }
+    }
+    return image;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    int nFailed = 0;
+    QString error;
+
+    if(checkHeap(error)) {
+        out << "ods::BinaryHeap: passed" << endl;
+    } else {
+        err << "ods::BinaryHeap: " << error << endl;
+        nFailed += 1;
+    }
+
+    QStringList files = app.arguments().mid(1);
+    QVector<QImage> images;
+    QStringList names;
+    if(files.isEmpty()) {
+        images.append(syntheticImage());
+        names.append("synthetic image");
+    }
+    foreach(const QString &file, files) {
+        images.append(QImage(file));
+        names.append(file);
+    }
+
+    for(int i = 0; i < images.size(); i += 1) {
+        if(images[i].isNull()) {
+            err << names[i] << ": Cannot load the image" << endl;
+            nFailed += 1;
+            continue;
+        }
+        Superpixellation *superpixellation = createSuperpixellation(images[i]);
+        error.clear();
+        if(checkTree(*superpixellation, error)) {
+            out << names[i] << ": SuperpixelMergeTree passed" << endl;
+        } else {
+            err << names[i] << ": SuperpixelMergeTree: " << error << endl;
+            nFailed += 1;
+        }
+        delete superpixellation;
+    }
+    return (nFailed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
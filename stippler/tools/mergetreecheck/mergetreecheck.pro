@@ -0,0 +1,47 @@
+#-------------------------------------------------
+# Qt project file for a command line tool which checks
+# SuperpixelMergeTree and ods::BinaryHeap
+#
+# COMP4905A Honours Project
+# Fall 2016
+# Bernard Llanos
+# Supervised by Dr. David Mould
+# School of Computer Science, Carleton University
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+CONFIG   += c++11 console
+CONFIG   -= app_bundle
+
+TARGET = mergetreecheck
+TEMPLATE = app
+
+STIPPLER = $$PWD/../..
+INCLUDEPATH += $$STIPPLER
+
+SOURCES += main.cpp \
+    $$STIPPLER/imagedata.cpp \
+    $$STIPPLER/taskscheduler.cpp \
+    $$STIPPLER/cancellationtoken.cpp \
+    $$STIPPLER/algorithms/superpixels/superpixellation.cpp \
+    $$STIPPLER/algorithms/superpixels/superpixelstatistics.cpp \
+    $$STIPPLER/algorithms/superpixels/regionadjacencygraph.cpp \
+    $$STIPPLER/algorithms/superpixels/superpixelmergetree.cpp \
+    $$STIPPLER/algorithms/superpixels/superpixelspatialindex.cpp \
+    $$STIPPLER/ods/array.cpp \
+    $$STIPPLER/ods/BinaryHeap.cpp \
+    $$STIPPLER/ods/utils.cpp
+
+HEADERS  += $$STIPPLER/imagedata.h \
+    $$STIPPLER/taskscheduler.h \
+    $$STIPPLER/cancellationtoken.h \
+    $$STIPPLER/algorithms/superpixels/superpixellation.h \
+    $$STIPPLER/algorithms/superpixels/superpixelstatistics.h \
+    $$STIPPLER/algorithms/superpixels/regionadjacencygraph.h \
+    $$STIPPLER/algorithms/superpixels/superpixelmergetree.h \
+    $$STIPPLER/algorithms/superpixels/superpixelspatialindex.h \
+    $$STIPPLER/ods/array.h \
+    $$STIPPLER/ods/BinaryHeap.h \
+    $$STIPPLER/ods/utils.h